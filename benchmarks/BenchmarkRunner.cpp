@@ -0,0 +1,148 @@
+/******************************************************************************************************
+ * @file  BenchmarkRunner.cpp
+ * @brief Implementation of the BenchmarkRunner class
+ ******************************************************************************************************/
+
+#include "BenchmarkRunner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    double median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+
+        const std::size_t middle = values.size() / 2;
+        return (values.size() % 2 == 1) ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+    }
+
+    std::string escape(const std::string& string) {
+        std::string escaped;
+        for(char c: string) {
+            if(c == '"' || c == '\\') { escaped += '\\'; }
+            escaped += c;
+        }
+
+        return escaped;
+    }
+
+    // Picks a unit so that the printed duration keeps a few significant digits
+    std::string formatDuration(double nanoseconds) {
+        char buffer[32];
+
+        if(nanoseconds < 1e3) {
+            std::snprintf(buffer, sizeof(buffer), "%.2f ns", nanoseconds);
+        } else if(nanoseconds < 1e6) {
+            std::snprintf(buffer, sizeof(buffer), "%.2f us", nanoseconds / 1e3);
+        } else if(nanoseconds < 1e9) {
+            std::snprintf(buffer, sizeof(buffer), "%.2f ms", nanoseconds / 1e6);
+        } else {
+            std::snprintf(buffer, sizeof(buffer), "%.2f s", nanoseconds / 1e9);
+        }
+
+        return buffer;
+    }
+}
+
+BenchmarkRunner::BenchmarkRunner(const Settings& settings) : settings{settings} {
+    this->settings.samples = std::max(this->settings.samples, 1u);
+}
+
+void BenchmarkRunner::counter(const std::string& name, double value) {
+    if(results.empty()) { return; }
+
+    results.back().counters.emplace_back(name, value);
+    std::cout << "    " << name << " : " << value << '\n';
+}
+
+bool BenchmarkRunner::matches(const std::string& name) const {
+    return settings.filter.empty() || name.find(settings.filter) != std::string::npos;
+}
+
+const std::vector<BenchmarkRunner::Result>& BenchmarkRunner::getResults() const {
+    return results;
+}
+
+std::string BenchmarkRunner::toJson() const {
+    std::ostringstream stream;
+    stream << std::setprecision(6);
+
+    stream << "{\n  \"samples\": " << settings.samples << ",\n  \"minSampleTime\": " << settings.minSampleTime
+           << ",\n  \"benchmarks\": [";
+
+    for(std::size_t i = 0 ; i < results.size() ; ++i) {
+        const Result& result = results[i];
+
+        stream << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << escape(result.name) << "\", \"iterations\": "
+               << result.iterations << ", \"samples\": " << result.samples << ", \"median\": " << result.median
+               << ", \"mad\": " << result.mad << ", \"mean\": " << result.mean << ", \"min\": " << result.min
+               << ", \"max\": " << result.max << ", \"outliers\": " << result.outliers;
+
+        if(result.bytesPerCall > 0.0) {
+            stream << ", \"bytesPerSecond\": " << result.bytesPerCall * 1e9 / result.median;
+        }
+
+        for(const auto& [name, value]: result.counters) {
+            stream << ", \"" << escape(name) << "\": " << value;
+        }
+
+        stream << '}';
+    }
+
+    stream << "\n  ]\n}\n";
+
+    return stream.str();
+}
+
+void BenchmarkRunner::write(const std::string& path) const {
+    std::ofstream file{path};
+    if(!file.is_open()) {
+        throw std::runtime_error{"Failed to open \"" + path + "\"."};
+    }
+
+    file << toJson();
+    std::cout << "LOG : Wrote benchmark results to \"" << path << "\".\n";
+}
+
+void BenchmarkRunner::add(const std::string& name, unsigned long long iterations, std::vector<double> samples,
+                          double bytesPerCall) {
+    Result result{};
+    result.name = name;
+    result.iterations = iterations;
+    result.samples = static_cast<unsigned>(samples.size());
+    result.bytesPerCall = bytesPerCall;
+
+    result.median = median(samples);
+    result.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+    result.min = *std::min_element(samples.begin(), samples.end());
+    result.max = *std::max_element(samples.begin(), samples.end());
+
+    std::vector<double> deviations;
+    deviations.reserve(samples.size());
+    for(double sample: samples) {
+        deviations.push_back(std::abs(sample - result.median));
+    }
+    result.mad = median(deviations);
+
+    for(double deviation: deviations) {
+        if(deviation > 3.0 * result.mad) { ++result.outliers; }
+    }
+
+    std::cout << std::left << std::setw(48) << name << std::right << std::setw(12) << formatDuration(result.median)
+              << "  +/- " << std::setw(10) << formatDuration(result.mad);
+    if(bytesPerCall > 0.0) {
+        char throughput[32];
+        std::snprintf(throughput, sizeof(throughput), "  %.1f MB/s", bytesPerCall * 1e3 / result.median);
+        std::cout << throughput;
+    }
+    std::cout << '\n';
+
+    results.push_back(std::move(result));
+}
\ No newline at end of file
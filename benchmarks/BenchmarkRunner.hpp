@@ -0,0 +1,114 @@
+/******************************************************************************************************
+ * @file  BenchmarkRunner.hpp
+ * @brief Declaration of the BenchmarkRunner class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Keeps the compiler from optimizing away a value that is computed but never used
+ */
+template<typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * @brief Times small functions.
+ * The number of calls per sample is calibrated so that a sample lasts long enough for the clock to be precise, then
+ * several samples are taken and summarized by their median and median absolute deviation, which outliers caused by the
+ * scheduler barely move.
+ */
+class BenchmarkRunner {
+public:
+    struct Settings {
+        unsigned samples = 20;
+        double minSampleTime = 0.01;    // Seconds
+        std::string filter;             // Only benchmarks whose name contains it run
+    };
+
+    struct Result {
+        std::string name;
+        unsigned long long iterations;  // Calls per sample
+        unsigned samples;
+
+        // Nanoseconds per call
+        double median;
+        double mad;
+        double mean;
+        double min;
+        double max;
+        unsigned outliers;              // Samples further than 3 MADs from the median
+
+        double bytesPerCall;
+        std::vector<std::pair<std::string, double>> counters;
+    };
+
+    explicit BenchmarkRunner(const Settings& settings);
+
+    /**
+     * @brief Times function, which is called without arguments
+     * @param bytesPerCall Bytes processed by each call, to report a throughput
+     * @return Whether the benchmark ran, benchmarks filtered out do not
+     */
+    template<typename Function>
+    bool run(const std::string& name, Function&& function, double bytesPerCall = 0.0) {
+        if(!matches(name)) { return false; }
+
+        // Also warms the caches up
+        unsigned long long iterations = 1;
+        double elapsed = time(function, iterations);
+        while(elapsed < settings.minSampleTime) {
+            const double scale = elapsed > 0.0 ? 1.5 * settings.minSampleTime / elapsed : 10.0;
+            iterations = static_cast<unsigned long long>(static_cast<double>(iterations) * std::min(scale, 10.0)) + 1;
+            elapsed = time(function, iterations);
+        }
+
+        std::vector<double> samples;
+        samples.reserve(settings.samples);
+        for(unsigned i = 0 ; i < settings.samples ; ++i) {
+            samples.push_back(time(function, iterations) * 1e9 / static_cast<double>(iterations));
+        }
+
+        add(name, iterations, std::move(samples), bytesPerCall);
+        return true;
+    }
+
+    /**
+     * @brief Attaches a counter to the last benchmark that ran, like the bytes it copied per call
+     */
+    void counter(const std::string& name, double value);
+
+    [[nodiscard]] bool matches(const std::string& name) const;
+    [[nodiscard]] const std::vector<Result>& getResults() const;
+
+    [[nodiscard]] std::string toJson() const;
+    void write(const std::string& path) const;
+
+private:
+    template<typename Function>
+    static double time(Function& function, unsigned long long iterations) {
+        const auto start = std::chrono::steady_clock::now();
+        for(unsigned long long i = 0 ; i < iterations ; ++i) {
+            function();
+        }
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void add(const std::string& name, unsigned long long iterations, std::vector<double> samples, double bytesPerCall);
+
+    Settings settings;
+    std::vector<Result> results;
+};
\ No newline at end of file
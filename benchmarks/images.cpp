@@ -0,0 +1,143 @@
+/******************************************************************************************************
+ * @file  images.cpp
+ * @brief Benchmarks of image decoding, encoding and mipmapping
+ ******************************************************************************************************/
+
+#include "suites.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ImageData.hpp"
+#include "ImageWriter.hpp"
+#include "MipChain.hpp"
+
+namespace {
+    /**
+     * @brief Silences std::cout while alive, ImageData logs every image it reads
+     */
+    class MuteOutput {
+    public:
+        MuteOutput() : previous{std::cout.rdbuf(sink.rdbuf())} { }
+        ~MuteOutput() { std::cout.rdbuf(previous); }
+
+    private:
+        std::ostringstream sink;
+        std::streambuf* previous;
+    };
+
+    const char* getName(ImageFormat format) {
+        switch(format) {
+            case ImageFormat::png: return "png";
+            case ImageFormat::jpg: return "jpg";
+            case ImageFormat::bmp: return "bmp";
+            case ImageFormat::tga: return "tga";
+            case ImageFormat::qoi: return "qoi";
+            case ImageFormat::pam: return "pam";
+        }
+
+        return "";
+    }
+}
+
+void benchmarkImages(BenchmarkRunner& runner, const std::string& directory) {
+    std::vector<std::filesystem::path> paths;
+    if(std::filesystem::is_directory(directory)) {
+        for(const std::filesystem::directory_entry& entry: std::filesystem::directory_iterator{directory}) {
+            const std::string extension = entry.path().extension().string();
+            if(extension == ".jpg" || extension == ".png") {
+                paths.push_back(entry.path());
+            }
+        }
+    }
+
+    if(paths.empty()) {
+        std::cerr << "No images found in \"" << directory << "\", skipping the image benchmarks.\n";
+        return;
+    }
+
+    std::sort(paths.begin(), paths.end());
+
+    /* Decoding */ {
+        for(const std::filesystem::path& path: paths) {
+            const std::string file = path.string();
+            const auto size = static_cast<double>(std::filesystem::file_size(path));
+
+            MuteOutput mute;
+            runner.run(std::string{"decode "} + path.filename().string(), [&file] {
+                const ImageData image{file};
+                doNotOptimize(image.getData());
+            }, size);
+        }
+    }
+
+    // The smallest image keeps the slow encoders from dominating the run time
+    std::filesystem::path smallest = paths.front();
+    for(const std::filesystem::path& path: paths) {
+        if(std::filesystem::file_size(path) < std::filesystem::file_size(smallest)) { smallest = path; }
+    }
+
+    std::optional<ImageData> image;
+    {
+        MuteOutput mute;
+        image.emplace(smallest.string());
+    }
+
+    const std::string suffix = std::string{" "} + smallest.filename().string();
+    const auto bytes = static_cast<double>(image->getSize());
+
+    /* Encoding */ {
+        for(ImageFormat format: {ImageFormat::png, ImageFormat::jpg, ImageFormat::bmp, ImageFormat::tga,
+                                 ImageFormat::qoi, ImageFormat::pam}) {
+            std::size_t encodedSize = 0;
+            const bool ran = runner.run(std::string{"encode "} + getName(format) + suffix, [&] {
+                const std::vector<unsigned char> encoded = ImageWriter::encode(*image, format);
+                encodedSize = encoded.size();
+                doNotOptimize(encoded.data());
+            }, bytes);
+
+            if(ran) {
+                runner.counter("ratio", static_cast<double>(encodedSize) / bytes);
+            }
+        }
+    }
+
+    /* Mipmapping */ {
+        const std::pair<const char*, MipSettings> variants[] = {
+            {"box", MipSettings{MipFilter::box}},
+            {"kaiser", MipSettings{MipFilter::kaiser}},
+            {"box linear", MipSettings{MipFilter::box, false}}
+        };
+
+        for(const std::filesystem::path& path: paths) {
+            std::optional<ImageData> texture;
+            {
+                MuteOutput mute;
+                texture.emplace(path.string());
+            }
+
+            const std::string file = path.filename().string();
+            const auto textureBytes = static_cast<double>(texture->getSize());
+
+            for(const auto& [name, settings]: variants) {
+                unsigned long long calls = 0;
+                const unsigned long long copied = ImageData::getBytesCopied();
+
+                const bool ran = runner.run(std::string{"buildMipChain "} + name + ' ' + file, [&] {
+                    doNotOptimize(buildMipChain(*texture, settings));
+                    ++calls;
+                }, textureBytes);
+
+                if(ran) {
+                    runner.counter("bytesCopied", static_cast<double>(ImageData::getBytesCopied() - copied)
+                                                  / static_cast<double>(calls));
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+/******************************************************************************************************
+ * @file  main.cpp
+ * @brief Entry point of the microbenchmarks
+ ******************************************************************************************************/
+
+// Standard C++ Library Headers
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// User-Defined Headers
+#include "BenchmarkRunner.hpp"
+#include "suites.hpp"
+
+// Main Function
+// [--filter text] [--samples n] [--min-time ms] [--images directory] [--output json]
+int main(int argc, char* argv[]) {
+    BenchmarkRunner::Settings settings;
+    std::string images = "data/textures";
+    std::string output;
+
+    for(int i = 1 ; i < argc ; i += 2) {
+        const std::string option = argv[i];
+        if(i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << '\n';
+            return 2;
+        }
+
+        const std::string value = argv[i + 1];
+
+        // Numbers that do not parse are usage errors as well, rather than exceptions escaping main
+        try {
+            if(option == "--filter") {
+                settings.filter = value;
+            } else if(option == "--samples") {
+                settings.samples = std::stoul(value);
+            } else if(option == "--min-time") {
+                settings.minSampleTime = std::stod(value) / 1000.0;
+            } else if(option == "--images") {
+                images = value;
+            } else if(option == "--output") {
+                output = value;
+            } else {
+                std::cerr << "Unknown option " << option << '\n';
+                return 2;
+            }
+        } catch(const std::logic_error&) {
+            std::cerr << "Invalid value for " << option << " : " << value << '\n';
+            return 2;
+        }
+    }
+
+    try {
+        BenchmarkRunner runner{settings};
+
+        benchmarkMaths(runner);
+        benchmarkMeshes(runner);
+        benchmarkScene(runner);
+        benchmarkPathTracer(runner);
+        benchmarkSoftwareRasterizer(runner);
+        benchmarkImages(runner, images);
+
+        if(!output.empty()) {
+            runner.write(output);
+        }
+    } catch(const std::exception& exception) {
+        std::cerr << "ERROR : " << exception.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+/******************************************************************************************************
+ * @file  maths.cpp
+ * @brief Benchmarks of the maths library
+ ******************************************************************************************************/
+
+#include "suites.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FrustumCuller.hpp"
+#include "maths/bounds.hpp"
+#include "maths/constants.hpp"
+#include "maths/frustum.hpp"
+#include "maths/functions.hpp"
+#include "maths/Matrix4.hpp"
+#include "maths/transformations.hpp"
+
+namespace {
+    // Operands are read from a small ring so that the compiler cannot fold the calls into constants
+    constexpr std::size_t RING_SIZE = 16;
+
+    std::array<Matrix4, RING_SIZE> makeMatrices() {
+        std::array<Matrix4, RING_SIZE> matrices;
+        for(std::size_t i = 0 ; i < RING_SIZE ; ++i) {
+            const float f = static_cast<float>(i);
+            matrices[i] = translate(f, 2.0f * f, -f) * rotate(10.0f + 20.0f * f, normalize(Vector(1.0f, f, 2.0f)))
+                          * scale(1.0f + 0.1f * f);
+        }
+
+        return matrices;
+    }
+
+    std::array<Vector, RING_SIZE> makeDirections() {
+        std::array<Vector, RING_SIZE> directions;
+        for(std::size_t i = 0 ; i < RING_SIZE ; ++i) {
+            const float f = static_cast<float>(i);
+            directions[i] = normalize(Vector(std::sin(f), std::cos(f), 0.5f - 0.1f * f));
+        }
+
+        return directions;
+    }
+}
+
+void benchmarkMaths(BenchmarkRunner& runner) {
+    const std::array<Matrix4, RING_SIZE> matrices = makeMatrices();
+    const std::array<Vector, RING_SIZE> directions = makeDirections();
+    std::size_t i = 0;
+
+    const auto next = [&i] { i = (i + 1) % RING_SIZE; return i; };
+
+    /* Matrix4 */ {
+        runner.run("Matrix4 * Matrix4", [&] {
+            const std::size_t j = next();
+            doNotOptimize(matrices[j] * matrices[(j + 5) % RING_SIZE]);
+        });
+
+        runner.run("Matrix4 * vec4", [&] {
+            const std::size_t j = next();
+            doNotOptimize(matrices[j] * vec4(directions[j].x, directions[j].y, directions[j].z, 1.0f));
+        });
+
+        runner.run("Matrix4 * Matrix4 (in place)", [&] {
+            Matrix4 matrix = matrices[next()];
+            matrix *= matrices[i ^ 1];
+            doNotOptimize(matrix);
+        });
+
+        runner.run("transpose", [&] { doNotOptimize(transpose(matrices[next()])); });
+        runner.run("determinant", [&] { doNotOptimize(determinant(matrices[next()])); });
+        runner.run("inverse", [&] { doNotOptimize(inverse(matrices[next()])); });
+    }
+
+    /* Transformations */ {
+        runner.run("rotate(angle, axis)", [&] {
+            const std::size_t j = next();
+            doNotOptimize(rotate(static_cast<float>(j) * 22.5f, directions[j]));
+        });
+
+        runner.run("rotate(v1, v2)", [&] {
+            const std::size_t j = next();
+            doNotOptimize(rotate(directions[j], directions[(j + 3) % RING_SIZE]));
+        });
+
+        runner.run("lookAt", [&] {
+            const std::size_t j = next();
+            doNotOptimize(lookAt(Point(directions[j] * 10.0f), Point(0.0f, 0.0f, 0.0f), YAxis()));
+        });
+
+        runner.run("perspective", [&] {
+            doNotOptimize(perspective(45.0f + static_cast<float>(next()), 16.0f / 9.0f, 0.1f, 100.0f));
+        });
+    }
+
+    /* Bounds */ {
+        std::vector<Point> points(1 << 16);
+        for(std::size_t j = 0 ; j < points.size() ; ++j) {
+            const float f = static_cast<float>(j);
+            points[j] = Point(std::sin(f) * f, std::cos(0.5f * f), std::sin(0.25f * f) * 100.0f);
+        }
+
+        const double bytes = static_cast<double>(points.size() * sizeof(Point));
+        runner.run("computeAABB/65536", [&] { doNotOptimize(computeAABB(points.data(), points.size())); }, bytes);
+        runner.run("computeBoundingSphere/65536", [&] {
+            doNotOptimize(computeBoundingSphere(points.data(), points.size()));
+        }, bytes);
+
+        const AABB box = computeAABB(points.data(), points.size());
+        const BoundingSphere sphere = computeBoundingSphere(points.data(), points.size(), box);
+        runner.run("transform AABB", [&] { doNotOptimize(transform(box, matrices[next()])); });
+        runner.run("transform BoundingSphere", [&] { doNotOptimize(transform(sphere, matrices[next()])); });
+    }
+
+    /* Frustum culling */ {
+        // Unit objects on a square grid seen from above one of its corners, so that roughly half of them are culled
+        const Frustum frustum = extractFrustum(perspective(quarter_pi(), 16.0f / 9.0f, 0.1f, 1000.0f)
+                                             * lookAt(Point(0.0f, 20.0f, 0.0f), Point(100.0f, 0.0f, 100.0f), YAxis()));
+
+        for(unsigned count: {1u << 12, 1u << 16, 1u << 20}) {
+            const unsigned side = static_cast<unsigned>(std::sqrt(static_cast<float>(count)));
+
+            FrustumCuller culler;
+            culler.reserve(count);
+            for(unsigned j = 0 ; j < count ; ++j) {
+                const Point center(static_cast<float>(j % side) * 3.0f - 30.0f, 0.0f, static_cast<float>(j / side) * 3.0f - 30.0f);
+                culler.add(BoundingSphere{center, 1.0f}, AABB{center - 1.0f, center + 1.0f});
+            }
+
+            std::vector<std::uint8_t> visibility;
+            unsigned visible = 0;
+            const std::string name = "FrustumCuller::cull/" + std::to_string(count);
+            if(runner.run(name, [&] { visible = culler.cull(frustum, visibility); doNotOptimize(visible); },
+                          static_cast<double>(count) * 10.0 * sizeof(float))) {
+                runner.counter("visible", visible);
+            }
+        }
+    }
+
+    /* Curves */ {
+        runner.run("bezierCurve", [&] {
+            const std::size_t j = next();
+            doNotOptimize(bezierCurve(Point(directions[j]), Point(directions[(j + 1) % RING_SIZE]),
+                                      Point(directions[(j + 2) % RING_SIZE]), Point(directions[(j + 3) % RING_SIZE]),
+                                      static_cast<float>(j) / RING_SIZE));
+        });
+    }
+}
\ No newline at end of file
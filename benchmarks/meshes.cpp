@@ -0,0 +1,150 @@
+/******************************************************************************************************
+ * @file  meshes.cpp
+ * @brief Benchmarks of the mesh generators
+ ******************************************************************************************************/
+
+#include "suites.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include "meshes.hpp"
+#include "MeshBVH.hpp"
+#include "maths/ray.hpp"
+
+namespace {
+    // Number of divisions of the generators, from the default resolution to a heavy one
+    constexpr unsigned RESOLUTIONS[] = {BASE_DIV, 128, 512};
+
+    // Meshes only create their OpenGL objects when first drawn, so the generators run without a context
+    template<typename Generator>
+    void run(BenchmarkRunner& runner, const std::string& name, Generator&& generator) {
+        const bool ran = runner.run(name, [&generator] {
+            Mesh mesh = generator();
+            doNotOptimize(mesh);
+        });
+
+        if(ran) {
+            Mesh mesh = generator();
+            runner.counter("vertices", static_cast<double>(mesh.getPositions()->size()));
+        }
+    }
+}
+
+void benchmarkMeshes(BenchmarkRunner& runner) {
+    const Point P0{-2.0f, 0.0f, 0.0f};
+    const Point P1{-1.0f, 2.0f, 1.0f};
+    const Point P2{1.0f, -2.0f, -1.0f};
+    const Point P3{2.0f, 0.0f, 0.0f};
+
+    run(runner, "initAxis", [] { return initAxis(); });
+    run(runner, "initCube", [] { return initCube(); });
+
+    for(unsigned div: RESOLUTIONS) {
+        const std::string suffix = std::string{"/"} + std::to_string(div);
+
+        run(runner, "initGrid" + suffix, [div] { return initGrid(static_cast<int>(div), static_cast<int>(div)); });
+        run(runner, "initDisk" + suffix, [div] { return initDisk(div); });
+        run(runner, "initCylinder" + suffix, [div] { return initCylinder(div); });
+        run(runner, "initCone" + suffix, [div] { return initCone(div); });
+        run(runner, "initSphere" + suffix, [div] { return initSphere(div / 2, div); });
+        run(runner, "initTorus" + suffix, [div] { return initTorus(1.0f, 0.25f, div / 2, div); });
+        run(runner, "initKleinBottle" + suffix, [div] { return initKleinBottle(div / 2, div); });
+        run(runner, "initTube" + suffix, [&, div] { return initTube(P0, P1, P2, P3, 0.25f, div, div); });
+    }
+
+    /* Normals */ {
+        for(unsigned div: RESOLUTIONS) {
+            const std::string suffix = std::string{"/"} + std::to_string(div);
+
+            Mesh sphere = initSphere(div / 2, div);
+            runner.run("computeNormals sphere" + suffix, [&sphere] {
+                sphere.computeNormals();
+                doNotOptimize(sphere);
+            });
+
+            Mesh klein = initKleinBottle(div / 2, div);
+            runner.run("computeNormals klein" + suffix, [&klein] {
+                klein.computeNormals();
+                doNotOptimize(klein);
+            });
+        }
+    }
+
+    /* Ray casts */ {
+        // Same resolution as the Klein bottle of the scene
+        Mesh klein = initKleinBottle(256, 256);
+        const Point* positions = klein.getPositions()->data();
+        const unsigned* indices = klein.getIndices()->data();
+        const std::size_t triangleCount = klein.getIndices()->size() / 3;
+
+        MeshBVH bvh;
+        if(runner.run("MeshBVH::build klein/256", [&] { bvh.build(positions, indices, triangleCount); doNotOptimize(bvh); })) {
+            runner.counter("triangles", static_cast<double>(bvh.getTriangleCount()));
+            runner.counter("nodes", static_cast<double>(bvh.getNodeCount()));
+        }
+        bvh.build(positions, indices, triangleCount);
+
+        // Rays from around the mesh towards points near its center, most of them hitting it
+        const BoundingSphere& sphere = klein.getBoundingSphere();
+        std::array<Ray, 16> rays;
+        for(std::size_t i = 0 ; i < rays.size() ; ++i) {
+            const float angle = static_cast<float>(i) * 0.39f;
+            const Point origin = sphere.center + 2.0f * sphere.radius * Vector(std::cos(angle), 0.3f * std::sin(3.0f * angle), std::sin(angle));
+            const Point target = sphere.center + 0.2f * sphere.radius * Vector(std::sin(angle), std::cos(2.0f * angle), 0.0f);
+            rays[i] = Ray{origin, normalize(target - origin)};
+        }
+
+        std::size_t ray = 0;
+        if(runner.run("MeshBVH::raycast klein/256", [&] {
+            doNotOptimize(bvh.raycast(rays[ray]));
+            ray = (ray + 1) % rays.size();
+        })) {
+            unsigned hits = 0;
+            for(const Ray& current: rays) { hits += bvh.raycast(current).has_value(); }
+            runner.counter("hits", static_cast<double>(hits) / static_cast<double>(rays.size()));
+        }
+
+        // Packets of 4 close rays around each ray, as for 2x2 pixels, against the same rays cast one by one
+        std::array<Ray[RayPacket::size], 16> coherent;
+        std::array<RayPacket, 16> packets;
+        for(std::size_t i = 0 ; i < rays.size() ; ++i) {
+            for(unsigned lane = 0 ; lane < RayPacket::size ; ++lane) {
+                const Vector jitter{0.002f * static_cast<float>(lane & 1u), 0.002f * static_cast<float>(lane >> 1u), 0.0f};
+                coherent[i][lane] = Ray{rays[i].origin, normalize(rays[i].direction + jitter)};
+            }
+            packets[i] = RayPacket{coherent[i]};
+        }
+
+        runner.run("MeshBVH::raycast 4 rays klein/256", [&] {
+            for(const Ray& current: coherent[ray]) { doNotOptimize(bvh.raycast(current)); }
+            ray = (ray + 1) % rays.size();
+        });
+
+        runner.run("MeshBVH::raycast packet klein/256", [&] {
+            std::array<std::optional<MeshBVH::Hit>, RayPacket::size> hits;
+            std::array<float, RayPacket::size> closest;
+            closest.fill(std::numeric_limits<float>::infinity());
+
+            bvh.raycast(packets[ray], hits, closest);
+            doNotOptimize(hits);
+            ray = (ray + 1) % rays.size();
+        });
+
+        // Every triangle tested, for reference
+        runner.run("raycast brute force klein/256", [&] {
+            float closest = std::numeric_limits<float>::infinity();
+            for(std::size_t i = 0 ; i < triangleCount ; ++i) {
+                const Point& a = positions[indices[3 * i]];
+                float u, v;
+                closest = std::min(closest, intersect(rays[ray], a, positions[indices[3 * i + 1]] - a,
+                                                      positions[indices[3 * i + 2]] - a, u, v));
+            }
+            doNotOptimize(closest);
+            ray = (ray + 1) % rays.size();
+        });
+    }
+}
\ No newline at end of file
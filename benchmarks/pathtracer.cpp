@@ -0,0 +1,73 @@
+/******************************************************************************************************
+ * @file  pathtracer.cpp
+ * @brief Benchmarks of the CPU path tracer
+ ******************************************************************************************************/
+
+#include "suites.hpp"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Light.hpp"
+#include "meshes.hpp"
+#include "PathTracer.hpp"
+#include "ThreadPool.hpp"
+#include "maths/constants.hpp"
+#include "maths/transformations.hpp"
+
+void benchmarkPathTracer(BenchmarkRunner& runner) {
+    constexpr int width = 320;
+    constexpr int height = 180;
+
+    // A grid of objects around a Klein bottle, like a populated scene
+    Mesh cube = initCube();
+    Mesh sphere = initSphere();
+    Mesh torus = initTorus();
+    Mesh cone = initCone();
+    Mesh cylinder = initCylinder();
+    Mesh klein = initKleinBottle(256, 256);
+    Mesh* const meshes[] = {&cube, &sphere, &torus, &cone, &cylinder};
+
+    const Light light{Point{5.0f, 5.0f, 0.0f}, Color{0.2f, 1.0f}, Color{1.0f}, Color{1.0f}};
+
+    std::vector<PathTracer::Instance> instances{
+        {&klein, scale(0.5f)},
+        {&sphere, translate(light.position) * scale(0.2f), nullptr, true}
+    };
+    for(int i = 0 ; i < 64 ; ++i) {
+        const float x = static_cast<float>(i % 8 - 4) * 3.0f + 1.5f;
+        const float z = static_cast<float>(i / 8 - 4) * 3.0f + 1.5f;
+        instances.push_back({meshes[i % 5], translate(x, 0.0f, z) * rotateY(static_cast<float>((i * 37) % 360))});
+    }
+
+    const Matrix4 view = lookAt(Point{0.0f, 8.0f, 16.0f}, Point{}, Vector{0.0f, 1.0f, 0.0f});
+    const Matrix4 projection = perspective(quarter_pi(), static_cast<float>(width) / height, 0.1f, 100.0f);
+    const PathTracer::Material material{Color{0.5f, 1.0f}, Color{1.0f}, Color{1.0f}, 32.0f};
+
+    // Scaling across cores, doubling the threads of the pool up to the hardware ones. The calling thread works too
+    const unsigned hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<unsigned> threadCounts;
+    for(unsigned threads = 1 ; threads < hardwareThreads ; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(hardwareThreads);
+
+    for(unsigned threads: threadCounts) {
+        ThreadPool pool{threads};
+
+        for(unsigned bounces: {0u, 1u}) {
+            PathTracer tracer{width, height, bounces, pool};
+            tracer.setScene(instances);
+            tracer.setCamera(view, projection);
+            tracer.setLighting(light, material, Color{0.1f, 1.0f});
+
+            const std::string name = "PathTracer::render " + std::to_string(width) + "x" + std::to_string(height)
+                                   + " bounces " + std::to_string(bounces) + "/" + std::to_string(threads) + " threads";
+            if(runner.run(name, [&tracer] { tracer.render(); })) {
+                runner.counter("rays per sample", static_cast<double>(tracer.getRayCount()) / tracer.getSampleCount());
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+/******************************************************************************************************
+ * @file  rasterizer.cpp
+ * @brief Benchmarks of the software rasterizer
+ ******************************************************************************************************/
+
+#include "suites.hpp"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Light.hpp"
+#include "meshes.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "ThreadPool.hpp"
+#include "maths/constants.hpp"
+#include "maths/transformations.hpp"
+
+void benchmarkSoftwareRasterizer(BenchmarkRunner& runner) {
+    constexpr int width = 1280;
+    constexpr int height = 720;
+
+    // The scene of the path tracer benchmarks, with the axis and the grid of the application
+    Mesh cube = initCube();
+    Mesh sphere = initSphere();
+    Mesh torus = initTorus();
+    Mesh cone = initCone();
+    Mesh cylinder = initCylinder();
+    Mesh klein = initKleinBottle(256, 256);
+    Mesh axis = initAxis(5.0f);
+    Mesh grid = initGrid();
+    Mesh* const meshes[] = {&cube, &sphere, &torus, &cone, &cylinder};
+
+    const Light light{Point{5.0f, 5.0f, 0.0f}, Color{0.2f, 1.0f}, Color{1.0f}, Color{1.0f}};
+
+    const Point camera{0.0f, 8.0f, 16.0f};
+    const Matrix4 view = lookAt(camera, Point{}, Vector{0.0f, 1.0f, 0.0f});
+    const Matrix4 projection = perspective(quarter_pi(), static_cast<float>(width) / height, 0.1f, 100.0f);
+    const SoftwareRasterizer::PhongMaterial material{Color{0.5f, 1.0f}, Color{1.0f}, Color{1.0f}, 32.0f};
+
+    // Scaling across cores, doubling the threads of the pool up to the hardware ones. The calling thread works too
+    const unsigned hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<unsigned> threadCounts;
+    for(unsigned threads = 1 ; threads < hardwareThreads ; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(hardwareThreads);
+
+    for(unsigned threads: threadCounts) {
+        ThreadPool pool{threads};
+
+        SoftwareRasterizer rasterizer{width, height, pool};
+        rasterizer.setCamera(view, projection, camera);
+        rasterizer.setLighting(light, material);
+
+        const auto render = [&] {
+            rasterizer.begin(Color{0.1f, 1.0f});
+
+            rasterizer.use(SoftwareRasterizer::Program::noLight);
+            rasterizer.draw(axis, Identity());
+            rasterizer.draw(grid, Identity());
+
+            rasterizer.use(SoftwareRasterizer::Program::light);
+            rasterizer.draw(sphere, translate(light.position) * scale(0.2f));
+
+            rasterizer.use(SoftwareRasterizer::Program::phong);
+            rasterizer.draw(klein, scale(0.5f));
+            for(int i = 0 ; i < 64 ; ++i) {
+                const float x = static_cast<float>(i % 8 - 4) * 3.0f + 1.5f;
+                const float z = static_cast<float>(i / 8 - 4) * 3.0f + 1.5f;
+                rasterizer.draw(*meshes[i % 5], translate(x, 0.0f, z) * rotateY(static_cast<float>((i * 37) % 360)));
+            }
+
+            rasterizer.finish();
+        };
+
+        const std::string name = "SoftwareRasterizer frame " + std::to_string(width) + "x" + std::to_string(height)
+                               + "/" + std::to_string(threads) + " threads";
+        if(runner.run(name, render)) {
+            runner.counter("primitives", static_cast<double>(rasterizer.getPrimitiveCount()));
+            runner.counter("occluded blocks", static_cast<double>(rasterizer.getOccludedBlockCount()));
+        }
+    }
+}
\ No newline at end of file
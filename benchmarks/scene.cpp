@@ -0,0 +1,212 @@
+/******************************************************************************************************
+ * @file  scene.cpp
+ * @brief Benchmarks of the spatial structures over the objects of a scene
+ ******************************************************************************************************/
+
+#include "suites.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "FrustumCuller.hpp"
+#include "meshes.hpp"
+#include "OcclusionCuller.hpp"
+#include "SceneBVH.hpp"
+#include "SceneGraph.hpp"
+#include "maths/bounds.hpp"
+#include "maths/constants.hpp"
+#include "maths/frustum.hpp"
+#include "maths/ray.hpp"
+#include "maths/transformations.hpp"
+
+namespace {
+    constexpr std::size_t RING_SIZE = 16;
+
+    /**
+     * @brief Objects of random sizes scattered over a square of side 3 * sqrt(count), like the grids of Scene::populate
+     */
+    std::vector<AABB> makeBoxes(unsigned count, std::mt19937& random) {
+        const float side = 3.0f * std::sqrt(static_cast<float>(count));
+        std::uniform_real_distribution<float> position(-0.5f * side, 0.5f * side);
+        std::uniform_real_distribution<float> height(0.0f, 4.0f);
+        std::uniform_real_distribution<float> size(0.25f, 1.5f);
+
+        std::vector<AABB> boxes(count);
+        for(AABB& box: boxes) {
+            const Point center(position(random), height(random), position(random));
+            const Vector extent(size(random), size(random), size(random));
+            box = AABB{center - extent, center + extent};
+        }
+
+        return boxes;
+    }
+}
+
+void benchmarkScene(BenchmarkRunner& runner) {
+    std::mt19937 random{42};
+
+    for(unsigned count: {1u << 16, 1u << 20}) {
+        const std::string suffix = "/" + std::to_string(count);
+        const std::vector<AABB> boxes = makeBoxes(count, random);
+        const float side = 3.0f * std::sqrt(static_cast<float>(count));
+
+        SceneBVH bvh;
+        if(runner.run("SceneBVH::build" + suffix, [&] { bvh.build(boxes); doNotOptimize(bvh.getNodeCount()); },
+                      static_cast<double>(count * sizeof(AABB)))) {
+            runner.counter("nodes", bvh.getNodeCount());
+            runner.counter("cost", bvh.getCost());
+        }
+        bvh.build(boxes);
+
+        runner.run("SceneBVH::refit" + suffix, [&] { bvh.refit(); doNotOptimize(bvh.getNodes()[0]); });
+
+        // 1% of the objects move a little every call, each refitting its path to the root
+        std::vector<unsigned> moved(count / 100);
+        for(unsigned& object: moved) { object = random() % count; }
+
+        float offset = 0.0f;
+        runner.run("SceneBVH::update 1%" + suffix, [&] {
+            offset = offset > 0.5f ? -0.5f : offset + 0.01f;
+            for(unsigned object: moved) {
+                bvh.update(object, AABB{boxes[object].min + offset, boxes[object].max + offset});
+            }
+        });
+        bvh.build(boxes);
+
+        // Camera looking along the diagonal of the square from above one of its corners
+        const Matrix4 viewProjection = perspective(quarter_pi(), 16.0f / 9.0f, 0.1f, 300.0f)
+                                     * lookAt(Point(-0.5f * side, 20.0f, -0.5f * side), Point(0.0f, 0.0f, 0.0f), YAxis());
+        const Frustum frustum = extractFrustum(viewProjection);
+
+        std::vector<std::uint8_t> visibility;
+        unsigned visible = 0;
+        if(runner.run("SceneBVH::cull" + suffix, [&] { visible = bvh.cull(frustum, visibility); doNotOptimize(visible); })) {
+            runner.counter("visible", visible);
+        }
+
+        FrustumCuller culler;
+        culler.reserve(count);
+        for(const AABB& box: boxes) {
+            culler.add(BoundingSphere{box.center(), length(box.extent())}, box);
+        }
+
+        if(runner.run("FrustumCuller::cull" + suffix, [&] { visible = culler.cull(frustum, visibility); doNotOptimize(visible); })) {
+            runner.counter("visible", visible);
+        }
+
+        // Camera walking among the objects, whose closest ones hide most of the others
+        const Point eye(-0.5f * side, 2.0f, -0.5f * side);
+        const Matrix4 groundViewProjection = perspective(quarter_pi(), 16.0f / 9.0f, 0.1f, 300.0f)
+                                           * lookAt(eye, Point(0.0f, 2.0f, 0.0f), YAxis());
+        culler.cull(extractFrustum(groundViewProjection), visibility);
+
+        std::vector<unsigned> occluders;
+        bvh.query(BoundingSphere{eye, 20.0f}, occluders);
+        const auto closest = occluders.begin() + std::min<std::ptrdiff_t>(16, std::ssize(occluders));
+        std::partial_sort(occluders.begin(), closest, occluders.end(), [&](unsigned object1, unsigned object2) {
+            return distanceSquared(boxes[object1], eye) < distanceSquared(boxes[object2], eye);
+        });
+        occluders.erase(closest, occluders.end());
+
+        // The unit cube spans [-1, 1]
+        Mesh cube = initCube();
+        OcclusionCuller occlusion;
+        const auto render = [&] {
+            occlusion.begin(groundViewProjection);
+            for(unsigned object: occluders) {
+                occlusion.addOccluder(cube, translate(boxes[object].center()) * scale(boxes[object].extent().x,
+                                                                                     boxes[object].extent().y,
+                                                                                     boxes[object].extent().z));
+            }
+            occlusion.render();
+            occlusion.wait();
+        };
+
+        if(runner.run("OcclusionCuller::render" + suffix, render)) {
+            runner.counter("occluders", static_cast<double>(occluders.size()));
+            runner.counter("triangles", occlusion.getTriangleCount());
+        }
+        render();
+
+        unsigned occluded = 0;
+        if(runner.run("OcclusionCuller::isOccluded" + suffix, [&] {
+            occluded = 0;
+            for(unsigned object = 0 ; object < count ; ++object) {
+                if(visibility[object] && occlusion.isOccluded(boxes[object])) { ++occluded; }
+            }
+            doNotOptimize(occluded);
+        })) {
+            runner.counter("visible", static_cast<double>(std::count(visibility.begin(), visibility.end(), 1)));
+            runner.counter("occluded", occluded);
+        }
+
+        std::array<Ray, RING_SIZE> rays;
+        for(std::size_t i = 0 ; i < RING_SIZE ; ++i) {
+            const float x = static_cast<float>(i % 4) / 2.0f - 0.75f;
+            const float y = static_cast<float>(i / 4) / 4.0f - 0.5f;
+            rays[i] = screenRay(viewProjection, x, y);
+        }
+
+        std::size_t ray = 0;
+        runner.run("SceneBVH::raycast" + suffix, [&] {
+            doNotOptimize(bvh.raycast(rays[ray]));
+            ray = (ray + 1) % RING_SIZE;
+        });
+
+        std::vector<unsigned> neighbours;
+        std::size_t query = 0;
+        if(runner.run("SceneBVH::query sphere" + suffix, [&] {
+            neighbours.clear();
+            bvh.query(BoundingSphere{boxes[query].center(), 10.0f}, neighbours);
+            doNotOptimize(neighbours.data());
+            query = (query + 1) % RING_SIZE;
+        })) {
+            runner.counter("neighbours", static_cast<double>(neighbours.size()));
+        }
+    }
+
+    // Each node below a random earlier one, which makes a tree about 15 levels deep whose upper nodes have large subtrees
+    constexpr unsigned nodeCount = 1u << 20;
+    constexpr unsigned rootCount = 1024;
+    const std::string suffix = "/" + std::to_string(nodeCount);
+
+    SceneGraph graph;
+    graph.reserve(nodeCount);
+    for(unsigned node = 0 ; node < nodeCount ; ++node) {
+        const float angle = static_cast<float>(node % 360);
+        graph.add(translate(1.0f, 0.0f, 0.0f) * rotateY(angle), node < rootCount ? SceneGraph::none : random() % node);
+    }
+    graph.update();
+
+    std::vector<SceneGraph::Node> moved(nodeCount / 100);
+    for(SceneGraph::Node& node: moved) { node = random() % nodeCount; }
+
+    float angle = 0.0f;
+    unsigned updated = 0;
+    if(runner.run("SceneGraph::update 1% dirty" + suffix, [&] {
+        angle = angle >= 360.0f ? 0.0f : angle + 1.0f;
+        for(SceneGraph::Node node: moved) { graph.setLocal(node, translate(1.0f, 0.0f, 0.0f) * rotateY(angle)); }
+
+        updated = graph.update();
+        doNotOptimize(updated);
+    })) {
+        runner.counter("updated", updated);
+        runner.counter("levels", graph.getLevelCount());
+    }
+
+    runner.run("SceneGraph::update clean" + suffix, [&] { doNotOptimize(graph.update()); });
+
+    if(runner.run("SceneGraph::update roots dirty" + suffix, [&] {
+        for(SceneGraph::Node node = 0 ; node < rootCount ; ++node) { graph.setLocal(node, graph.getLocal(node)); }
+
+        updated = graph.update();
+        doNotOptimize(updated);
+    })) {
+        runner.counter("updated", updated);
+    }
+}
\ No newline at end of file
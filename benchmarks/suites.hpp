@@ -0,0 +1,40 @@
+/******************************************************************************************************
+ * @file  suites.hpp
+ * @brief Declaration of the benchmark suites
+ ******************************************************************************************************/
+
+#pragma once
+
+#include "BenchmarkRunner.hpp"
+
+/**
+ * @brief Matrix4 operations, rotations and Bezier curves
+ */
+void benchmarkMaths(BenchmarkRunner& runner);
+
+/**
+ * @brief Every init* generator at several resolutions and the normal generation of Mesh
+ */
+void benchmarkMeshes(BenchmarkRunner& runner);
+
+/**
+ * @brief Building, refitting and querying the hierarchy over a million scene objects, against flat frustum culling,
+ * occlusion culling behind the objects closest to a camera at their level, and updating a scene graph of a million nodes
+ */
+void benchmarkScene(BenchmarkRunner& runner);
+
+/**
+ * @brief Samples of the CPU path tracer over a small scene, with and without bounces, for more and more threads
+ */
+void benchmarkPathTracer(BenchmarkRunner& runner);
+
+/**
+ * @brief Frames of the software rasterizer over the same scene with the axis and the grid, for more and more threads
+ */
+void benchmarkSoftwareRasterizer(BenchmarkRunner& runner);
+
+/**
+ * @brief ImageData decoding, encoding to each ImageFormat and mipmap chains
+ * @param directory Directory holding the images to decode
+ */
+void benchmarkImages(BenchmarkRunner& runner, const std::string& directory);
\ No newline at end of file
@@ -0,0 +1,154 @@
+/******************************************************************************************************
+ * @file  main.cpp
+ * @brief Entry point of the checks, run by ctest
+ ******************************************************************************************************/
+
+// Standard C++ Library Headers
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// User-Defined Headers
+#include "CompressedImage.hpp"
+#include "HeadlessContext.hpp"
+#include "ImageData.hpp"
+#include "MipChain.hpp"
+#include "TextureCache.hpp"
+
+namespace {
+    // Lowest PSNR of level 0 accepted for the planet textures, 3 dB below the worst one (ceres.jpg) when it was set
+    constexpr float minPsnr = 30.0f;
+
+    /**
+     * @brief Silences std::cout while alive, ImageData logs every image it reads
+     */
+    class MuteOutput {
+    public:
+        MuteOutput() : previous{std::cout.rdbuf(sink.rdbuf())} { }
+        ~MuteOutput() { std::cout.rdbuf(previous); }
+
+    private:
+        std::ostringstream sink;
+        std::streambuf* previous;
+    };
+
+    std::vector<std::string> findImages(const std::string& directory) {
+        std::vector<std::string> paths;
+        if(std::filesystem::is_directory(directory)) {
+            for(const std::filesystem::directory_entry& entry: std::filesystem::directory_iterator{directory}) {
+                if(entry.path().extension() == ".jpg") { paths.push_back(entry.path().string()); }
+            }
+        }
+
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    /**
+     * @brief Encodes every image to BC1 and BC3, the decoded blocks must stay close enough to the original
+     */
+    bool checkCompression(const std::vector<std::string>& paths) {
+        bool passed = true;
+        for(const std::string& path: paths) {
+            std::optional<ImageData> image;
+            {
+                MuteOutput mute;
+                image.emplace(path);
+            }
+
+            for(const auto& [format, name]: {std::pair{CompressionFormat::BC1, "BC1"},
+                                             std::pair{CompressionFormat::BC3, "BC3"}}) {
+                const CompressedImage compressed{*image, format, false};
+                const float score = psnr(*image, compressed.decode());
+
+                const bool ok = score >= minPsnr;
+                passed = passed && ok;
+                std::cout << (ok ? "PASS" : "FAIL") << " : " << name << ' '
+                          << std::filesystem::path{path}.filename().string() << ", PSNR " << score << " dB (minimum " << minPsnr << " dB)\n";
+            }
+        }
+
+        return passed;
+    }
+
+    /**
+     * @brief Loads every image through the texture cache, which builds their mipmap chains, without copying any pixel.
+     * Without an OpenGL context, the images only go through buildMipChain
+     */
+    bool checkCopies(const std::vector<std::string>& paths) {
+        std::optional<HeadlessContext> context;
+        if(HeadlessContext::isAvailable()) {
+            try {
+                context.emplace();
+                if(!gladLoadGLLoader((GLADloadproc) HeadlessContext::getProcAddress)) { context.reset(); }
+            } catch(const std::runtime_error& error) {
+                std::cout << "LOG : " << error.what() << ".\n";
+            }
+        }
+
+        const unsigned long long copied = ImageData::getBytesCopied();
+        {
+            MuteOutput mute;
+            if(context) {
+                TextureCache cache;
+                for(const std::string& path: paths) { cache.get(path); }
+            } else {
+                for(const std::string& path: paths) { buildMipChain(ImageData{path}); }
+            }
+        }
+
+        const unsigned long long bytes = ImageData::getBytesCopied() - copied;
+        std::cout << (bytes == 0 ? "PASS" : "FAIL") << " : " << paths.size() << " images loaded through "
+                  << (context ? "the texture cache" : "buildMipChain, without any OpenGL context") << ", "
+                  << bytes << " bytes copied\n";
+
+        return bytes == 0;
+    }
+}
+
+// Main Function
+// [--images directory] [check...], every check runs when none is given : compression, copies
+int main(int argc, char* argv[]) {
+    std::string directory = "data/textures";
+    std::vector<std::string> checks;
+
+    for(int i = 1 ; i < argc ; ++i) {
+        const std::string option = argv[i];
+        if(option == "--images" && i + 1 < argc) {
+            directory = argv[++i];
+        } else if(option == "compression" || option == "copies") {
+            checks.push_back(option);
+        } else {
+            std::cerr << "Unknown option " << option << '\n';
+            return 2;
+        }
+    }
+
+    if(checks.empty()) { checks = {"compression", "copies"}; }
+
+    const std::vector<std::string> paths = findImages(directory);
+    if(paths.empty()) {
+        std::cerr << "No images found in \"" << directory << "\".\n";
+        return 1;
+    }
+
+    try {
+        bool passed = true;
+        for(const std::string& check: checks) {
+            std::cout << "\n------------ " << check << " ------------\n";
+            if(check == "compression") { passed = checkCompression(paths) && passed; }
+            if(check == "copies") { passed = checkCopies(paths) && passed; }
+        }
+
+        return passed ? 0 : 1;
+    } catch(const std::exception& exception) {
+        std::cerr << "ERROR : " << exception.what() << '\n';
+        return 1;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#version 430 core
+
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec2 aTexCoord;
+
+// Index of the draw, which is its base instance
+layout (location = 4) in uint aDrawIndex;
+
+struct Draw {
+    mat4 model;
+    vec4 color;
+};
+
+// Model matrices are uploaded row major like every other matrix
+layout (std430, binding = 0, row_major) readonly buffer Draws {
+    Draw draws[];
+};
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec4 Color;
+out vec2 TexCoord;
+
+uniform mat4 u_view;
+uniform mat4 u_projection;
+
+void main() {
+    Draw draw = draws[aDrawIndex];
+
+    FragPos = vec3(draw.model * vec4(aPosition, 1.0));
+
+    // Objects are only rotated and uniformly scaled, so normals are transformed by the model matrix itself
+    Normal = vec3(draw.model * vec4(aNormal, 0.0));
+    Color = aColor * draw.color;
+    TexCoord = aTexCoord;
+
+    gl_Position = u_projection * u_view * vec4(FragPos, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec2 aTexCoord;
+
+// Per instance, the model matrix is uploaded row major so multiplying on the left undoes its transposition
+layout (location = 4) in mat4 aModel;
+layout (location = 8) in vec4 aInstanceColor;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec4 Color;
+out vec2 TexCoord;
+
+uniform mat4 u_view;
+uniform mat4 u_projection;
+
+void main() {
+    FragPos = vec3(vec4(aPosition, 1.0) * aModel);
+
+    // Instances are only rotated and uniformly scaled, so normals are transformed by the model matrix itself
+    Normal = vec3(vec4(aNormal, 0.0) * aModel);
+    Color = aColor * aInstanceColor;
+    TexCoord = aTexCoord;
+
+    gl_Position = u_projection * u_view * vec4(FragPos, 1.0);
+}
\ No newline at end of file
@@ -9,37 +9,194 @@
 #include <GLFW/glfw3.h>
 #include <string>
 #include <map>
+#include <optional>
+#include <vector>
 
 #include "Camera.hpp"
+#include "CameraPath.hpp"
+#include "FrameCapture.hpp"
+#include "Framebuffer.hpp"
+#include "GpuTimer.hpp"
+#include "HeadlessContext.hpp"
 #include "Light.hpp"
 #include "meshes.hpp"
+#include "OcclusionCuller.hpp"
+#include "RenderQueue.hpp"
+#include "RenderStats.hpp"
+#include "Scene.hpp"
+#include "SceneGraph.hpp"
 #include "Shader.hpp"
+#include "SoftwareRasterizer.hpp"
 #include "Texture.hpp"
+#include "TextureCache.hpp"
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
 
 Point2D getMousePos(GLFWwindow* window);
 
+/**
+ * @brief How the objects of the scene are drawn
+ */
+enum class DrawPath {
+    individual, // One draw call per object
+    instanced,  // One instanced draw call per mesh
+    indirect    // A single multi-draw indirect call from the geometry pool of the scene
+};
+
+/**
+ * @brief How the objects outside of the view frustum are found, they are not drawn
+ */
+enum class Culling {
+    none,
+    flat,           // Every object is tested, several at a time with SIMD
+    hierarchical    // The hierarchy over the objects is walked, skipping whole groups inside or outside of the frustum
+};
+
+/**
+ * @brief Settings of a headless run, see Application::runHeadless
+ */
+struct HeadlessSettings {
+    unsigned frames = 120;
+    float framerate = 60.0f;
+
+    CameraPath path = CameraPath::orbit(Point{}, 7.5f, 3.0f, 8.0f);
+
+    std::string output = "headless.png";
+    std::string golden;
+    float minPsnr = 40.0f;
+
+    bool software = false; // Drawn by the SoftwareRasterizer instead of OpenGL, from the same render queue
+};
+
+/**
+ * @brief Settings of a benchmark run, see Application::runBenchmark
+ */
+struct BenchmarkSettings {
+    unsigned frames = 600;
+    unsigned warmupFrames = 60;
+    float framerate = 60.0f;
+
+    unsigned objectCount = 1000;
+    bool spheres = false;       // Every object is a sphere instead of cycling through a few meshes
+    DrawPath drawPath = DrawPath::individual;
+    Culling culling = Culling::hierarchical;
+    bool occlusion = true;      // Objects hidden behind the closest ones are not drawn either, with frustum culling only
+
+    // When empty, the camera circles over the objects, or among them at their height when eyeLevel is set, where the
+    // closest ones hide many of the others
+    CameraPath path;
+    bool eyeLevel = false;
+
+    std::string output = "benchmark.json";
+};
+
+/**
+ * @brief Settings of a path traced render, see Application::runPathTracer
+ */
+struct PathTracerSettings {
+    unsigned samples = 64;
+    unsigned bounces = 1;
+    unsigned objectCount = 0;
+
+    // Camera and light of this frame of a headless run following the path, so that both images can be compared
+    unsigned frame = 119;
+    float framerate = 60.0f;
+    CameraPath path = CameraPath::orbit(Point{}, 7.5f, 3.0f, 8.0f);
+
+    std::string output = "pathtraced.png";
+    std::string golden;
+    float minPsnr = 25.0f;
+};
+
 class Application {
 public:
-    Application(const char* title, int width, int height);
+    /**
+     * @brief In headless mode, the application renders into an offscreen framebuffer of the given size,
+     * using an EGL context when available and an invisible window otherwise, and ImGui is not initialized
+     */
+    Application(const char* title, int width, int height, bool headless = false);
     ~Application();
 
     void run();
 
+    /**
+     * @brief Renders a fixed number of frames with a fixed time step while following the camera path,
+     * then writes the last frame and compares it to the golden image if there is one
+     * @return Whether the last frame is close enough to the golden image
+     */
+    bool runHeadless(const HeadlessSettings& settings);
+
+    /**
+     * @brief Renders as fast as possible, with vsync disabled, a fixed number of frames of a scene populated
+     * with objects while following the camera path, then writes the frame statistics as JSON.
+     * Works both with a window and headless
+     */
+    void runBenchmark(const BenchmarkSettings& settings);
+
+    /**
+     * @brief Renders a frame of the scene with the path tracer on every thread, without the axis and the grid,
+     * then writes it and compares it to the golden image if there is one
+     * @return Whether the image is close enough to the golden image
+     */
+    bool runPathTracer(const PathTracerSettings& settings);
+
 private:
+    void drawScene();
+
+    /**
+     * @brief Culls the objects and fills the render queue with the draws of the frame
+     */
+    void buildRenderQueue();
+
+    /**
+     * @brief Starts rendering the closest objects as occluders on a thread of the pool, see OcclusionCuller
+     */
+    void renderOccluders(const Frustum& frustum, const Matrix4& viewProjection, const Point& cameraPosition);
+
+    /**
+     * @brief Draws the render queue of the frame with the software rasterizer instead of OpenGL
+     */
+    void rasterizeScene(SoftwareRasterizer& rasterizer);
+
+    /**
+     * @brief Performance overlay at the top of the controls, showing the statistics of the previous frame
+     */
+    void drawStatistics();
+
+    /**
+     * @brief Current and peak memory usage of every subsystem, with editable video memory budgets
+     */
+    void drawMemory();
+
+    /**
+     * @brief Flame view of the scopes of the last frame, see Profiler
+     */
+    void drawProfiler();
+    void exportTrace();
+
     void processInputs();
 
-    void bindTexture(const Texture& texture = Texture{}) const;
+    /**
+     * @brief Picks the object under the cursor, whose triangles are the first hit by a ray from the camera
+     */
+    void pickObject();
+
+    void bindTexture(const Shader& shader, const Texture& texture = Texture{}) const;
 
-    void setModel(const Matrix4& model);
+    void setModel(const Shader& shader, const Matrix4& model);
 
-    void updateUniforms() const;
+    void updateUniforms(const Shader& shader) const;
+
+    [[nodiscard]] Matrix4 getView() const;
+    [[nodiscard]] Matrix4 getProjection() const;
 
     void toggleWireframe();
     void toggleCullface();
     void toggleCursorVisibility();
 
+    void takeScreenshot();
+    void toggleRecording();
+
     void processFirstPersonInputs();
     void processThirdPersonInputs();
 
@@ -52,12 +209,39 @@ private:
     bool isCursorActive;
     bool isAxisDrawn;
     bool isGridDrawn;
+    DrawPath drawPath;
+    Culling culling;
+    bool occlusion;
+    bool headless;
 
     GLFWwindow* window;
+    HeadlessContext* headlessContext;
+    Framebuffer* framebuffer;
     Shader* defaultShader;
+    Shader* defaultInstancedShader;
+    Shader* defaultIndirectShader;  // Null when multi-draw indirect is not supported
     Shader* lightShader;
     Shader* noLightShader;
 
+    FrameCapture* frameCapture;
+    GpuTimer* gpuTimer;
+    unsigned screenshotCount;
+    unsigned traceCount;
+
+    TextureCache textures;
+    Scene* scene;
+    RenderQueue renderQueue;
+
+    // Markers drawn at the light and at the target of the third person camera, scaled below the node they follow
+    SceneGraph sceneGraph;
+    SceneGraph::Node lightNode;
+    SceneGraph::Node lightMarker;
+    SceneGraph::Node targetNode;
+    SceneGraph::Node targetMarker;
+    OcclusionCuller occlusionCuller;
+
+    RGB background;
+
     Light light;
 
     bool camera;
@@ -67,6 +251,14 @@ private:
     float time;
     float delta;
 
+    std::optional<unsigned> pickedObject;
+    MeshBVH::Hit pickedTriangle;
+
+    RenderStats frameStats;
+    std::vector<float> frameTimes;
+    unsigned frameTimesIndex;
+    float cpuTime;
+
     Point2D mousePos;
     Point2D oldMousePos;
 
@@ -0,0 +1,42 @@
+/******************************************************************************************************
+ * @file  BVH.hpp
+ * @brief Declaration of the bounding volume hierarchy builder
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include "maths/bounds.hpp"
+
+/**
+ * @brief Node of a binary hierarchy, 32 bytes so that two of them fit in a cache line
+ */
+struct BVHNode {
+    AABB box;
+    unsigned first; // Children of inner nodes are first and first + 1, primitives of leaves start at first
+    unsigned count; // Primitives of a leaf, 0 for inner nodes
+};
+
+/**
+ * @brief Binary hierarchy over the boxes of primitives, which are referred to by their index in the boxes
+ */
+struct BVH {
+    std::vector<BVHNode> nodes;     // Children are always after their parent
+    std::vector<unsigned> parents;  // The root is its own parent
+    std::vector<unsigned> order;    // Primitives ordered by leaf, each leaf owning a contiguous range
+};
+
+/**
+ * @brief Builds the hierarchy with the surface area heuristic, splitting each node at the best of the planes between
+ * up to 16 bins of the centroids of its boxes along each axis. Nodes are kept as leaves when testing all of their
+ * primitives is cheaper than visiting their children
+ * @param maxLeafSize Leaves with more primitives are split even when it looks more expensive
+ */
+BVH buildBVH(const std::vector<AABB>& boxes, unsigned maxLeafSize = 8);
+
+/**
+ * @brief Sum over the nodes of their surface area relative to the root times their cost, the quantity the build
+ * minimizes, which grows as refits loosen the boxes
+ */
+float surfaceAreaCost(const std::vector<BVHNode>& nodes);
\ No newline at end of file
@@ -0,0 +1,45 @@
+/******************************************************************************************************
+ * @file  CameraPath.hpp
+ * @brief Declaration of the CameraPath class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include "maths/vec3.hpp"
+
+/**
+ * @brief Scripted camera movement, interpolated between keyframes with Catmull-Rom splines.
+ * Looping paths are expected to end on their first keyframe.
+ * It makes headless renders and benchmarks see the exact same frames from one run to the next.
+ */
+class CameraPath {
+public:
+    struct Keyframe {
+        float time;
+        Point position;
+        Point target;
+    };
+
+    CameraPath(bool loop = true);
+
+    /**
+     * @brief Adds a keyframe, keyframes must be added in chronological order
+     */
+    void add(float time, const Point& position, const Point& target);
+
+    [[nodiscard]] Keyframe sample(float time) const;
+
+    [[nodiscard]] float getDuration() const;
+    [[nodiscard]] bool isEmpty() const;
+
+    /**
+     * @brief Circles around center at the given distance and height
+     */
+    static CameraPath orbit(const Point& center, float radius, float height, float duration, unsigned keyframes = 16);
+
+private:
+    bool loop;
+    std::vector<Keyframe> keyframes;
+};
\ No newline at end of file
@@ -0,0 +1,66 @@
+/******************************************************************************************************
+ * @file  CompressedImage.hpp
+ * @brief Declaration of the CompressedImage class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ImageData.hpp"
+
+enum class CompressionFormat : unsigned {
+    BC1 = 1, // RGB, 8 bytes per 4x4 block
+    BC3 = 3  // RGBA, 16 bytes per 4x4 block
+};
+
+/**
+ * @brief Block compressed image with its precomputed mipmap levels, meant to be uploaded as is to the GPU.
+ * It is stored on disk in the ".gtex" container format:
+ *   "GTEX", version, format, width, height, level count (unsigned 32-bit integers),
+ *   then for each level: width, height, size in bytes and the blocks themselves.
+ */
+class CompressedImage {
+public:
+    struct Level {
+        int width;
+        int height;
+        std::vector<unsigned char> data;
+    };
+
+    /**
+     * @brief Reads a ".gtex" file
+     */
+    CompressedImage(const std::string& path);
+
+    /**
+     * @brief Encodes an image, the blocks of each level are compressed in parallel
+     * @param mipmaps Whether to also compute and encode the whole mipmap chain
+     */
+    CompressedImage(const ImageData& image, CompressionFormat format, bool mipmaps = true);
+
+    void write(const std::string& path) const;
+
+    /**
+     * @brief Decompresses a level, mostly to measure the quality of the encoding
+     */
+    [[nodiscard]] ImageData decode(unsigned level = 0) const;
+
+    [[nodiscard]] CompressionFormat getFormat() const;
+    [[nodiscard]] int getWidth() const;
+    [[nodiscard]] int getHeight() const;
+    [[nodiscard]] unsigned getLevelCount() const;
+    [[nodiscard]] const Level& getLevel(unsigned level) const;
+
+    /**
+     * @brief Size in bytes of every level
+     */
+    [[nodiscard]] unsigned long long getSize() const;
+
+    [[nodiscard]] static unsigned blockSize(CompressionFormat format);
+
+private:
+    CompressionFormat format;
+    std::vector<Level> levels;
+};
\ No newline at end of file
@@ -0,0 +1,90 @@
+/******************************************************************************************************
+ * @file  FrameBenchmark.hpp
+ * @brief Declaration of the FrameBenchmark class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Records frame times, the CPU time of each stage of a frame and per-frame counters,
+ * then summarizes them with percentiles and writes them as JSON for regression tracking
+ */
+class FrameBenchmark {
+public:
+    struct Summary {
+        double mean;
+        double min;
+        double p50;
+        double p95;
+        double p99;
+        double max;
+    };
+
+    FrameBenchmark();
+
+    void beginFrame();
+
+    /**
+     * @brief Ends a stage of the frame, which lasted from the end of the previous stage or the beginning of the frame
+     */
+    void endStage(std::string_view stage);
+
+    /**
+     * @brief Records the value of a counter for the current frame, like the number of draw calls
+     */
+    void record(std::string_view counter, double value);
+
+    /**
+     * @brief Records the GPU time of a render pass, see GpuTimer
+     */
+    void recordGpu(std::string_view pass, double milliseconds);
+
+    void endFrame();
+
+    /**
+     * @brief Discards every recorded frame but keeps the properties, used to drop the warmup frames
+     */
+    void clear();
+
+    /**
+     * @brief Adds a value to the "properties" object of the JSON, like the renderer or the resolution
+     */
+    void setProperty(const std::string& name, const std::string& value);
+    void setProperty(const std::string& name, double value);
+
+    [[nodiscard]] unsigned getFrameCount() const;
+
+    /**
+     * @brief Summary of the frame times in milliseconds
+     */
+    [[nodiscard]] Summary getFrameTimes() const;
+
+    [[nodiscard]] std::string toJson() const;
+    void write(const std::string& path) const;
+
+    /**
+     * @brief Percentiles use the nearest rank method
+     */
+    [[nodiscard]] static Summary summarize(std::vector<double> values);
+
+private:
+    using Clock = std::chrono::steady_clock;
+    using Series = std::pair<std::string, std::vector<double>>;
+
+    static std::vector<double>& find(std::vector<Series>& series, std::string_view name);
+
+    Clock::time_point frameStart;
+    Clock::time_point stageStart;
+
+    std::vector<double> frameTimes;
+    std::vector<Series> stages;
+    std::vector<Series> counters;
+    std::vector<Series> gpuPasses;
+    std::vector<std::pair<std::string, std::string>> properties;
+};
\ No newline at end of file
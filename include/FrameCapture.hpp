@@ -0,0 +1,96 @@
+/******************************************************************************************************
+ * @file  FrameCapture.hpp
+ * @brief Declaration of the FrameCapture class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <glad/glad.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ImageData.hpp"
+#include "ImageWriter.hpp"
+
+/**
+ * @brief Reads rendered frames back without stalling the GPU.
+ * Frames are copied to a ring of pixel buffer objects and only mapped once their fence is signaled, usually a
+ * few frames later. The images are then handed over to an ImageWriter or to a callback.
+ */
+class FrameCapture {
+public:
+    /**
+     * @param latency Number of pixel buffers in the ring, i.e. how many frames a readback may be in flight
+     */
+    explicit FrameCapture(unsigned latency = 3);
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator =(const FrameCapture&) = delete;
+
+    ~FrameCapture();
+
+    /**
+     * @brief Writes the next frame to path, the format being deduced from its extension
+     */
+    void screenshot(const std::string& path);
+
+    /**
+     * @brief Hands the next frame to a callback, called on the render thread from update
+     */
+    void capture(std::function<void(ImageData)> callback);
+
+    /**
+     * @brief Writes every frame to directory/frame_00000.extension, frame_00001.extension...
+     */
+    void startSequence(const std::string& directory, const std::string& extension = "qoi");
+    void stopSequence();
+    [[nodiscard]] bool isRecording() const;
+
+    /**
+     * @brief Collects the readbacks that are done and starts the ones requested for this frame.
+     * Must be called once per frame after the frame was drawn, with the read framebuffer bound.
+     */
+    void update(int width, int height);
+
+    /**
+     * @brief Waits for every readback in flight and for every image to be written
+     */
+    void flush();
+
+    [[nodiscard]] unsigned getFramesCaptured() const;
+
+    ImageWriter& getWriter();
+
+private:
+    struct Slot {
+        unsigned pbo;
+        GLsync fence;
+        unsigned long long size;
+
+        int width;
+        int height;
+        std::function<void(ImageData)> consumer;
+    };
+
+    void read(int width, int height, std::function<void(ImageData)> consumer);
+    /**
+     * @brief Maps a finished readback and hands it to its consumer
+     * @return Whether the readback was done, it always is when waiting
+     */
+    bool collect(Slot& slot, bool wait);
+
+    std::vector<Slot> slots;
+    unsigned next;
+
+    std::vector<std::function<void(ImageData)>> requests;
+
+    bool recording;
+    std::string sequenceDirectory;
+    std::string sequenceExtension;
+    unsigned sequenceFrame;
+
+    unsigned framesCaptured;
+
+    ImageWriter writer;
+};
\ No newline at end of file
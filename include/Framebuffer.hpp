@@ -0,0 +1,48 @@
+/******************************************************************************************************
+ * @file  Framebuffer.hpp
+ * @brief Declaration of the Framebuffer class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <glad/glad.h>
+
+/**
+ * @brief Offscreen render target with an RGBA8 color attachment and a 24 bit depth attachment
+ */
+class Framebuffer {
+public:
+    Framebuffer(int width, int height);
+
+    Framebuffer(const Framebuffer&) = delete;
+    Framebuffer& operator =(const Framebuffer&) = delete;
+
+    ~Framebuffer();
+
+    /**
+     * @brief Binds the framebuffer for drawing and reading and sets the viewport to its size
+     */
+    void bind() const;
+
+    /**
+     * @brief Binds the default framebuffer back
+     */
+    static void unbind();
+
+    [[nodiscard]] unsigned getId() const;
+    [[nodiscard]] int getWidth() const;
+    [[nodiscard]] int getHeight() const;
+
+    /**
+     * @brief Approximate amount of video memory used by the attachments
+     */
+    [[nodiscard]] unsigned long long getSize() const;
+
+private:
+    unsigned id;
+    unsigned color;
+    unsigned depth;
+
+    int width;
+    int height;
+};
\ No newline at end of file
@@ -0,0 +1,69 @@
+/******************************************************************************************************
+ * @file  FrustumCuller.hpp
+ * @brief Declaration of the FrustumCuller class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "maths/bounds.hpp"
+#include "maths/frustum.hpp"
+
+/**
+ * @brief Tests many world space bounding volumes against a view frustum at once.
+ * Volumes are stored as a structure of arrays so that the sphere and the box of 8 objects with AVX, or 4 with SSE,
+ * are tested against a plane with a handful of instructions, and large sets are split across the thread pool.
+ */
+class FrustumCuller {
+public:
+#if defined(__AVX__)
+    static constexpr unsigned width = 8;
+#elif defined(__SSE2__)
+    static constexpr unsigned width = 4;
+#else
+    static constexpr unsigned width = 1;
+#endif
+
+    FrustumCuller();
+
+    void clear();
+    void reserve(unsigned count);
+
+    /**
+     * @return Index of the volume, volumes are reported in the order they were added
+     */
+    unsigned add(const BoundingSphere& sphere, const AABB& box);
+    void update(unsigned index, const BoundingSphere& sphere, const AABB& box);
+
+    /**
+     * @brief A volume is visible when both its sphere and its box intersect the frustum
+     * @param visibility Receives 1 for each visible volume and 0 for each culled one
+     * @return Number of visible volumes
+     */
+    unsigned cull(const Frustum& frustum, std::vector<std::uint8_t>& visibility) const;
+
+    [[nodiscard]] unsigned getSize() const;
+
+private:
+    /**
+     * @brief Culls the blocks of width volumes from first to last
+     */
+    unsigned cullBlocks(const Frustum& frustum, unsigned first, unsigned last, std::uint8_t* visibility) const;
+
+    // Padded to a multiple of width, the padding is never reported
+    std::vector<float> sphereX;
+    std::vector<float> sphereY;
+    std::vector<float> sphereZ;
+    std::vector<float> sphereRadius;
+
+    std::vector<float> boxX;
+    std::vector<float> boxY;
+    std::vector<float> boxZ;
+    std::vector<float> extentX;
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+
+    unsigned count;
+};
\ No newline at end of file
@@ -0,0 +1,153 @@
+/******************************************************************************************************
+ * @file  GeometryPool.hpp
+ * @brief Declaration of the GeometryPool and IndirectDraws classes
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "InstanceBuffer.hpp"
+#include "maths/constants.hpp"
+#include "Mesh.hpp"
+
+/**
+ * @brief Vertex and index buffers shared by many meshes, which all live in one vertex array as ranges of the buffers.
+ * Ranges are sub-allocated first fit from free lists that merge neighbouring free ranges, and the buffers double
+ * in size when no free range is large enough, so meshes can be added and removed at any time.
+ */
+class GeometryPool {
+public:
+    struct Range {
+        unsigned firstVertex;
+        unsigned vertexCount;
+        unsigned firstIndex;
+        unsigned indexCount;
+    };
+
+    GeometryPool(unsigned vertexCapacity = 1 << 16, unsigned indexCapacity = 1 << 18);
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator =(const GeometryPool&) = delete;
+
+    ~GeometryPool();
+
+    /**
+     * @brief Copies a triangle mesh into the pool, meshes without indices are indexed in order
+     */
+    [[nodiscard]] Range add(Mesh& mesh);
+    void remove(const Range& range);
+
+    /**
+     * @brief Binds the vertex array and the index buffer, making sure instances up to count have a draw index
+     */
+    void bind(unsigned count);
+
+    [[nodiscard]] unsigned getVertexCapacity() const;
+    [[nodiscard]] unsigned getIndexCapacity() const;
+
+private:
+    struct Vertex {
+        Point position;
+        Vector normal;
+        Color color;
+        TexCoord texcoord;
+    };
+
+    /**
+     * @brief First fit allocator of ranges of elements, free ranges are indexed by their first element
+     */
+    class Allocator {
+    public:
+        explicit Allocator(unsigned capacity);
+
+        /**
+         * @return Whether a free range was large enough
+         */
+        bool allocate(unsigned count, unsigned& first);
+        void release(unsigned first, unsigned count);
+
+        /**
+         * @brief Adds the elements from the current capacity to the new one to the free ranges
+         */
+        void grow(unsigned capacity);
+
+        [[nodiscard]] unsigned getCapacity() const;
+
+    private:
+        std::map<unsigned, unsigned> ranges;
+        unsigned capacity;
+    };
+
+    /**
+     * @brief Replaces buffer by one of newSize bytes holding its first oldSize bytes
+     */
+    static void resize(unsigned& buffer, unsigned long long oldSize, unsigned long long newSize);
+
+    void setAttributes();
+
+    Allocator vertices;
+    Allocator indices;
+
+    unsigned VAO;
+    unsigned VBO;
+    unsigned EBO;
+
+    // Draw indices 0, 1, 2... read as an instanced attribute, see IndirectDraws
+    unsigned drawIndexVBO;
+    unsigned drawIndexCount;
+};
+
+/**
+ * @brief Draws of pool ranges issued with a single glMultiDrawElementsIndirect, each with its own model matrix and
+ * color stored in a shader storage buffer bound at binding 0.
+ * The index of a draw is its base instance, which shaders read through the draw index attribute at location 4 so
+ * that neither gl_DrawID nor gl_BaseInstance, both missing from OpenGL 4.5, are needed.
+ */
+class IndirectDraws {
+public:
+    explicit IndirectDraws(GeometryPool& pool);
+
+    IndirectDraws(const IndirectDraws&) = delete;
+    IndirectDraws& operator =(const IndirectDraws&) = delete;
+
+    ~IndirectDraws();
+
+    void clear();
+    void add(const GeometryPool::Range& range, const Matrix4& model, const Color& color = White());
+
+    /**
+     * @brief Uploads the draws added since the last upload, to be called before drawing
+     */
+    void upload();
+    void draw() const;
+
+    [[nodiscard]] unsigned getCount() const;
+
+    /**
+     * @brief Whether the context supports multi-draw indirect and shader storage buffers
+     */
+    [[nodiscard]] static bool isSupported();
+
+private:
+    struct Command {
+        unsigned count;
+        unsigned instanceCount;
+        unsigned firstIndex;
+        int baseVertex;
+        unsigned baseInstance;
+    };
+
+    GeometryPool& pool;
+
+    std::vector<Command> commands;
+    std::vector<Instance> draws;
+    unsigned long long triangles;
+    unsigned long long uploadedTriangles;
+
+    unsigned commandBuffer;
+    unsigned drawBuffer;
+    unsigned long long uploadedSize; // Bytes of both buffers
+    unsigned uploadedCount;
+};
\ No newline at end of file
@@ -0,0 +1,78 @@
+/******************************************************************************************************
+ * @file  GpuTimer.hpp
+ * @brief Declaration of the GpuTimer class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+/**
+ * @brief Measures the GPU time of each render pass with GL_TIME_ELAPSED queries.
+ * Queries of the last few frames stay in flight and are only read once the GPU has made them available, so timing
+ * never stalls the pipeline and results lag a few frames behind.
+ */
+class GpuTimer {
+public:
+    struct Result {
+        const char* name;
+        double milliseconds;
+    };
+
+    /**
+     * @brief Number of frames whose queries can be in flight at the same time
+     */
+    static constexpr unsigned latency = 4;
+
+    GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator =(const GpuTimer&) = delete;
+
+    ~GpuTimer();
+
+    /**
+     * @brief Reads the frames whose queries are available and starts a new frame
+     */
+    void beginFrame();
+
+    /**
+     * @brief Starts timing a pass, passes cannot be nested and name must be a string literal
+     */
+    void begin(const char* name);
+    void end();
+
+    /**
+     * @brief Pass timings of the most recent frame the GPU has finished
+     */
+    [[nodiscard]] const std::vector<Result>& getResults() const;
+
+    /**
+     * @brief Index of the frame of the results, 0 while no frame has been read
+     */
+    [[nodiscard]] unsigned long long getResultsFrame() const;
+
+    [[nodiscard]] double getTotal() const;
+
+private:
+    struct Query {
+        const char* name;
+        unsigned id;
+    };
+
+    struct Frame {
+        std::vector<Query> queries;
+        unsigned used;
+        unsigned long long number;
+    };
+
+    void poll();
+
+    Frame frames[latency];
+    unsigned current;
+    unsigned long long frameNumber;
+    bool active;
+
+    std::vector<Result> results;
+    unsigned long long resultsFrame;
+};
\ No newline at end of file
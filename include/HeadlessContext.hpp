@@ -0,0 +1,42 @@
+/******************************************************************************************************
+ * @file  HeadlessContext.hpp
+ * @brief Declaration of the HeadlessContext class
+ ******************************************************************************************************/
+
+#pragma once
+
+/**
+ * @brief OpenGL context without any window or surface, created through EGL.
+ * Rendering has to go to a Framebuffer. On machines without a GPU, Mesa provides the context with its
+ * software rasterizer, which is what lets the engine render in CI. Only available when the engine is
+ * built with EGL, see isAvailable.
+ */
+class HeadlessContext {
+public:
+    /**
+     * @brief Creates the context and makes it current, tries OpenGL 4.6, then 4.5 and 3.3 core
+     */
+    HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator =(const HeadlessContext&) = delete;
+
+    ~HeadlessContext();
+
+    [[nodiscard]] int getMajorVersion() const;
+    [[nodiscard]] int getMinorVersion() const;
+
+    /**
+     * @brief Function loader to give to GLAD
+     */
+    static void* getProcAddress(const char* name);
+
+    [[nodiscard]] static bool isAvailable();
+
+private:
+    void* display;
+    void* context;
+
+    int majorVersion;
+    int minorVersion;
+};
\ No newline at end of file
@@ -5,33 +5,84 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
+#include "ImageView.hpp"
+#include "maths/vec2.hpp"
 #include "maths/vec4.hpp"
 
+/**
+ * @brief Image whose pixels are shared between copies.
+ * Copying an ImageData only copies a reference to its pixels, they are duplicated the first time a copy asks
+ * for mutable access with getData, so images can go from the loader to the cache and the uploader for free.
+ * Once an image handed out a mutable pointer, its copies get their own pixels, so writing through that pointer
+ * never changes another image.
+ */
 class ImageData {
 public:
     ImageData(const std::string& path);
+
+    /**
+     * @brief Creates a black image
+     */
+    ImageData(int width, int height, int colorChannels);
+
+    /**
+     * @brief Copies the pixels of a view into a new tightly packed image
+     */
+    explicit ImageData(const ImageView& view);
+
     ImageData(const ImageData& im);
+    ImageData(ImageData&& im) noexcept;
     ImageData& operator =(const ImageData& im);
+    ImageData& operator =(ImageData&& im) noexcept;
 
-    ~ImageData();
+    ~ImageData() = default;
 
     [[nodiscard]] Color operator ()(int i, int j) const;
 
+    /**
+     * @brief Bilinear sample at texture coordinates, wrapping around the edges like a repeated texture
+     */
+    [[nodiscard]] Color sample(const TexCoord& texcoord) const;
+
     void write(const std::string& path) const;
 
+    [[nodiscard]] ImageView view() const;
+
+    /**
+     * @brief Deep copy that does not share its pixels with this image
+     */
+    [[nodiscard]] ImageData clone() const;
+
     [[nodiscard]] int getWidth() const;
     [[nodiscard]] int getHeight() const;
     [[nodiscard]] int getColorChannels() const;
+    [[nodiscard]] unsigned long long getSize() const;
     [[nodiscard]] const unsigned char* getData() const;
 
+    /**
+     * @brief Mutable access to the pixels, which are copied first if another image shares them. The pointer stays
+     * valid until the image gets other pixels or is destroyed, and copies made after the call never share it
+     */
+    [[nodiscard]] unsigned char* getData();
+
+    /**
+     * @brief Number of pixel bytes copied by every ImageData since the start of the program
+     */
+    [[nodiscard]] static unsigned long long getBytesCopied();
+
 private:
     int width;
     int height;
     int colorChannels;
 
-    unsigned char* data;
+    std::shared_ptr<unsigned char[]> data;
+    bool writable; // A mutable pointer to the pixels was handed out
+};
 
-    bool isHeapAllocated;
-};
\ No newline at end of file
+/**
+ * @brief Peak signal-to-noise ratio between two images of the same size, in decibels
+ */
+float psnr(const ImageData& reference, const ImageData& image);
\ No newline at end of file
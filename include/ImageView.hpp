@@ -0,0 +1,50 @@
+/******************************************************************************************************
+ * @file  ImageView.hpp
+ * @brief Declaration of the ImageView class
+ ******************************************************************************************************/
+
+#pragma once
+
+/**
+ * @brief Non-owning view on the pixels of an image or of a rectangle inside of it.
+ * Rows are stride bytes apart, which lets a view describe a sub-rectangle without copying anything.
+ */
+class ImageView {
+public:
+    ImageView();
+
+    /**
+     * @param stride Number of bytes between the start of two rows, 0 for tightly packed rows
+     */
+    ImageView(const unsigned char* data, int width, int height, int colorChannels, int stride = 0);
+
+    /**
+     * @brief View on the rectangle of size width * height starting at pixel (x, y)
+     */
+    [[nodiscard]] ImageView subView(int x, int y, int width, int height) const;
+
+    /**
+     * @brief Pointer to the first channel of pixel (i, j)
+     */
+    [[nodiscard]] const unsigned char* operator ()(int i, int j) const;
+    [[nodiscard]] const unsigned char* row(int j) const;
+
+    [[nodiscard]] int getWidth() const;
+    [[nodiscard]] int getHeight() const;
+    [[nodiscard]] int getColorChannels() const;
+    [[nodiscard]] int getStride() const;
+    [[nodiscard]] const unsigned char* getData() const;
+
+    /**
+     * @brief Whether the rows follow each other without any gap, i.e. the view can be read in one go
+     */
+    [[nodiscard]] bool isContiguous() const;
+
+private:
+    const unsigned char* data;
+
+    int width;
+    int height;
+    int colorChannels;
+    int stride;
+};
\ No newline at end of file
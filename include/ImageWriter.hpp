@@ -0,0 +1,76 @@
+/******************************************************************************************************
+ * @file  ImageWriter.hpp
+ * @brief Declaration of the ImageWriter class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ImageData.hpp"
+#include "ThreadPool.hpp"
+
+enum class ImageFormat {
+    png,
+    jpg,
+    bmp,
+    tga,
+    qoi, // Quite OK Image format, lossless and much faster than PNG
+    pam  // Uncompressed netpbm image, the fastest to write
+};
+
+/**
+ * @brief Encodes and writes images on background threads.
+ * PNG images are deflated in chunks of rows in parallel, the chunks being joined with sync flushes.
+ * Images are written top row first, whereas an ImageData stores its bottom row first like OpenGL does.
+ */
+class ImageWriter {
+public:
+    explicit ImageWriter(unsigned threadCount = 2);
+
+    ImageWriter(const ImageWriter&) = delete;
+    ImageWriter& operator =(const ImageWriter&) = delete;
+
+    /**
+     * @brief Waits for every pending image to be written
+     */
+    ~ImageWriter();
+
+    /**
+     * @brief Queues an image to be written, the format being deduced from the extension of the path.
+     * The pixels are shared with the caller rather than copied, see ImageData.
+     * @return A future that becomes ready once the file is written, holding the exception if it could not be
+     */
+    std::future<void> write(const ImageData& image, const std::string& path);
+    std::future<void> write(const ImageData& image, const std::string& path, ImageFormat format);
+
+    /**
+     * @brief Waits for every pending image to be written
+     */
+    void wait();
+
+    [[nodiscard]] unsigned getPendingCount() const;
+
+    void setJpgQuality(int quality);
+
+    [[nodiscard]] static ImageFormat formatFromPath(const std::string& path);
+
+    /**
+     * @brief Encodes an image in memory on the calling thread
+     */
+    [[nodiscard]] static std::vector<unsigned char> encode(const ImageData& image, ImageFormat format, int jpgQuality = 90);
+
+private:
+    ThreadPool pool;
+
+    std::atomic<unsigned> pending;
+    std::atomic<int> jpgQuality;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+};
\ No newline at end of file
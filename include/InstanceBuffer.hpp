@@ -0,0 +1,46 @@
+/******************************************************************************************************
+ * @file  InstanceBuffer.hpp
+ * @brief Declaration of the InstanceBuffer class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include "maths/Matrix4.hpp"
+#include "maths/vec4.hpp"
+
+/**
+ * @brief Attributes of one instance of an instanced draw, read at locations 4 to 7 for the model matrix and at
+ * location 8 for the color, which multiplies the color of the vertices
+ */
+struct Instance {
+    Matrix4 model;
+    Color color;
+};
+
+static_assert(sizeof(Instance) == 20 * sizeof(float), "Instances are uploaded as they are laid out in memory");
+
+/**
+ * @brief Vertex buffer holding the instances drawn by Mesh::drawInstanced.
+ * It only grows, uploads that fit orphan the current storage instead of waiting for draws still using it.
+ */
+class InstanceBuffer {
+public:
+    InstanceBuffer();
+
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator =(const InstanceBuffer&) = delete;
+
+    ~InstanceBuffer();
+
+    void update(const std::vector<Instance>& instances);
+
+    [[nodiscard]] unsigned getId() const;
+    [[nodiscard]] unsigned getCount() const;
+
+private:
+    unsigned id;
+    unsigned count;
+    unsigned long long capacity; // Bytes
+};
\ No newline at end of file
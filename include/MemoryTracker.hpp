@@ -0,0 +1,110 @@
+/******************************************************************************************************
+ * @file  MemoryTracker.hpp
+ * @brief Declaration of the MemoryTracker class and of the TrackingAllocator
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+
+/**
+ * @brief Subsystems memory is accounted to
+ */
+enum class MemoryTag : unsigned {
+    meshes,
+    images,
+    textures,
+    shaders,
+    ui,
+    capture,
+    count
+};
+
+enum class MemoryDomain : unsigned {
+    cpu,
+    gpu
+};
+
+/**
+ * @brief Current and peak memory usage of every subsystem, in main memory and in video memory.
+ * Counters are atomic so that images decoded by worker threads are accounted too. Budgets never fail an allocation,
+ * going over one makes enforceBudgets call the eviction callback of the subsystem on the next frame.
+ */
+class MemoryTracker {
+public:
+    struct Usage {
+        unsigned long long current;
+        unsigned long long peak;
+        unsigned long long budget;  // 0 when there is no budget
+    };
+
+    /**
+     * @brief Called with the number of bytes to free to get back under the budget
+     */
+    using EvictionCallback = std::function<void(unsigned long long bytes)>;
+
+    static void track(MemoryTag tag, unsigned long long bytes, MemoryDomain domain = MemoryDomain::cpu);
+    static void untrack(MemoryTag tag, unsigned long long bytes, MemoryDomain domain = MemoryDomain::cpu);
+
+    /**
+     * @brief malloc, realloc and free that remember the size and the tag of each block in a small header,
+     * for C allocators like the ones of stb and ImGui
+     */
+    [[nodiscard]] static void* allocate(MemoryTag tag, std::size_t bytes);
+    [[nodiscard]] static void* reallocate(MemoryTag tag, void* pointer, std::size_t bytes);
+    static void release(void* pointer);
+
+    [[nodiscard]] static Usage getUsage(MemoryTag tag, MemoryDomain domain = MemoryDomain::cpu);
+
+    /**
+     * @brief Total usage of every tag of a domain
+     */
+    [[nodiscard]] static unsigned long long getTotal(MemoryDomain domain = MemoryDomain::cpu);
+
+    static void setBudget(MemoryTag tag, unsigned long long bytes, MemoryDomain domain = MemoryDomain::cpu);
+    static void setEvictionCallback(MemoryTag tag, EvictionCallback callback, MemoryDomain domain = MemoryDomain::cpu);
+
+    /**
+     * @brief Calls the eviction callbacks of the budgets that are exceeded, on the rendering thread
+     * since evicting can free OpenGL objects
+     */
+    static void enforceBudgets();
+
+    [[nodiscard]] static const char* getName(MemoryTag tag);
+};
+
+/**
+ * @brief Standard allocator accounting its memory to a tag, see MemoryTracker
+ */
+template<typename T, MemoryTag tag>
+class TrackingAllocator {
+public:
+    using value_type = T;
+
+    template<typename U>
+    struct rebind {
+        using other = TrackingAllocator<U, tag>;
+    };
+
+    TrackingAllocator() noexcept = default;
+
+    template<typename U>
+    TrackingAllocator(const TrackingAllocator<U, tag>&) noexcept { }
+
+    [[nodiscard]] T* allocate(std::size_t count) {
+        T* pointer = static_cast<T*>(::operator new(count * sizeof(T)));
+        MemoryTracker::track(tag, count * sizeof(T));
+
+        return pointer;
+    }
+
+    void deallocate(T* pointer, std::size_t count) noexcept {
+        MemoryTracker::untrack(tag, count * sizeof(T));
+        ::operator delete(pointer);
+    }
+
+    template<typename U>
+    bool operator ==(const TrackingAllocator<U, tag>&) const noexcept { return true; }
+};
\ No newline at end of file
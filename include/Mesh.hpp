@@ -8,9 +8,19 @@
 #include <glad/glad.h>
 #include <vector>
 
+#include "InstanceBuffer.hpp"
+#include "maths/bounds.hpp"
 #include "maths/vec2.hpp"
 #include "maths/vec3.hpp"
 #include "maths/vec4.hpp"
+#include "MemoryTracker.hpp"
+#include "MeshBVH.hpp"
+
+/**
+ * @brief Vertex data of meshes, accounted to MemoryTag::meshes
+ */
+template<typename T>
+using MeshArray = std::vector<T, TrackingAllocator<T, MemoryTag::meshes>>;
 
 class Mesh {
 public:
@@ -48,13 +58,43 @@ public:
     void updateTexcoord(unsigned index, float x, float y);
     void updateTexcoord(unsigned index, const TexCoord& texcoord);
 
+    /**
+     * @brief Draws the mesh, its OpenGL objects are only created on the first draw so meshes can be built
+     * without any context
+     */
     void draw();
 
-    const std::vector<Point>* getPositions();
-    const std::vector<Vector>* getNormals();
-    const std::vector<Color>* getColors();
-    const std::vector<TexCoord>* getTexcoords();
-    const std::vector<unsigned>* getIndices();
+    /**
+     * @brief Draws every instance of the buffer in a single draw call, for shaders reading the instance attributes
+     */
+    void drawInstanced(const InstanceBuffer& instances);
+
+    /**
+     * @brief Computes smooth normals from faces made of two triangles, 0-1-2 and 0-2-3, replacing the current ones.
+     * Indexed triangle meshes without normals get them computed on their first draw
+     */
+    void computeNormals();
+
+    [[nodiscard]] unsigned getPrimitive() const;
+
+    /**
+     * @brief Bounds in model space. The box grows with every added position and follows updated ones, it is only
+     * computed again when a position on its boundary moves, and the sphere is computed again after any change
+     */
+    const AABB& getAABB();
+    const BoundingSphere& getBoundingSphere();
+
+    /**
+     * @brief Hierarchy over the triangles in model space, built on first use and again after any position or index
+     * changed. It is empty for meshes not made of triangles
+     */
+    const MeshBVH& getBVH();
+
+    const MeshArray<Point>* getPositions();
+    const MeshArray<Vector>* getNormals();
+    const MeshArray<Color>* getColors();
+    const MeshArray<TexCoord>* getTexcoords();
+    const MeshArray<unsigned>* getIndices();
 
 private:
     [[nodiscard]] unsigned long long positionsSize() const;
@@ -63,17 +103,35 @@ private:
     [[nodiscard]] unsigned long long texcoordsSize() const;
     [[nodiscard]] unsigned long long indicesSize() const;
 
+    /**
+     * @brief Creates the OpenGL objects and uploads the vertices if needed, then binds the vertex array
+     */
+    void prepare();
     void bindBuffers();
 
+    /**
+     * @brief Keeps the bounds up to date when a position moves
+     */
+    void moveBounds(const Point& from, const Point& to);
+
     bool buffersUpdate;
+    bool boxUpdate;
+    bool sphereUpdate;
+    bool bvhUpdate;
 
     unsigned primitive;
 
-    std::vector<Point> positions;
-    std::vector<Vector> normals;
-    std::vector<Color> colors;
-    std::vector<TexCoord> texcoords;
-    std::vector<unsigned> indices;
+    MeshArray<Point> positions;
+    MeshArray<Vector> normals;
+    MeshArray<Color> colors;
+    MeshArray<TexCoord> texcoords;
+    MeshArray<unsigned> indices;
+
+    AABB boundingBox;
+    BoundingSphere boundingSphere;
+    MeshBVH bvh;
+
+    unsigned long long gpuSize; // Bytes uploaded to the buffers
 
     unsigned VAO;
     unsigned EBO;
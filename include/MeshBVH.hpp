@@ -0,0 +1,97 @@
+/******************************************************************************************************
+ * @file  MeshBVH.hpp
+ * @brief Declaration of the MeshBVH class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "BVH.hpp"
+#include "maths/ray.hpp"
+#include "maths/vec3.hpp"
+
+/**
+ * @brief Bounding volume hierarchy over the triangles of a mesh, in model space, for ray casts.
+ * With SSE, the binary hierarchy is collapsed into nodes of 4 children whose boxes are tested against a ray at once.
+ */
+class MeshBVH {
+public:
+    struct Hit {
+        unsigned triangle;  // Index of the triangle, its vertices being indices 3 * triangle to 3 * triangle + 2
+        float u;            // Barycentric coordinates of the hit point relative to the second and third vertices
+        float v;
+        float distance;
+    };
+
+    MeshBVH();
+
+    /**
+     * @param indices Three per triangle, consecutive positions make the triangles when it is null
+     */
+    void build(const Point* positions, const unsigned* indices, std::size_t triangleCount);
+
+    /**
+     * @brief Closest triangle hit by the ray, either face counts
+     */
+    [[nodiscard]] std::optional<Hit> raycast(const Ray& ray,
+                                             float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+    /**
+     * @brief Closest triangles hit by coherent rays, which walk the binary nodes together
+     * @param hits Replaced for the rays hitting a triangle before their closest distance
+     * @param closest Distance up to which each ray looks for hits, negative for the rays to ignore, lowered by hits
+     */
+    void raycast(const RayPacket& rays, std::array<std::optional<Hit>, RayPacket::size>& hits,
+                 std::array<float, RayPacket::size>& closest) const;
+
+    [[nodiscard]] unsigned getTriangleCount() const;
+    [[nodiscard]] unsigned getNodeCount() const;
+    [[nodiscard]] const std::vector<BVHNode>& getNodes() const;
+
+private:
+    /**
+     * @brief Stored in the order of the leaves with its edges, as the intersection test needs them
+     */
+    struct Triangle {
+        Point vertex;
+        Vector edge1;
+        Vector edge2;
+    };
+
+    /**
+     * @brief Tests the triangles of a leaf, updating the hit when one of them is closer
+     */
+    void intersectLeaf(const Ray& ray, unsigned first, unsigned count, std::optional<Hit>& hit, float& closest) const;
+    void intersectLeaf(const RayPacket& rays, unsigned first, unsigned count,
+                       std::array<std::optional<Hit>, RayPacket::size>& hits, std::array<float, RayPacket::size>& closest) const;
+
+    std::vector<BVHNode> nodes;
+    std::vector<Triangle> triangles;
+    std::vector<unsigned> ids; // Index of each triangle in the mesh
+
+#ifdef __SSE2__
+    /**
+     * @brief 4 children stored as a structure of arrays, 128 bytes
+     */
+    struct alignas(16) WideNode {
+        float minX[4], minY[4], minZ[4];
+        float maxX[4], maxY[4], maxZ[4];
+        unsigned first[4]; // Wide node of inner children, first triangle of leaves, unused for missing children
+        unsigned count[4]; // Triangles of leaves, 0 for inner children
+    };
+
+    static constexpr unsigned unused = std::numeric_limits<unsigned>::max();
+
+    /**
+     * @brief Builds the wide nodes by replacing the largest inner child of each node by its children until it has 4
+     */
+    void collapse();
+
+    std::vector<WideNode> wideNodes;
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,37 @@
+/******************************************************************************************************
+ * @file  MipChain.hpp
+ * @brief Declaration of the mipmap chain builder
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include "ImageData.hpp"
+
+enum class MipFilter {
+    box,   // Average of the texels covered by the destination texel
+    kaiser // Kaiser windowed sinc, sharper but a bit slower
+};
+
+struct MipSettings {
+    MipFilter filter = MipFilter::box;
+
+    /**
+     * @brief Whether the color channels are sRGB encoded, in which case they are filtered in linear space
+     */
+    bool sRGB = true;
+
+    /**
+     * @brief Rescales the alpha of each level so that the same proportion of texels pass the alpha test at
+     * alphaReference, which keeps foliage and fences from fading out in the distance
+     */
+    bool preserveAlphaCoverage = false;
+    float alphaReference = 0.5f;
+};
+
+/**
+ * @brief Builds every mipmap level of an image down to 1x1, the first level being a copy of the image.
+ * Odd sizes are handled by filtering with fractional footprints rather than dropping a row or column.
+ */
+std::vector<ImageData> buildMipChain(const ImageData& image, const MipSettings& settings = MipSettings{});
\ No newline at end of file
@@ -0,0 +1,99 @@
+/******************************************************************************************************
+ * @file  OcclusionCuller.hpp
+ * @brief Declaration of the OcclusionCuller class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <future>
+#include <vector>
+
+#include "maths/bounds.hpp"
+#include "maths/Matrix4.hpp"
+#include "Mesh.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @brief Finds the objects hidden behind a few large occluders before they are drawn.
+ * The occluders are rasterized into a small depth buffer, four pixels at a time with SSE, on a thread of the pool while
+ * the caller goes on preparing the frame. A pyramid then keeps the farthest depth of every 2x2 texels of the level
+ * below, so that a box covering many pixels is tested against a handful of texels of a coarser level.
+ * The test is conservative : boxes crossing the near plane and pixels next to the edges of the occluders are visible.
+ */
+class OcclusionCuller {
+public:
+    explicit OcclusionCuller(int width = 256, int height = 128);
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator =(const OcclusionCuller&) = delete;
+
+    ~OcclusionCuller();
+
+    /**
+     * @brief Starts a frame seen through the matrix, forgetting the occluders of the previous one
+     */
+    void begin(const Matrix4& viewProjection);
+
+    /**
+     * @brief Only the front faces of triangle meshes hide anything, the mesh must not change until wait returns
+     */
+    void addOccluder(Mesh& mesh, const Matrix4& model);
+
+    /**
+     * @brief Rasterizes the occluders and builds the pyramid on a thread of the pool, see wait
+     */
+    void render(ThreadPool& pool = ThreadPool::global());
+
+    /**
+     * @brief Waits for the last render, it must be called before testing boxes
+     */
+    void wait();
+
+    /**
+     * @brief Whether the world space box is entirely behind the occluders, it is never occluded without any
+     */
+    [[nodiscard]] bool isOccluded(const AABB& box) const;
+
+    [[nodiscard]] int getWidth() const;
+    [[nodiscard]] int getHeight() const;
+
+    /**
+     * @brief Triangles of the occluders rasterized by the last render, after discarding the ones off screen
+     */
+    [[nodiscard]] unsigned getTriangleCount() const;
+
+private:
+    struct Occluder {
+        Mesh* mesh;
+        Matrix4 model;
+    };
+
+    /**
+     * @brief Farthest depths in [0, 1], the first level being the depth buffer and the last one a single texel
+     */
+    struct Level {
+        int width;
+        int height;
+        std::vector<float> depths;
+    };
+
+    void rasterize();
+
+    /**
+     * @brief Keeps the nearest depth of the triangle at the center of the pixels it covers
+     * @param vertices Pixel coordinates and depth of each vertex
+     */
+    void rasterizeTriangle(const vec3 (&vertices)[3]);
+
+    void buildPyramid();
+
+    int width;      // Rounded up to a multiple of 4 pixels
+    int height;
+
+    Matrix4 viewProjection;
+    std::vector<Occluder> occluders;
+    std::vector<Level> levels;
+    unsigned triangles;
+
+    std::future<void> rendering;
+};
\ No newline at end of file
@@ -0,0 +1,187 @@
+/******************************************************************************************************
+ * @file  PathTracer.hpp
+ * @brief Declaration of the PathTracer class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <optional>
+#include <vector>
+
+#include "BVH.hpp"
+#include "ImageData.hpp"
+#include "Light.hpp"
+#include "MemoryTracker.hpp"
+#include "Mesh.hpp"
+#include "MeshBVH.hpp"
+#include "ThreadPool.hpp"
+#include "maths/Matrix4.hpp"
+#include "maths/ray.hpp"
+
+/**
+ * @brief Reference renderer tracing the scene on the CPU, without any OpenGL context.
+ * Surfaces are lit like in the default shader, with shadows, and diffuse bounces add the light they reflect on each
+ * other. Every call to render adds one sample per pixel to the image, so it converges over successive calls.
+ * Tiles of the image are spread across the threads of the pool, and the rays of 2x2 pixels are traced together.
+ */
+class PathTracer {
+public:
+    /**
+     * @brief Same values as the material of the default shader
+     */
+    struct Material {
+        Color ambient;
+        Color diffuse;
+        Color specular;
+        float shininess;
+    };
+
+    /**
+     * @brief Mesh drawn with a model matrix, only meshes made of triangles are traced
+     */
+    struct Instance {
+        Mesh* mesh;
+        Matrix4 model;
+        const ImageData* texture = nullptr; // Multiplies the lit color, like in the default shader
+        bool emissive = false;              // Has the diffuse color of the light and casts no shadow, like the light
+    };
+
+    /**
+     * @param bounces Number of diffuse bounces after the first hit, 0 only lights surfaces directly
+     */
+    PathTracer(int width, int height, unsigned bounces = 1, ThreadPool& pool = ThreadPool::global());
+
+    PathTracer(const PathTracer&) = delete;
+    PathTracer& operator =(const PathTracer&) = delete;
+
+    /**
+     * @brief Builds the hierarchy over the instances, computing the missing normals and hierarchies of their meshes.
+     * The meshes must not change until the next call. Clears the image, like every other setter
+     */
+    void setScene(const std::vector<Instance>& instances);
+    void setCamera(const Matrix4& view, const Matrix4& projection);
+    void setLighting(const Light& light, const Material& material, const Color& background);
+
+    /**
+     * @brief Forgets every sample traced so far
+     */
+    void clear();
+
+    /**
+     * @brief Traces one more sample for every pixel and adds it to the image
+     */
+    void render();
+
+    /**
+     * @brief Average of the samples traced so far, clamped to [0, 1], rows bottom first like in every ImageData
+     */
+    [[nodiscard]] ImageData getImage() const;
+
+    [[nodiscard]] int getWidth() const;
+    [[nodiscard]] int getHeight() const;
+    [[nodiscard]] unsigned getSampleCount() const;
+
+    /**
+     * @brief Number of rays traced since the image was last cleared, shadow rays included
+     */
+    [[nodiscard]] unsigned long long getRayCount() const;
+
+private:
+    static constexpr int tileSize = 16;
+
+    /**
+     * @brief Instance with the vertex attributes needed to shade its hits
+     */
+    struct Object {
+        const MeshBVH* bvh;
+        const Point* positions;
+        const Vector* normals;          // Null when the mesh has none, the faces are flat then
+        const TexCoord* texcoords;      // Null when the mesh has none or the object is not textured
+        const unsigned* indices;        // Null when the triangles are made of consecutive vertices
+        const ImageData* texture;
+
+        Matrix4 toModel;                // Inverse of the model matrix
+        Matrix4 normalMatrix;           // Transposed inverse of the model matrix
+        bool emissive;
+    };
+
+    /**
+     * @brief Closest hit of each ray of a packet
+     */
+    struct PacketHits {
+        std::array<std::optional<MeshBVH::Hit>, RayPacket::size> triangles;
+        std::array<unsigned, RayPacket::size> objects;
+        std::array<float, RayPacket::size> closest;
+    };
+
+    /**
+     * @brief Shading inputs at a hit point, in world space
+     */
+    struct Surface {
+        Point position;
+        Vector normal;  // Facing the incoming ray
+        Color albedo;   // Color of the texture, white when there is none
+        bool emissive;
+    };
+
+    /**
+     * @brief Random numbers seeded from the pixel and the sample, so images do not depend on how tiles are scheduled
+     */
+    class Random {
+    public:
+        Random(unsigned pixel, unsigned sample);
+
+        /**
+         * @return Number in [0, 1[
+         */
+        float next();
+
+    private:
+        unsigned state;
+    };
+
+    void renderTile(unsigned tile, unsigned long long& rays);
+
+    /**
+     * @brief Closest hits of the rays in world space, emissive objects being skipped for shadow rays
+     * @param anyHit Whether any hit will do, which stops the rays at the first hit they find
+     */
+    void intersect(const RayPacket& rays, PacketHits& hits, bool anyHit) const;
+    [[nodiscard]] std::optional<std::pair<unsigned, MeshBVH::Hit>> intersect(const Ray& ray, float maxDistance, bool anyHit) const;
+
+    [[nodiscard]] Surface getSurface(const Ray& ray, unsigned object, const MeshBVH::Hit& hit) const;
+
+    /**
+     * @brief Color of the surface lit by the light like in the default shader
+     */
+    [[nodiscard]] Color shade(const Ray& ray, const Surface& surface, bool shadowed) const;
+
+    /**
+     * @brief Light coming back along a ray leaving a surface, bounce being the number of bounces already made
+     */
+    [[nodiscard]] Color trace(const Ray& ray, unsigned bounce, Random& random, unsigned long long& rays) const;
+
+    /**
+     * @brief Direction around the normal whose probability is proportional to its cosine with it
+     */
+    [[nodiscard]] static Vector sampleHemisphere(const Vector& normal, Random& random);
+
+    int width;
+    int height;
+    unsigned bounces;
+    ThreadPool& pool;
+
+    std::vector<Object> objects;
+    BVH bvh; // Over the world space boxes of the objects
+
+    Matrix4 inverseViewProjection;
+    Light light;
+    Material material;
+    Color background;
+
+    std::vector<Color, TrackingAllocator<Color, MemoryTag::images>> accumulation; // Sum of the samples of each pixel
+    unsigned sampleCount;
+    std::atomic<unsigned long long> rayCount;
+};
\ No newline at end of file
@@ -0,0 +1,64 @@
+/******************************************************************************************************
+ * @file  PixelFormat.hpp
+ * @brief Conversions between pixel formats, over single values, spans of values and whole images
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "ImageData.hpp"
+
+/* Single values */
+float sRGBToLinear(unsigned char value);
+unsigned char linearToSRGB(float value);
+
+unsigned short floatToHalf(float value);
+float halfToFloat(unsigned short value);
+
+/* Spans of values, count is the number of values */
+void sRGBToLinear(const unsigned char* source, float* destination, std::size_t count);
+void linearToSRGB(const float* source, unsigned char* destination, std::size_t count);
+
+void bytesToFloats(const unsigned char* source, float* destination, std::size_t count);
+void floatsToBytes(const float* source, unsigned char* destination, std::size_t count);
+
+void floatsToHalves(const float* source, unsigned short* destination, std::size_t count);
+void halvesToFloats(const unsigned short* source, float* destination, std::size_t count);
+
+/* Spans of pixels, count is the number of pixels */
+void rgbToRGBA(const unsigned char* source, unsigned char* destination, std::size_t count, unsigned char alpha = 255);
+void rgbaToRGB(const unsigned char* source, unsigned char* destination, std::size_t count);
+
+/**
+ * @brief Reorders the channels of each pixel, destination channel c is source channel order[c]
+ */
+void swizzle(const unsigned char* source, unsigned char* destination, std::size_t count, int channels,
+             const std::array<int, 4>& order);
+
+void premultiplyAlpha(const unsigned char* source, unsigned char* destination, std::size_t count);
+void unpremultiplyAlpha(const unsigned char* source, unsigned char* destination, std::size_t count);
+
+/* Whole images, split across the thread pool when they are large enough */
+
+/**
+ * @brief Converts an image to 1 (gray), 2 (gray and alpha), 3 (RGB) or 4 (RGBA) channels
+ */
+ImageData convertChannels(const ImageData& image, int colorChannels);
+
+/**
+ * @brief Converts an image to floats keeping its channels, optionally decoding sRGB color channels to linear
+ */
+std::vector<float> toFloats(const ImageData& image, bool sRGB);
+
+/**
+ * @brief Converts floats in [0, 1] to an image, optionally encoding the color channels to sRGB
+ */
+ImageData fromFloats(const float* texels, int width, int height, int colorChannels, bool sRGB);
+
+std::vector<unsigned short> toHalves(const std::vector<float>& values);
+
+ImageData swizzle(const ImageData& image, const std::array<int, 4>& order);
+ImageData premultiplyAlpha(const ImageData& image);
\ No newline at end of file
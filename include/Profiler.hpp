@@ -0,0 +1,101 @@
+/******************************************************************************************************
+ * @file  Profiler.hpp
+ * @brief Declaration of the Profiler class and of the profiling macros
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#ifndef GRAPHICS_ENGINE_NO_PROFILING
+/**
+ * @brief Records the time spent until the end of the enclosing scope, name must be a string literal
+ */
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__){name}
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#endif
+
+/**
+ * @brief Hierarchical CPU profiler.
+ * Every thread records the scopes it leaves into its own ring buffer, without any lock, so that instrumentation can
+ * stay in the hot paths. The buffers of all threads can then be exported as a Chrome trace, which Perfetto opens too.
+ */
+class Profiler {
+public:
+    struct Event {
+        const char* name;
+        long long start;    // Nanoseconds since the start of the profiler
+        long long end;
+        unsigned depth;     // Number of enclosing scopes on the same thread
+    };
+
+    struct ThreadEvents {
+        unsigned threadId;
+        std::string threadName;
+        std::vector<Event> events;
+    };
+
+    /**
+     * @brief Number of events each thread keeps before overwriting its oldest ones
+     */
+    static constexpr unsigned capacity = 1 << 15;
+
+    static void setEnabled(bool enabled);
+    [[nodiscard]] static bool isEnabled();
+
+    /**
+     * @brief Nanoseconds since the start of the profiler
+     */
+    [[nodiscard]] static long long now();
+
+    static void record(const char* name, long long start, long long end, unsigned depth);
+
+    /**
+     * @brief Names the calling thread in exported traces
+     */
+    static void setThreadName(const std::string& name);
+
+    /**
+     * @brief Marks the beginning of a frame on the calling thread, which becomes the thread of the frame view
+     */
+    static void beginFrame();
+
+    /**
+     * @brief Events of the last complete frame, sorted by start time
+     * @param start Filled with the start of the frame
+     * @param end Filled with the end of the frame
+     */
+    [[nodiscard]] static std::vector<Event> getLastFrame(long long& start, long long& end);
+
+    /**
+     * @brief Copies the events currently held by every thread
+     */
+    [[nodiscard]] static std::vector<ThreadEvents> collect();
+
+    static void writeChromeTrace(const std::string& path);
+};
+
+/**
+ * @brief Records an event from its construction to its destruction, see PROFILE_SCOPE
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name);
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator =(const ProfileScope&) = delete;
+
+    ~ProfileScope();
+
+private:
+    const char* name;
+    long long start;
+    unsigned depth;
+};
\ No newline at end of file
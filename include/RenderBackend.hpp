@@ -0,0 +1,66 @@
+/******************************************************************************************************
+ * @file  RenderBackend.hpp
+ * @brief Declaration of the RenderBackend and OpenGLBackend classes
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <functional>
+
+#include "GeometryPool.hpp"
+#include "InstanceBuffer.hpp"
+#include "maths/Matrix4.hpp"
+#include "Mesh.hpp"
+#include "Shader.hpp"
+#include "Texture.hpp"
+
+struct Material {
+    const Texture* texture = nullptr; // Untextured when null
+};
+
+/**
+ * @brief Draws what a render queue executes, see RenderQueue::execute.
+ * Shaders and textures only name what to run and sample, so that backends other than OpenGL can map them to their
+ * own programs and images.
+ */
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    virtual void useShader(const Shader& shader) = 0;
+
+    /**
+     * @brief Called after useShader and whenever the texture changes
+     */
+    virtual void bindMaterial(const Shader& shader, const Material& material) = 0;
+
+    virtual void draw(const Shader& shader, Mesh& mesh, const Matrix4& model) = 0;
+    virtual void drawInstanced(const Shader& shader, Mesh& mesh, const InstanceBuffer& instances) = 0;
+    virtual void drawIndirect(const Shader& shader, const IndirectDraws& draws) = 0;
+};
+
+/**
+ * @brief Draws with the OpenGL context, the uniforms being set by callbacks
+ */
+class OpenGLBackend : public RenderBackend {
+public:
+    /**
+     * @brief Called back while drawing, each only when what it binds changes
+     */
+    struct Bindings {
+        std::function<void(const Shader& shader)> shader;   // After the shader is used, to set per frame uniforms
+        std::function<void(const Shader& shader, const Material& material)> material;
+        std::function<void(const Shader& shader, const Matrix4& model)> model; // Only called for single draws
+    };
+
+    explicit OpenGLBackend(const Bindings& bindings);
+
+    void useShader(const Shader& shader) override;
+    void bindMaterial(const Shader& shader, const Material& material) override;
+    void draw(const Shader& shader, Mesh& mesh, const Matrix4& model) override;
+    void drawInstanced(const Shader& shader, Mesh& mesh, const InstanceBuffer& instances) override;
+    void drawIndirect(const Shader& shader, const IndirectDraws& draws) override;
+
+private:
+    const Bindings& bindings;
+};
\ No newline at end of file
@@ -0,0 +1,103 @@
+/******************************************************************************************************
+ * @file  RenderQueue.hpp
+ * @brief Declaration of the RenderQueue class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "GeometryPool.hpp"
+#include "InstanceBuffer.hpp"
+#include "maths/Matrix4.hpp"
+#include "Mesh.hpp"
+#include "RenderBackend.hpp"
+#include "Shader.hpp"
+#include "Texture.hpp"
+
+/**
+ * @brief Passes are executed in this order
+ */
+enum class RenderPass : std::uint8_t {
+    noLight,
+    light,
+    opaque
+};
+
+/**
+ * @brief Collects the draws of a frame, sorts them by a 64-bit key and executes them pass by pass.
+ * From the most significant bits, keys hold the pass, the shader, the texture and the quantized distance to the
+ * camera, so draws sharing a shader and a texture end up next to each other and are drawn front to back.
+ */
+class RenderQueue {
+public:
+    struct DrawCommand {
+        Mesh* mesh;                     // Null for indirect draws
+        Material material;
+        const Shader* shader;
+        Matrix4 model;
+        const InstanceBuffer* instances; // Drawn with Mesh::drawInstanced when not null
+        const IndirectDraws* indirect;
+    };
+
+    using Bindings = OpenGLBackend::Bindings;
+
+    RenderQueue();
+
+    /**
+     * @brief Clears the queue for a new frame
+     * @param camera Position of the camera, from which depths are measured
+     * @param maxDepth Distance beyond which depths are clamped
+     */
+    void begin(const Point& camera, float maxDepth);
+
+    void submit(RenderPass pass, const Shader& shader, const Material& material, Mesh& mesh, const Matrix4& model);
+
+    /**
+     * @brief Submits an instanced draw, which is sorted as if it were at the camera since its instances are spread out
+     */
+    void submit(RenderPass pass, const Shader& shader, const Material& material, Mesh& mesh,
+                const InstanceBuffer& instances);
+
+    /**
+     * @brief Submits draws of the geometry pool, sorted like instanced draws
+     */
+    void submit(RenderPass pass, const Shader& shader, const Material& material, const IndirectDraws& draws);
+
+    /**
+     * @brief Sorts the draws with an LSD radix sort, skipping the bytes that are the same in every key
+     */
+    void sort();
+
+    /**
+     * @brief Executes the sorted draws of a pass, the shader and the material only being bound when they change
+     */
+    void execute(RenderPass pass, RenderBackend& backend) const;
+
+    /**
+     * @brief Executes the sorted draws of a pass with the OpenGL context
+     */
+    void execute(RenderPass pass, const Bindings& bindings) const;
+
+    /**
+     * @brief Draws in the order they were submitted
+     */
+    [[nodiscard]] const std::vector<DrawCommand>& getCommands() const;
+    [[nodiscard]] std::size_t getSize() const;
+
+    [[nodiscard]] static std::uint64_t makeKey(RenderPass pass, unsigned shader, unsigned texture, float depth);
+
+private:
+    struct SortEntry {
+        std::uint64_t key;
+        std::uint32_t index;
+    };
+
+    std::vector<DrawCommand> commands;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch;
+
+    Point camera;
+    float maxDepth;
+};
\ No newline at end of file
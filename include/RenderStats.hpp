@@ -0,0 +1,36 @@
+/******************************************************************************************************
+ * @file  RenderStats.hpp
+ * @brief Declaration of the RenderStats struct
+ ******************************************************************************************************/
+
+#pragma once
+
+/**
+ * @brief Rendering counters of the current frame.
+ * They are plain integers incremented by the rendering thread, so they stay on in release builds.
+ */
+struct RenderStats {
+    unsigned long long drawCalls;
+    unsigned long long triangles;
+    unsigned long long stateChanges;    // Program, vertex array, texture and rasterizer state binds
+    unsigned long long uniformUploads;
+    unsigned long long bufferBytes;     // Bytes uploaded to buffer objects
+    unsigned long long objectsVisible;  // Scene objects left after frustum and occlusion culling
+    unsigned long long objectsCulled;
+    unsigned long long objectsOccluded; // Among the culled ones, those inside of the frustum
+
+    /**
+     * @brief Counters of the frame being rendered
+     */
+    [[nodiscard]] static RenderStats& frame();
+
+    /**
+     * @brief Sets every counter of the frame back to zero, to be called when a frame starts
+     */
+    static void reset();
+
+    /**
+     * @brief Number of triangles drawn by a draw call with the given primitive and vertex count
+     */
+    [[nodiscard]] static unsigned long long triangleCount(unsigned primitive, unsigned long long count);
+};
\ No newline at end of file
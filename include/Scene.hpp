@@ -0,0 +1,170 @@
+/******************************************************************************************************
+ * @file  Scene.hpp
+ * @brief Declaration of the Scene class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "FrustumCuller.hpp"
+#include "GeometryPool.hpp"
+#include "InstanceBuffer.hpp"
+#include "maths/bounds.hpp"
+#include "maths/frustum.hpp"
+#include "maths/Matrix4.hpp"
+#include "meshes.hpp"
+#include "OcclusionCuller.hpp"
+#include "SceneBVH.hpp"
+#include "Texture.hpp"
+#include "TextureCache.hpp"
+
+/**
+ * @brief Meshes and textures drawn by the application
+ */
+class Scene {
+public:
+    /**
+     * @brief Untextured object drawn with the default shader, used to make the scene as heavy as needed
+     */
+    struct Object {
+        Mesh* mesh;
+        Matrix4 model;
+
+        // World space bounds
+        AABB box;
+        BoundingSphere sphere;
+    };
+
+    /**
+     * @brief Visible objects sharing a mesh, uploaded as instances to draw them all at once
+     */
+    struct Batch {
+        Mesh* mesh;
+        std::unique_ptr<InstanceBuffer> instances;
+    };
+
+    /**
+     * @brief Image of the textured sphere at the center of the scene
+     */
+    static constexpr const char* ceresPath = "data/textures/ceres.jpg";
+
+    Scene(TextureCache& textures);
+
+    /**
+     * @brief Replaces the objects with count objects laid out on a square grid around the origin.
+     * The layout only depends on count so that benchmarks always render the same scene
+     * @param mesh Mesh of every object, objects cycle through a few meshes when it is null
+     */
+    void populate(unsigned count, Mesh* mesh = nullptr);
+
+    /**
+     * @brief Radius of the area covered by the objects
+     */
+    [[nodiscard]] float getRadius() const;
+
+    /**
+     * @brief Moves the object, refitting the hierarchy over the objects and rebuilding it once a quarter of them moved
+     */
+    void setModel(unsigned index, const Matrix4& model);
+
+    /**
+     * @brief Hides the objects outside of the frustum, the batches and the indirect draws are only uploaded again
+     * by uploadInstances and uploadIndirectDraws when the set of visible objects changes or objects moved
+     * @param hierarchical Whether to walk the hierarchy over the objects instead of testing all of them
+     * @param occlusion When not null, the objects inside of the frustum are then tested against its occluders,
+     * after waiting for them to be rendered, so the frustum is tested while they are
+     * @return Number of visible objects
+     */
+    unsigned cull(const Frustum& frustum, bool hierarchical, OcclusionCuller* occlusion = nullptr);
+
+    /**
+     * @brief Objects inside of the frustum but hidden by the occluders during the last cull
+     */
+    [[nodiscard]] unsigned getOccludedCount() const;
+
+    /**
+     * @brief Appends the objects inside of the frustum closest to its apex, nearest first, which make the best occluders
+     * @param maxDistance Objects farther than this are not considered
+     */
+    void findOccluders(const Frustum& frustum, const Point& position, unsigned count, float maxDistance,
+                       std::vector<unsigned>& occluders) const;
+
+    /**
+     * @brief Makes every object visible again
+     */
+    void resetVisibility();
+
+    /**
+     * @brief Uploads the visible objects to the instance buffers of the batches if they changed since the last
+     * upload, to be called before drawing the batches so that other draw paths do not pay for it
+     */
+    void uploadInstances();
+
+    /**
+     * @brief Uploads the visible objects to the indirect draws if they changed since the last upload, when supported
+     */
+    void uploadIndirectDraws();
+
+    /**
+     * @brief Whether each object is visible, in the order of objects
+     */
+    [[nodiscard]] const std::vector<std::uint8_t>& getVisibility() const;
+
+    /**
+     * @brief Hierarchy over the world space boxes of the objects, for picking and proximity queries
+     */
+    [[nodiscard]] const SceneBVH& getBVH() const;
+
+    std::shared_ptr<Texture> ceres;
+//    std::shared_ptr<Texture> earth;
+//    std::shared_ptr<Texture> texCube;
+
+    Mesh axis;
+    Mesh grid;
+    Mesh cube;
+    Mesh disk;
+    Mesh cylinder;
+    Mesh sphere;
+    Mesh cone;
+    Mesh torus;
+    Mesh klein;
+    Mesh tube;
+
+    std::vector<Object> objects;
+    std::vector<Batch> batches;
+
+    /**
+     * @brief Meshes of the objects, which are also drawn all at once from the pool when multi-draw indirect is
+     * supported, in which case indirect is not null
+     */
+    std::unique_ptr<GeometryPool> pool;
+    std::unique_ptr<IndirectDraws> indirect;
+
+private:
+    /**
+     * @brief Range of the mesh in the pool, adding it first if needed
+     */
+    GeometryPool::Range getRange(Mesh& mesh);
+
+    /**
+     * @brief Builds the hierarchy from the boxes of the objects
+     */
+    void buildBVH();
+
+    std::map<const Mesh*, GeometryPool::Range> ranges;
+
+    FrustumCuller culler;
+    SceneBVH bvh;
+    unsigned movedObjects; // Since the hierarchy was built
+    bool instancesDirty;
+    bool indirectDirty;
+    unsigned occluded;
+
+    std::vector<std::uint8_t> visibility;
+    std::vector<std::uint8_t> nextVisibility;
+    float radius;
+};
\ No newline at end of file
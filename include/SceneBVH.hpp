@@ -0,0 +1,102 @@
+/******************************************************************************************************
+ * @file  SceneBVH.hpp
+ * @brief Declaration of the SceneBVH class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "BVH.hpp"
+#include "maths/bounds.hpp"
+#include "maths/frustum.hpp"
+#include "maths/ray.hpp"
+
+/**
+ * @brief Bounding volume hierarchy over the world space boxes of the objects of a scene.
+ * It is built with the surface area heuristic and refitted in place when objects move, which keeps queries
+ * correct but lets their cost drift, so it should be rebuilt once many objects moved far.
+ */
+class SceneBVH {
+public:
+    using Node = BVHNode;
+
+    struct Hit {
+        unsigned object;
+        float distance;
+    };
+
+    SceneBVH();
+
+    /**
+     * @param bounds World space box of each object, objects are referred to by their index in bounds
+     */
+    void build(const std::vector<AABB>& bounds);
+
+    /**
+     * @brief Changes the box of the object and enlarges or shrinks the boxes of the nodes above it
+     */
+    void update(unsigned object, const AABB& box);
+
+    /**
+     * @brief Recomputes the box of every node from the boxes of the objects
+     */
+    void refit();
+
+    /**
+     * @brief Nodes inside the frustum are accepted without testing their descendants, nodes outside of it are
+     * rejected with all of their objects, and planes that a node is fully in front of are not tested again below it
+     * @param visibility Receives 1 for each visible object and 0 for each culled one
+     * @return Number of visible objects
+     */
+    unsigned cull(const Frustum& frustum, std::vector<std::uint8_t>& visibility) const;
+
+    /**
+     * @brief Closest box hit by the ray, children are visited nearest first so that farther ones are skipped
+     */
+    [[nodiscard]] std::optional<Hit> raycast(const Ray& ray,
+                                             float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+    /**
+     * @brief Closest object hit by the ray, according to hitObject which is only called on objects whose box is hit
+     * closer than the closest hit so far
+     * @param hitObject Distance at which the ray hits the object, infinity when it misses it
+     */
+    [[nodiscard]] std::optional<Hit> raycast(const Ray& ray, const std::function<float(unsigned)>& hitObject,
+                                             float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+    /**
+     * @brief Appends the objects whose box intersects the volume
+     */
+    void query(const AABB& box, std::vector<unsigned>& objects) const;
+    void query(const BoundingSphere& sphere, std::vector<unsigned>& objects) const;
+
+    /**
+     * @brief See surfaceAreaCost
+     */
+    [[nodiscard]] float getCost() const;
+
+    [[nodiscard]] const AABB& getBox(unsigned object) const;
+    [[nodiscard]] unsigned getSize() const;
+    [[nodiscard]] unsigned getNodeCount() const;
+    [[nodiscard]] const std::vector<Node>& getNodes() const;
+
+private:
+    void refitNode(unsigned node);
+
+    /**
+     * @brief Marks every object below the node as visible without testing them
+     */
+    unsigned acceptAll(unsigned node, std::vector<std::uint8_t>& visibility) const;
+
+    std::vector<Node> nodes;
+    std::vector<unsigned> parents;
+
+    std::vector<AABB> boxes;        // Indexed by object
+    std::vector<unsigned> objects;  // Objects ordered by leaf, each leaf owning a contiguous range
+    std::vector<unsigned> leaves;   // Leaf holding each object
+};
\ No newline at end of file
@@ -0,0 +1,94 @@
+/******************************************************************************************************
+ * @file  SceneGraph.hpp
+ * @brief Declaration of the SceneGraph class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "maths/Matrix4.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @brief Hierarchy of transforms, each node placing its children relative to itself.
+ * Nodes are stored as a structure of arrays sorted by depth then by parent, so that a whole level is updated once the
+ * one above is, in parallel and going through memory in order. Setting a local transform only marks its node as dirty, and an update
+ * only recomputes the world transforms of the dirty nodes and of their descendants.
+ */
+class SceneGraph {
+public:
+    /**
+     * @brief Handle of a node, which stays valid when the nodes are sorted again
+     */
+    using Node = unsigned;
+
+    static constexpr Node none = std::numeric_limits<Node>::max();
+
+    explicit SceneGraph(ThreadPool& pool = ThreadPool::global());
+
+    void clear();
+    void reserve(unsigned count);
+
+    /**
+     * @brief Adds a node below the parent, or a root when there is none. Its world transform is computed by the next
+     * update, which first sorts the nodes again unless it was added to the deepest level after its siblings and cousins
+     */
+    Node add(const Matrix4& local, Node parent = none);
+
+    void setLocal(Node node, const Matrix4& local);
+
+    [[nodiscard]] const Matrix4& getLocal(Node node) const;
+
+    /**
+     * @brief Local transform of the node composed with the ones of its ancestors, as of the last update
+     */
+    [[nodiscard]] const Matrix4& getWorld(Node node) const;
+
+    [[nodiscard]] Node getParent(Node node) const;
+
+    /**
+     * @brief Whether the last update recomputed the world transform of the node
+     */
+    [[nodiscard]] bool hasChanged(Node node) const;
+
+    /**
+     * @brief Recomputes the world transforms of the dirty nodes and of their descendants, one level after the other,
+     * each level being split across the pool
+     * @return Number of world transforms recomputed
+     */
+    unsigned update();
+
+    [[nodiscard]] unsigned getSize() const;
+
+    /**
+     * @brief Depth of the deepest node plus one
+     */
+    [[nodiscard]] unsigned getLevelCount() const;
+
+private:
+    /**
+     * @brief Orders the slots breadth first, by depth then by parent, keeping the order in which siblings were added
+     */
+    void sort();
+
+    ThreadPool& pool;
+
+    // Indexed by slot
+    std::vector<unsigned> parents;      // Slot of the parent, none for roots
+    std::vector<unsigned> depths;
+    std::vector<Matrix4> locals;
+    std::vector<Matrix4> worlds;
+    std::vector<std::uint8_t> dirty;    // Local transform set since the last update
+    std::vector<std::uint8_t> changed;  // World transform recomputed by the last update
+    std::vector<Node> nodes;            // Node held by the slot
+
+    std::vector<unsigned> slots;        // Indexed by node
+    std::vector<unsigned> levels;       // First slot of each depth, followed by the number of slots
+    bool sorted;
+
+    unsigned dirtyCount;
+    unsigned changedCount;
+};
\ No newline at end of file
@@ -31,4 +31,7 @@ public:
     void setUniform(const std::string& uniform, const Matrix4& matrix) const;
 
     const unsigned int id;
+
+private:
+    [[nodiscard]] unsigned long long binarySize() const;
 };
\ No newline at end of file
@@ -0,0 +1,233 @@
+/******************************************************************************************************
+ * @file  SoftwareRasterizer.hpp
+ * @brief Declaration of the SoftwareRasterizer class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "ImageData.hpp"
+#include "Light.hpp"
+#include "MemoryTracker.hpp"
+#include "Mesh.hpp"
+#include "RenderBackend.hpp"
+#include "ThreadPool.hpp"
+#include "maths/Matrix4.hpp"
+
+/**
+ * @brief Render backend drawing on the CPU, without any OpenGL context, so its images only depend on the scene.
+ * Draws are transformed, clipped and binned into tiles of the image as they come, then finish rasterizes the tiles
+ * across the threads of the pool. Each tile draws its primitives in the order they were submitted, so the image does
+ * not depend on the number of threads. Edge functions are evaluated four pixels at a time, and the farthest depth of
+ * every 8x8 block of pixels skips the primitives entirely behind what was already drawn there.
+ * Shaders are mapped to programs written after the shaders of data/shaders, and textures to images.
+ */
+class SoftwareRasterizer : public RenderBackend {
+public:
+    enum class Program : std::uint8_t {
+        phong,      // default.vert and default.frag
+        light,      // light.vert and light.frag, the diffuse color of the light
+        noLight     // noLight.vert and noLight.frag, the color of the vertices without any model matrix
+    };
+
+    /**
+     * @brief Same values as the material of the default shader
+     */
+    struct PhongMaterial {
+        Color ambient;
+        Color diffuse;
+        Color specular;
+        float shininess;
+    };
+
+    SoftwareRasterizer(int width, int height, ThreadPool& pool = ThreadPool::global());
+
+    SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+    SoftwareRasterizer& operator =(const SoftwareRasterizer&) = delete;
+
+    /**
+     * @brief Program run for the draws of a shader when used as a render backend
+     */
+    void setProgram(const Shader& shader, Program program);
+
+    /**
+     * @brief Image sampled for a texture when used as a render backend, it must live as long as the rasterizer
+     */
+    void setTexture(const Texture& texture, const ImageData& image);
+
+    void setCamera(const Matrix4& view, const Matrix4& projection, const Point& position);
+    void setLighting(const Light& light, const PhongMaterial& material);
+
+    /**
+     * @brief Whether triangles facing away from the camera are skipped, like with GL_CULL_FACE. Enabled by default
+     */
+    void setCulling(bool culling);
+
+    /**
+     * @brief Starts a frame cleared to the color, camera and lighting must be set before drawing
+     */
+    void begin(const Color& background);
+
+    void use(Program program);
+
+    /**
+     * @brief Texture multiplying the lit color of the phong program, none when null
+     */
+    void bindTexture(const ImageData* texture);
+
+    /**
+     * @brief Transforms the mesh and bins its triangles or lines, other primitives are skipped.
+     * Indexed triangle meshes without normals get them computed
+     */
+    void draw(Mesh& mesh, const Matrix4& model);
+
+    /**
+     * @brief Rasterizes everything drawn since begin
+     */
+    void finish();
+
+    void useShader(const Shader& shader) override;
+    void bindMaterial(const Shader& shader, const ::Material& material) override;
+    void draw(const Shader& shader, Mesh& mesh, const Matrix4& model) override;
+
+    /**
+     * @brief Not supported, instance buffers and indirect draws only keep their data on the GPU
+     */
+    void drawInstanced(const Shader& shader, Mesh& mesh, const InstanceBuffer& instances) override;
+    void drawIndirect(const Shader& shader, const IndirectDraws& draws) override;
+
+    /**
+     * @brief Colors clamped to [0, 1], rows bottom first like in every ImageData
+     */
+    [[nodiscard]] ImageData getImage() const;
+
+    [[nodiscard]] int getWidth() const;
+    [[nodiscard]] int getHeight() const;
+
+    /**
+     * @brief Triangles and lines binned since begin, after culling and clipping
+     */
+    [[nodiscard]] unsigned long long getPrimitiveCount() const;
+
+    /**
+     * @brief Blocks of pixels skipped by primitives because of their farthest depth since begin
+     */
+    [[nodiscard]] unsigned long long getOccludedBlockCount() const;
+
+private:
+    static constexpr int tileSize = 64;
+    static constexpr int blockSize = 8;
+    static constexpr int blocksPerTile = tileSize / blockSize;
+
+    static_assert(blocksPerTile * blocksPerTile == 64, "The blocks of a tile are tracked with a 64-bit mask");
+
+    /**
+     * @brief Output of the vertex program, in clip space for the position and in world space for the shading
+     */
+    struct Vertex {
+        vec4 clip;
+        Point position;
+        Vector normal;
+        Color color;
+        TexCoord texcoord;
+    };
+
+    /**
+     * @brief Triangle or line set up in pixels, rows bottom first
+     */
+    struct Primitive {
+        // Edge functions a * x + b * y + c of the edges facing each vertex, positive inside. Doubles hold them
+        // exactly for vertices snapped to 1/16 of a pixel, so a pixel on an edge is inside of one triangle only
+        double a[3];
+        double b[3];
+        double c[3];
+        bool topLeft[3];        // Pixels on the edge are inside
+        float inverseArea;
+
+        // Depth in [0, 1] as the plane zx * x + zy * y + z0
+        float zx;
+        float zy;
+        float z0;
+        float minZ;
+
+        float x[3];
+        float y[3];
+        float z[3];
+        float inverseW[3];
+        unsigned vertices[3];   // Indices in vertices
+        unsigned state;         // Index in states
+
+        int minX;               // Bounds of the pixels covered, inclusive
+        int minY;
+        int maxX;
+        int maxY;
+        bool line;
+    };
+
+    struct State {
+        Program program;
+        const ImageData* texture;
+    };
+
+    /**
+     * @brief Clips the primitive to the near and far planes, then sets it up and bins it
+     */
+    void addTriangle(unsigned first, unsigned second, unsigned third);
+    void addLine(unsigned first, unsigned second);
+    void setupTriangle(const unsigned (&indices)[3]);
+    void setupLine(const unsigned (&indices)[2]);
+    void bin(unsigned primitive);
+
+    /**
+     * @brief Vertex interpolated between two others, perspective being handled by the rasterizer
+     */
+    [[nodiscard]] static Vertex interpolate(const Vertex& from, const Vertex& to, float t);
+
+    void rasterizeTile(unsigned tile);
+
+    /**
+     * @return Mask of the blocks of the tile that were written to
+     */
+    std::uint64_t rasterizeTriangle(const Primitive& triangle, int tileX, int tileY);
+    std::uint64_t rasterizeLine(const Primitive& line, int tileX, int tileY);
+
+    /**
+     * @brief Runs the program of the primitive for the pixel, from perspective correct weights of its vertices
+     */
+    [[nodiscard]] Color shade(const Primitive& primitive, const float (&weights)[3]) const;
+
+    void updateBlockDepth(int block);
+
+    int width;
+    int height;
+    int stride;     // Width rounded up to whole tiles
+    int tilesX;
+    int tilesY;
+    ThreadPool& pool;
+
+    std::map<const Shader*, Program> programs;
+    std::map<const Texture*, const ImageData*> textures;
+
+    Matrix4 viewProjection;
+    Point cameraPosition;
+    Light light;
+    PhongMaterial material;
+    bool culling;
+
+    Program program;
+    const ImageData* texture;
+
+    std::vector<Vertex> vertices;
+    std::vector<Primitive> primitives;
+    std::vector<State> states;
+    std::vector<std::vector<unsigned>> bins; // Primitives overlapping each tile, in the order they were drawn
+
+    std::vector<Color, TrackingAllocator<Color, MemoryTag::images>> colors;
+    std::vector<float, TrackingAllocator<float, MemoryTag::images>> depths;
+    std::vector<float> blockDepths; // Farthest depth of each block
+    std::atomic<unsigned long long> occludedBlocks;
+};
\ No newline at end of file
@@ -6,7 +6,9 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <vector>
 
+#include "CompressedImage.hpp"
 #include "ImageData.hpp"
 
 class Texture {
@@ -14,12 +16,47 @@ public:
     Texture();
     Texture(const ImageData& image);
 
+    /**
+     * @brief Uploads a mipmap chain built on the CPU, see buildMipChain
+     */
+    Texture(const std::vector<ImageData>& mipmaps);
+
+    /**
+     * @brief Uploads the blocks and the mipmap levels of a compressed image without any conversion, or decompresses
+     * them first when the driver does not support S3TC
+     */
+    Texture(const CompressedImage& image);
+
+    Texture(const Texture&) = delete;
+    Texture& operator =(const Texture&) = delete;
+
     ~Texture();
 
     void bind() const;
 
     [[nodiscard]] unsigned getId() const;
 
+    /**
+     * @brief Approximate amount of video memory used by the texture, mipmaps included
+     */
+    [[nodiscard]] unsigned long long getSize() const;
+
+    /**
+     * @brief Sum of the sizes of every texture alive
+     */
+    [[nodiscard]] static unsigned long long getResidentBytes();
+
+    /**
+     * @brief Whether the context can sample BC1 and BC3 blocks, it must be current
+     */
+    [[nodiscard]] static bool isCompressionSupported();
+
 private:
+    /**
+     * @brief Uploads an uncompressed level of the bound texture, and adds its size
+     */
+    void upload(const ImageData& level, int index);
+
     unsigned id;
+    unsigned long long size;
 };
\ No newline at end of file
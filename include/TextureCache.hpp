@@ -0,0 +1,82 @@
+/******************************************************************************************************
+ * @file  TextureCache.hpp
+ * @brief Declaration of the TextureCache class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "Texture.hpp"
+
+/**
+ * @brief Shares textures between every object that uses the same image.
+ * Textures are keyed by their path and by a hash of the file's content so that two paths pointing to the same
+ * image only get decoded and uploaded once. Textures that are not used anymore are kept resident until the VRAM
+ * budget is exceeded, in which case the least recently used ones are evicted first.
+ */
+class TextureCache {
+public:
+    struct Statistics {
+        unsigned long long hits;
+        unsigned long long misses;
+        unsigned long long evictions;
+        unsigned long long bytesResident;
+        unsigned textureCount;
+    };
+
+    TextureCache(unsigned long long budget = 512ull * 1024ull * 1024ull);
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator =(const TextureCache&) = delete;
+
+    std::shared_ptr<Texture> get(const std::string& path);
+
+    void setBudget(unsigned long long bytes);
+    [[nodiscard]] unsigned long long getBudget() const;
+
+    /**
+     * @brief Evicts least recently used textures that are not referenced anywhere else until the bytes resident
+     * fit in the budget
+     */
+    void trim();
+
+    /**
+     * @brief Evicts least recently used textures that are not referenced anywhere else until at least the given
+     * amount of bytes is freed, used when the texture memory budget of the MemoryTracker is exceeded
+     * @return The amount of bytes freed
+     */
+    unsigned long long release(unsigned long long bytes);
+
+    /**
+     * @brief Evicts every texture that is not referenced anywhere else
+     */
+    void clear();
+
+    [[nodiscard]] const Statistics& getStatistics() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<Texture> texture;
+        std::uint64_t hash;
+        std::list<std::string> paths;
+    };
+
+    using LRUList = std::list<Entry>;
+
+    void touch(LRUList::iterator entry);
+    void evict(LRUList::iterator entry);
+
+    static std::uint64_t hashFile(const std::string& path);
+
+    unsigned long long budget;
+    Statistics statistics;
+
+    LRUList entries; // Most recently used first
+    std::unordered_map<std::string, LRUList::iterator> byPath;
+    std::unordered_map<std::uint64_t, LRUList::iterator> byHash;
+};
\ No newline at end of file
@@ -0,0 +1,67 @@
+/******************************************************************************************************
+ * @file  ThreadPool.hpp
+ * @brief Declaration of the ThreadPool class
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threadCount = std::thread::hardware_concurrency());
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator =(const ThreadPool&) = delete;
+
+    ~ThreadPool();
+
+    /**
+     * @brief Queues a task on the pool
+     * @return A future holding the result of the task
+     */
+    template<typename Function>
+    std::future<std::invoke_result_t<Function>> submit(Function&& function) {
+        using Result = std::invoke_result_t<Function>;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+        std::future<Result> future = task->get_future();
+
+        enqueue([task] { (*task)(); });
+
+        return future;
+    }
+
+    /**
+     * @brief Calls function(first, last) on chunks of [begin, end[ across the pool and waits for all of them.
+     * The calling thread takes part in the work, so it is safe to call from inside a task of the same pool.
+     * @param grain Minimum number of iterations in a chunk
+     */
+    void parallelFor(unsigned begin, unsigned end, const std::function<void(unsigned, unsigned)>& function, unsigned grain = 1);
+
+    [[nodiscard]] unsigned getThreadCount() const;
+
+    /**
+     * @brief Pool shared by the whole engine, created on first use
+     */
+    static ThreadPool& global();
+
+private:
+    void enqueue(std::function<void()> task);
+    void work();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping;
+};
\ No newline at end of file
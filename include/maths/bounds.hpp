@@ -0,0 +1,65 @@
+/******************************************************************************************************
+ * @file  bounds.hpp
+ * @brief Declaration of the bounding volumes
+ ******************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+
+#include "maths/Matrix4.hpp"
+#include "maths/vec3.hpp"
+
+/**
+ * @brief Axis-aligned bounding box, empty boxes have their minimum above their maximum
+ */
+struct AABB {
+    Point min;
+    Point max;
+
+    [[nodiscard]] static AABB empty();
+
+    [[nodiscard]] bool isEmpty() const;
+    [[nodiscard]] Point center() const;
+    [[nodiscard]] Vector extent() const; // Half of the size
+    [[nodiscard]] float surfaceArea() const;
+
+    void extend(const Point& point);
+    void extend(const AABB& box);
+};
+
+struct BoundingSphere {
+    Point center;
+    float radius;
+};
+
+/**
+ * @brief Smallest box containing the points, whose coordinates are reduced 4 points at a time with SSE
+ */
+AABB computeAABB(const Point* points, std::size_t count);
+
+/**
+ * @brief Sphere centered on the box of the points that contains all of them.
+ * It is a bit larger than the smallest enclosing sphere but costs only two passes over the points
+ */
+BoundingSphere computeBoundingSphere(const Point* points, std::size_t count);
+BoundingSphere computeBoundingSphere(const Point* points, std::size_t count, const AABB& box);
+
+/**
+ * @brief Box containing the transformed box, using the absolute values of the matrix to transform its extent
+ */
+AABB transform(const AABB& box, const Matrix4& matrix);
+
+/**
+ * @brief Sphere containing the transformed sphere, its radius is scaled by the largest scale of the matrix
+ */
+BoundingSphere transform(const BoundingSphere& sphere, const Matrix4& matrix);
+
+bool intersects(const AABB& box1, const AABB& box2);
+bool intersects(const AABB& box, const BoundingSphere& sphere);
+bool contains(const AABB& box, const Point& point);
+
+/**
+ * @brief Squared distance from the point to the closest point of the box, 0 when the point is inside
+ */
+float distanceSquared(const AABB& box, const Point& point);
\ No newline at end of file
@@ -0,0 +1,37 @@
+/******************************************************************************************************
+ * @file  frustum.hpp
+ * @brief Declaration of the view frustum
+ ******************************************************************************************************/
+
+#pragma once
+
+#include "maths/bounds.hpp"
+#include "maths/Matrix4.hpp"
+#include "maths/vec3.hpp"
+
+/**
+ * @brief Points p such that dot(normal, p) + distance >= 0 are in front of the plane
+ */
+struct Plane {
+    Vector normal;
+    float distance;
+};
+
+/**
+ * @brief Planes of a view frustum, pointing inwards, in the order left, right, bottom, top, near and far
+ */
+struct Frustum {
+    Plane planes[6];
+};
+
+/**
+ * @brief Extracts the planes of the frustum from the rows of the matrix, in the space the matrix transforms from.
+ * Giving projection * view yields world space planes
+ */
+Frustum extractFrustum(const Matrix4& matrix);
+
+/**
+ * @brief Conservative tests, a volume crossing the corner of two planes may be reported as intersecting
+ */
+bool intersects(const Frustum& frustum, const BoundingSphere& sphere);
+bool intersects(const Frustum& frustum, const AABB& box);
\ No newline at end of file
@@ -0,0 +1,76 @@
+/******************************************************************************************************
+ * @file  ray.hpp
+ * @brief Declaration of the ray
+ ******************************************************************************************************/
+
+#pragma once
+
+#include "maths/bounds.hpp"
+#include "maths/Matrix4.hpp"
+#include "maths/vec3.hpp"
+
+/**
+ * @brief Half-line of the points origin + t * direction for t >= 0, distances along it are values of t
+ */
+struct Ray {
+    Point origin;
+    Vector direction;
+};
+
+/**
+ * @brief Ray from the camera through a point of the screen
+ * @param viewProjection Projection times view matrix of the camera
+ * @param x, y Normalized device coordinates of the point, from -1 to 1 with y going up
+ */
+Ray screenRay(const Matrix4& viewProjection, float x, float y);
+
+/**
+ * @brief Same as screenRay with the inverse of the projection times view matrix, for many rays of the same camera
+ */
+Ray unprojectRay(const Matrix4& inverseViewProjection, float x, float y);
+
+/**
+ * @brief Slab test of the ray against the box
+ * @param inverseDirection 1 / direction, computed once per ray
+ * @return Distance at which the ray enters the box, 0 when it starts inside and infinity when it misses it
+ */
+float intersect(const Ray& ray, const Vector& inverseDirection, const AABB& box);
+
+/**
+ * @brief Moller-Trumbore test of the ray against both faces of the triangle vertex, vertex + edge1, vertex + edge2
+ * @param u, v Receive the barycentric coordinates of the hit point along edge1 and edge2
+ * @return Distance at which the ray hits the triangle, infinity when it misses it
+ */
+float intersect(const Ray& ray, const Point& vertex, const Vector& edge1, const Vector& edge2, float& u, float& v);
+
+/**
+ * @brief 4 rays stored as a structure of arrays, so that coherent rays are tested together with SIMD
+ */
+struct alignas(16) RayPacket {
+    static constexpr unsigned size = 4;
+
+    RayPacket() = default;
+    explicit RayPacket(const Ray (&rays)[size]);
+
+    [[nodiscard]] Ray operator [](unsigned i) const;
+
+    float originX[size], originY[size], originZ[size];
+    float directionX[size], directionY[size], directionZ[size];
+    float inverseX[size], inverseY[size], inverseZ[size]; // 1 / direction
+};
+
+/**
+ * @brief Slab test of the rays against the box
+ * @param closest Distance up to which each ray looks for hits, negative for the rays to ignore
+ * @return Mask of the rays entering the box before their closest distance, bit i for ray i
+ */
+int intersect(const RayPacket& rays, const AABB& box, const float* closest);
+
+/**
+ * @brief Moller-Trumbore test of the rays against both faces of the triangle
+ * @param closest Distance up to which each ray looks for hits, negative for the rays to ignore
+ * @param distances, u, v Receive the distance and barycentric coordinates of each hit
+ * @return Mask of the rays hitting the triangle before their closest distance, bit i for ray i
+ */
+int intersect(const RayPacket& rays, const Point& vertex, const Vector& edge1, const Vector& edge2,
+              const float* closest, float* distances, float* u, float* v);
\ No newline at end of file
@@ -1,3 +1,10 @@
 #define STB_IMAGE_IMPLEMENTATION
 
+// Decoded pixels and the buffers of the loaders are accounted to images, see MemoryTracker
+#include "MemoryTracker.hpp"
+
+#define STBI_MALLOC(size) MemoryTracker::allocate(MemoryTag::images, size)
+#define STBI_REALLOC(pointer, size) MemoryTracker::reallocate(MemoryTag::images, pointer, size)
+#define STBI_FREE(pointer) MemoryTracker::release(pointer)
+
 #include "stb_image.h"
\ No newline at end of file
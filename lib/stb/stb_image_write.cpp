@@ -1,3 +1,10 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 
+// The buffers of the encoders are accounted to images, see MemoryTracker
+#include "MemoryTracker.hpp"
+
+#define STBIW_MALLOC(size) MemoryTracker::allocate(MemoryTag::images, size)
+#define STBIW_REALLOC(pointer, size) MemoryTracker::reallocate(MemoryTag::images, pointer, size)
+#define STBIW_FREE(pointer) MemoryTracker::release(pointer)
+
 #include "stb_image_write.h"
\ No newline at end of file
@@ -5,15 +5,29 @@
 
 #include "Application.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
 #include <imgui.h>
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_opengl3.h>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
+#include <string_view>
 
+#include "FrameBenchmark.hpp"
 #include "ImageData.hpp"
+#include "MemoryTracker.hpp"
 #include "Mesh.hpp"
+#include "PathTracer.hpp"
+#include "Profiler.hpp"
+#include "RenderStats.hpp"
+#include "maths/frustum.hpp"
+#include "maths/ray.hpp"
 #include "maths/transformations.hpp"
 
 void framebufferSizeCallback(GLFWwindow* /* window */, int width, int height) {
@@ -27,46 +41,74 @@ Point2D getMousePos(GLFWwindow* window) {
     return Point2D{static_cast<float>(xPos), static_cast<float>(yPos)};
 }
 
-Application::Application(const char* title, int width, int height)
-    : isAxisDrawn{true}, isGridDrawn{true}, wireframe{}, cullface{true}, isCursorActive{true},
-      window{}, defaultShader{}, lightShader{},
+Application::Application(const char* title, int width, int height, bool headless)
+    : isAxisDrawn{true}, isGridDrawn{true}, drawPath{DrawPath::instanced}, culling{Culling::hierarchical}, occlusion{true}, wireframe{}, cullface{true}, isCursorActive{true}, headless{headless},
+      window{}, headlessContext{}, framebuffer{},
+      defaultShader{}, defaultInstancedShader{}, defaultIndirectShader{}, lightShader{}, noLightShader{}, frameCapture{}, gpuTimer{}, screenshotCount{}, traceCount{},
+      scene{}, lightNode{}, lightMarker{}, targetNode{}, targetMarker{}, background{0.1f},
       light{Point{10.f, 10.f, 10.f}, White(), White(), White()},
       camera{false}, camera1st{Point{0.0f, 2.0f, 7.5f}}, camera3rd{Point{0.0f, 5.0f, 7.5f}},
       time{}, delta{},
+      pickedObject{}, pickedTriangle{}, frameStats{}, frameTimes(240, 0.0f), frameTimesIndex{}, cpuTime{},
       mousePos{}, oldMousePos{},
       keyFlags{} {
 
-    /* GLFW & GLAD */
-    if(!glfwInit()) {
-        const char* error;
-        glfwGetError(&error);
-        throw std::runtime_error{std::string("Failed to initialize GLFW : ").append(error)};
+    Profiler::setThreadName("Main");
+
+    /* Headless context */
+    if(headless && HeadlessContext::isAvailable()) {
+        try {
+            headlessContext = new HeadlessContext;
+        } catch(const std::runtime_error& error) {
+            std::cout << "LOG : " << error.what() << ", falling back to an invisible window.\n";
+        }
     }
-    std::cout << "LOG : Initialized GLFW.\n";
 
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if(headlessContext) {
+        if(!gladLoadGLLoader((GLADloadproc) HeadlessContext::getProcAddress)) {
+            throw std::runtime_error{"Failed to initialize GLAD"};
+        }
+        std::cout << "LOG : Initialized GLAD.\n";
+    } else {
+        /* GLFW & GLAD */
+        if(!glfwInit()) {
+            const char* error;
+            glfwGetError(&error);
+            throw std::runtime_error{std::string("Failed to initialize GLFW : ").append(error)};
+        }
+        std::cout << "LOG : Initialized GLFW.\n";
 
-    if(!(window = glfwCreateWindow(width, height, title, nullptr, nullptr))) {
-        throw std::runtime_error{"Failed to create window"};
-    }
-    std::cout << "LOG : Created window.\n";
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, headless ? GLFW_FALSE : GLFW_TRUE);
+
+        if(!(window = glfwCreateWindow(width, height, title, nullptr, nullptr))) {
+            throw std::runtime_error{"Failed to create window"};
+        }
+        std::cout << "LOG : Created window.\n";
 
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+        glfwMakeContextCurrent(window);
+        glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
 
-    if(!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
-        throw std::runtime_error{"Failed to initialize GLAD"};
+        if(!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+            throw std::runtime_error{"Failed to initialize GLAD"};
+        }
+        std::cout << "LOG : Initialized GLAD.\n";
     }
-    std::cout << "LOG : Initialized GLAD.\n";
 
-    glViewport(0, 0, width, height);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+    if(headless) {
+        framebuffer = new Framebuffer{width, height};
+        framebuffer->bind();
+        std::cout << "LOG : Created offscreen framebuffer.\n";
+    } else {
+        glViewport(0, 0, width, height);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 
-    // todo: Find a crossplatform way to get the size of the display
-    glfwSetWindowPos(window, (1920 - width) / 2, (1080 - height) / 2);
-    glfwSetCursorPos(window, width / 2.0, height / 2.0);
+        // todo: Find a crossplatform way to get the size of the display
+        glfwSetWindowPos(window, (1920 - width) / 2, (1080 - height) / 2);
+        glfwSetCursorPos(window, width / 2.0, height / 2.0);
+    }
 
     glEnable(GL_CULL_FACE);
     glCullFace(GL_BACK);
@@ -74,74 +116,44 @@ Application::Application(const char* title, int width, int height)
     glEnable(GL_DEPTH_TEST);
 
     /* ImGui */
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    std::cout << "LOG : Created ImGui context.\n";
-
-    ImGui::StyleColorsDark();
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL3_Init("#version 330 core");
-
-    ImGui::GetIO().IniFilename = "lib/imgui/imgui.ini";
+    if(!headless) {
+        IMGUI_CHECKVERSION();
+        ImGui::SetAllocatorFunctions([](std::size_t size, void*) { return MemoryTracker::allocate(MemoryTag::ui, size); },
+                                     [](void* pointer, void*) { MemoryTracker::release(pointer); });
+        ImGui::CreateContext();
+        std::cout << "LOG : Created ImGui context.\n";
+
+        ImGui::StyleColorsDark();
+        ImGui_ImplGlfw_InitForOpenGL(window, true);
+        ImGui_ImplOpenGL3_Init("#version 330 core");
+
+        ImGui::GetIO().IniFilename = "lib/imgui/imgui.ini";
+    }
 
     /* Other things to set up */
     defaultShader = new Shader{"data/shaders/default.vert", "data/shaders/default.frag"};
+    defaultInstancedShader = new Shader{"data/shaders/defaultInstanced.vert", "data/shaders/defaultInstanced.frag"};
+    if(IndirectDraws::isSupported()) {
+        defaultIndirectShader = new Shader{"data/shaders/defaultIndirect.vert", "data/shaders/defaultInstanced.frag"};
+    }
     lightShader = new Shader{"data/shaders/light.vert", "data/shaders/light.frag"};
     noLightShader = new Shader{"data/shaders/noLight.vert", "data/shaders/noLight.frag"};
     std::cout << "LOG : Created shader programs.\n";
-}
 
-Application::~Application() {
-    delete defaultShader;
-    delete lightShader;
-    delete noLightShader;
-    std::cout << "LOG : Deleted shaders.\n";
+    frameCapture = new FrameCapture;
+    gpuTimer = new GpuTimer;
 
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
-    std::cout << "LOG : Terminated ImGui.\n";
+    scene = new Scene{textures};
+    std::cout << "LOG : Created scene.\n";
 
-    glfwDestroyWindow(window);
-    std::cout << "LOG : Destroyed window.\n";
-    glfwTerminate();
-    std::cout << "LOG : Terminated GLFW.\n";
-}
+    lightNode = sceneGraph.add(translate(light.position));
+    lightMarker = sceneGraph.add(scale(0.2f), lightNode);
+    targetNode = sceneGraph.add(translate(camera3rd.target));
+    targetMarker = sceneGraph.add(scale(0.1f), targetNode);
 
-void Application::run() {
-    Texture ceres(ImageData("data/textures/ceres.jpg"));
-//    Texture earth(ImageData("data/textures/earth.jpg"));
-//    Texture earth_clouds(ImageData("data/textures/earth_clouds.jpg"));
-//    Texture earth_night(ImageData("data/textures/earth_night.jpg"));
-//    Texture eris(ImageData("data/textures/eris.jpg"));
-//    Texture haumea(ImageData("data/textures/haumea.jpg"));
-//    Texture jupiter(ImageData("data/textures/jupiter.jpg"));
-//    Texture makemake(ImageData("data/textures/makemake.jpg"));
-//    Texture mars(ImageData("data/textures/mars.jpg"));
-//    Texture mercury(ImageData("data/textures/mercury.jpg"));
-//    Texture moon(ImageData("data/textures/moon.jpg"));
-//    Texture neptune(ImageData("data/textures/neptune.jpg"));
-//    Texture saturn(ImageData("data/textures/saturn.jpg"));
-//    Texture sun(ImageData("data/textures/sun.jpg"));
-//    Texture uranus(ImageData("data/textures/uranus.jpg"));
-//    Texture venus(ImageData("data/textures/venus.jpg"));
-//    Texture texCube(ImageData("data/textures/cube.png"));
-
-    Mesh axis = initAxis(5.0f);
-    Mesh grid = initGrid();
-    Mesh cube = initCube();
-    Mesh disk = initDisk();
-    Mesh cylinder = initCylinder();
-    Mesh sphere = initSphere();
-    Mesh cone = initCone();
-    Mesh torus = initTorus();
-    Mesh klein = initKleinBottle(256, 256);
-    Mesh tube = initTube(Point(-5.0f, 0.0f, 5.0f),
-                         Point(-5.0f, 0.0f, -5.0f),
-                         Point(5.0f, 0.0f, -5.0f),
-                         Point(5.0f, 0.0f, 5.0f));
-
-    RGB background(0.1f);
+    // Unused textures are the only memory that can be given back without losing anything
+    MemoryTracker::setEvictionCallback(MemoryTag::textures, [this](unsigned long long bytes) { textures.release(bytes); },
+                                       MemoryDomain::gpu);
 
     light.ambient = vec4(0.2f, 1.0f);
     light.diffuse = vec4(1.0f);
@@ -151,76 +163,145 @@ void Application::run() {
     diffuse = vec4(1.0f);
     specular = vec4(1.0f);
     shininess = 32.0f;
+}
 
-    while(!glfwWindowShouldClose(window)) {
-        glClearColor(background.r, background.g, background.b, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+Application::~Application() {
+    delete frameCapture;
+    std::cout << "LOG : Deleted frame capture.\n";
 
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+    delete gpuTimer;
 
-        light.position = 5.0f * Point{cosf(time), 1.0f, sinf(time)};
+    delete defaultShader;
+    delete defaultInstancedShader;
+    delete defaultIndirectShader;
+    delete lightShader;
+    delete noLightShader;
+    std::cout << "LOG : Deleted shaders.\n";
 
-        glfwPollEvents();
-        processInputs();
+    MemoryTracker::setEvictionCallback(MemoryTag::textures, nullptr, MemoryDomain::gpu);
 
-        // SHADER FOR OBJECTS NOT INFLUENCED BY LIGHT
-        noLightShader->use();
-        updateUniforms();
+    delete scene;
+    std::cout << "LOG : Deleted scene.\n";
 
-        if(camera) {
-            setModel(translate(camera3rd.target) * scale(0.1f));
-            sphere.draw();
-        }
+    textures.clear();
+    std::cout << "LOG : Deleted textures.\n";
 
-        setModel(Identity());
-        if(isAxisDrawn) { axis.draw(); }
-        if(isGridDrawn) { grid.draw(); }
+    delete framebuffer;
 
-        // SHADER FOR LIGHTS
-        lightShader->use();
-        updateUniforms();
+    if(!headless) {
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+        std::cout << "LOG : Terminated ImGui.\n";
+    }
+
+    if(window) {
+        glfwDestroyWindow(window);
+        std::cout << "LOG : Destroyed window.\n";
+        glfwTerminate();
+        std::cout << "LOG : Terminated GLFW.\n";
+    }
 
-        setModel(translate(light.position) * scale(0.2f));
-        sphere.draw();
+    delete headlessContext;
+}
 
-        // DEFAULT SHADER
-        defaultShader->use();
-        updateUniforms();
+void Application::run() {
+    if(headless) {
+        throw std::runtime_error{"A headless application has no window to run in, use runHeadless"};
+    }
+
+    while(!glfwWindowShouldClose(window)) {
+        Profiler::beginFrame();
+        PROFILE_SCOPE("Frame");
 
-        setModel(Identity());
-        bindTexture(ceres);
-        sphere.draw();
+        gpuTimer->beginFrame();
 
-//        setModel(translate(3.0f, 0.0f, 0.0f) * rotateY(45.0f));
-//        bindTexture(texCube);
-//        cube.draw();
-//
-//        setModel(translate(-3.0f, 0.0f, 0.0f));
-//        bindTexture();
-//        cylinder.draw();
+        const long long frameStart = Profiler::now();
+        frameStats = RenderStats::frame();
+        RenderStats::reset();
+
+        MemoryTracker::enforceBudgets();
+
+        /* Events */ {
+            PROFILE_SCOPE("Events");
+
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+
+            light.position = 5.0f * Point{cosf(time), 1.0f, sinf(time)};
 
-//        setModel(rotateX(90.0f));
-//        bindTexture();
-//        klein.draw();
+            glfwPollEvents();
+            processInputs();
+        }
+
+        drawScene();
 
-//        setModel(Identity());
-//        bindTexture();
-//        tube.draw();
+        /* Frame Capture */ {
+            PROFILE_SCOPE("Frame capture");
+
+            int framebufferWidth, framebufferHeight;
+            glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+            frameCapture->update(framebufferWidth, framebufferHeight);
+        }
 
         /* ImGui Window */ {
+            PROFILE_SCOPE("ImGui");
+
             ImGui::Begin("Controls");
 
+            drawStatistics();
+
             if(ImGui::Button("Toggle Wireframe (W)")) { toggleWireframe(); }
             ImGui::SameLine();
             if(ImGui::Button("Toggle Cullface (C)")) { toggleCullface(); }
             ImGui::SameLine();
             if(ImGui::Button("Toggle Cursor (F1)")) { toggleCursorVisibility(); }
 
+            if(ImGui::Button("Screenshot (F12)")) { takeScreenshot(); }
+            ImGui::SameLine();
+            if(ImGui::Button(frameCapture->isRecording() ? "Stop Recording (F11)" : "Record (F11)")) { toggleRecording(); }
+
             ImGui::Checkbox("Axis (A)", &isAxisDrawn);
             ImGui::SameLine();
             ImGui::Checkbox("Grid (G)", &isGridDrawn);
+
+            int path = static_cast<int>(drawPath);
+            if(ImGui::Combo("Draw Path", &path, "Individual\0Instanced\0Multi-draw indirect\0")) {
+                drawPath = static_cast<DrawPath>(path);
+            }
+            int cullingMode = static_cast<int>(culling);
+            if(ImGui::Combo("Frustum Culling", &cullingMode, "None\0Flat\0Hierarchical\0")) {
+                culling = static_cast<Culling>(cullingMode);
+            }
+            ImGui::Checkbox("Occlusion Culling", &occlusion);
+
+            int objectCount = static_cast<int>(scene->objects.size());
+            if(ImGui::InputInt("Objects", &objectCount, 100, 1000, ImGuiInputTextFlags_EnterReturnsTrue)) {
+                scene->populate(static_cast<unsigned>(std::max(objectCount, 0)));
+                pickedObject.reset();
+            }
+
+            if(pickedObject) {
+                const Scene::Object& object = scene->objects[*pickedObject];
+                Point position{object.model.values[0][3], object.model.values[1][3], object.model.values[2][3]};
+
+                std::vector<unsigned> neighbours;
+                scene->getBVH().query(BoundingSphere{position, 5.0f}, neighbours);
+                ImGui::Text("Picked object %u, triangle %u at (%.2f, %.2f), %.2f units away", *pickedObject,
+                            pickedTriangle.triangle, pickedTriangle.u, pickedTriangle.v, pickedTriangle.distance);
+                ImGui::Text("%zu other objects within 5 units", neighbours.size() - 1);
+
+                if(ImGui::InputFloat3("Picked Position", &position.x)) {
+                    Matrix4 model = object.model;
+                    model.values[0][3] = position.x;
+                    model.values[1][3] = position.y;
+                    model.values[2][3] = position.z;
+                    scene->setModel(*pickedObject, model);
+                }
+            } else {
+                ImGui::Text("Right click an object to pick it");
+            }
             if(camera) {
                 if(ImGui::Button("Camera - Third Person (F5)")) { camera = !camera; }
             } else {
@@ -252,14 +333,587 @@ void Application::run() {
             ImGui::ColorEdit4("Specular", &specular.x);
             ImGui::InputFloat("Shininess", &shininess);
 
+            const TextureCache::Statistics& cacheStatistics = textures.getStatistics();
+            ImGui::Text("Texture Cache :");
+            ImGui::Text("%u textures, %.1f MiB resident, %llu hits, %llu misses, %llu evictions",
+                        cacheStatistics.textureCount, static_cast<double>(cacheStatistics.bytesResident) / (1024.0 * 1024.0),
+                        cacheStatistics.hits, cacheStatistics.misses, cacheStatistics.evictions);
+
+            drawMemory();
+            drawProfiler();
 
             ImGui::End();
+
+            ImGui::Render();
+
+            gpuTimer->begin("ImGui");
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            gpuTimer->end();
+        }
+
+        /* Present */ {
+            PROFILE_SCOPE("Present");
+
+            cpuTime = static_cast<float>(Profiler::now() - frameStart) / 1e6f;
+            glfwSwapBuffers(window);
+        }
+    }
+}
+
+bool Application::runHeadless(const HeadlessSettings& settings) {
+    if(!headless) {
+        throw std::runtime_error{"Only a headless application can run headless"};
+    }
+    if(settings.frames == 0) {
+        throw std::runtime_error{"A headless run needs at least one frame"};
+    }
+
+    // Time only depends on the frame index so that every run renders the exact same frames
+    camera = true;
+    delta = 1.0f / settings.framerate;
+
+    framebuffer->bind();
+
+    // The context still holds the shaders and the textures, which only name what the rasterizer runs and samples.
+    // Instances and indirect draws only live on the GPU, objects are drawn one by one
+    std::unique_ptr<SoftwareRasterizer> rasterizer;
+    std::unique_ptr<ImageData> ceres;
+    if(settings.software) {
+        int viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        rasterizer = std::make_unique<SoftwareRasterizer>(viewport[2], viewport[3]);
+        rasterizer->setProgram(*defaultShader, SoftwareRasterizer::Program::phong);
+        rasterizer->setProgram(*lightShader, SoftwareRasterizer::Program::light);
+        rasterizer->setProgram(*noLightShader, SoftwareRasterizer::Program::noLight);
+
+        ceres = std::make_unique<ImageData>(Scene::ceresPath);
+        rasterizer->setTexture(*scene->ceres, *ceres);
+
+        drawPath = DrawPath::individual;
+    }
+
+    std::optional<ImageData> image;
+    for(unsigned frame = 0 ; frame < settings.frames ; ++frame) {
+        Profiler::beginFrame();
+        PROFILE_SCOPE("Frame");
+
+        gpuTimer->beginFrame();
+        MemoryTracker::enforceBudgets();
+
+        time = static_cast<float>(frame) * delta;
+
+        light.position = 5.0f * Point{cosf(time), 1.0f, sinf(time)};
+
+        if(!settings.path.isEmpty()) {
+            const CameraPath::Keyframe keyframe = settings.path.sample(time);
+            camera3rd.position = keyframe.position;
+            camera3rd.target = keyframe.target;
+        }
+
+        if(rasterizer) {
+            rasterizeScene(*rasterizer);
+            continue;
+        }
+
+        drawScene();
+
+        // The last frame goes through the same ring of pixel buffers and the same writer as interactive captures
+        if(frame + 1 == settings.frames) {
+            frameCapture->capture([&image](ImageData captured) { image.emplace(std::move(captured)); });
+            if(!settings.output.empty()) { frameCapture->screenshot(settings.output); }
+        }
+        frameCapture->update(framebuffer->getWidth(), framebuffer->getHeight());
+    }
+
+    if(rasterizer) {
+        image.emplace(rasterizer->getImage());
+        if(!settings.output.empty()) { image->write(settings.output); }
+    } else {
+        frameCapture->flush();
+    }
+
+    if(!image) {
+        throw std::runtime_error{"The last headless frame was not captured"};
+    }
+
+    std::cout << "LOG : Rendered " << settings.frames << " headless frames"
+              << (rasterizer ? " with the software rasterizer.\n" : ".\n");
+
+    if(settings.golden.empty()) { return true; }
+
+    const float score = psnr(ImageData{settings.golden}, *image);
+    std::cout << "LOG : PSNR against \"" << settings.golden << "\" : " << score << " dB (minimum "
+              << settings.minPsnr << " dB).\n";
+
+    return score >= settings.minPsnr;
+}
+
+void Application::runBenchmark(const BenchmarkSettings& settings) {
+    if(window) { glfwSwapInterval(0); }
+    if(framebuffer) { framebuffer->bind(); }
+
+    drawPath = settings.drawPath;
+    culling = settings.culling;
+    occlusion = settings.occlusion;
+    if(drawPath == DrawPath::indirect && !scene->indirect) {
+        throw std::runtime_error{"Multi-draw indirect is not supported by this context"};
+    }
+
+    scene->populate(settings.objectCount, settings.spheres ? &scene->sphere : nullptr);
+
+    const float orbitRadius = 0.75f * scene->getRadius() + 5.0f;
+    const CameraPath path = !settings.path.isEmpty() ? settings.path
+                          : settings.eyeLevel ? CameraPath::orbit(Point{0.0f, 1.0f, 0.0f}, orbitRadius, 0.0f, 20.0f)
+                          : CameraPath::orbit(Point{}, orbitRadius, 6.0f, 20.0f);
+
+    FrameBenchmark benchmark;
+    benchmark.setProperty("renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    benchmark.setProperty("version", reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    benchmark.setProperty("headless", headless ? "true" : "false");
+    benchmark.setProperty("objects", static_cast<double>(scene->objects.size()));
+    benchmark.setProperty("mesh", settings.spheres ? "sphere" : "mixed");
+    const char* const drawPaths[] = {"individual", "instanced", "indirect"};
+    benchmark.setProperty("drawPath", drawPaths[static_cast<int>(drawPath)]);
+    const char* const cullingModes[] = {"none", "flat", "hierarchical"};
+    benchmark.setProperty("culling", cullingModes[static_cast<int>(culling)]);
+    benchmark.setProperty("occlusion", occlusion ? "true" : "false");
+    benchmark.setProperty("camera", !settings.path.isEmpty() ? "custom" : settings.eyeLevel ? "eye-level" : "orbit");
+    benchmark.setProperty("warmupFrames", settings.warmupFrames);
+
+    int viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    benchmark.setProperty("width", viewport[2]);
+    benchmark.setProperty("height", viewport[3]);
+
+    // Like in headless runs, time only depends on the frame index
+    camera = true;
+    delta = 1.0f / settings.framerate;
+
+    const unsigned frameCount = settings.warmupFrames + settings.frames;
+    for(unsigned frame = 0 ; frame < frameCount && !(window && glfwWindowShouldClose(window)) ; ++frame) {
+        if(frame == settings.warmupFrames) { benchmark.clear(); }
+
+        Profiler::beginFrame();
+        PROFILE_SCOPE("Frame");
+
+        benchmark.beginFrame();
+        RenderStats::reset();
+        MemoryTracker::enforceBudgets();
+
+        // Every frame ends with glFinish, so the timings of the previous frame are always available here
+        gpuTimer->beginFrame();
+        if(frame > settings.warmupFrames) {
+            for(const GpuTimer::Result& result: gpuTimer->getResults()) {
+                benchmark.recordGpu(result.name, result.milliseconds);
+            }
+        }
+
+        if(window) { glfwPollEvents(); }
+        benchmark.endStage("events");
+
+        time = static_cast<float>(frame) * delta;
+        light.position = 5.0f * Point{cosf(time), 1.0f, sinf(time)};
+
+        const CameraPath::Keyframe keyframe = path.sample(time);
+        camera3rd.position = keyframe.position;
+        camera3rd.target = keyframe.target;
+        benchmark.endStage("update");
+
+        drawScene();
+        benchmark.endStage("draw");
+
+        // Waiting for the GPU makes the frame time include the rendering and not only its submission
+        if(window) { glfwSwapBuffers(window); }
+        glFinish();
+        benchmark.endStage("present");
+
+        const RenderStats& stats = RenderStats::frame();
+        benchmark.record("drawCalls", static_cast<double>(stats.drawCalls));
+        benchmark.record("triangles", static_cast<double>(stats.triangles));
+        benchmark.record("stateChanges", static_cast<double>(stats.stateChanges));
+        benchmark.record("uniformUploads", static_cast<double>(stats.uniformUploads));
+        benchmark.record("bufferBytes", static_cast<double>(stats.bufferBytes));
+        benchmark.record("visibleObjects", static_cast<double>(stats.objectsVisible));
+        benchmark.record("culledObjects", static_cast<double>(stats.objectsCulled));
+        benchmark.record("occludedObjects", static_cast<double>(stats.objectsOccluded));
+        benchmark.endFrame();
+    }
+
+    const FrameBenchmark::Summary frameTimes = benchmark.getFrameTimes();
+    std::cout << "LOG : Benchmarked " << benchmark.getFrameCount() << " frames, frame time p50 " << frameTimes.p50
+              << " ms, p95 " << frameTimes.p95 << " ms, p99 " << frameTimes.p99 << " ms.\n";
+
+    if(!settings.output.empty()) { benchmark.write(settings.output); }
+
+    scene->populate(0);
+    pickedObject.reset();
+}
+
+bool Application::runPathTracer(const PathTracerSettings& settings) {
+    if(settings.samples == 0) {
+        throw std::runtime_error{"A path traced image needs at least one sample"};
+    }
+
+    scene->populate(settings.objectCount);
+
+    // Same camera and light as in the frame of the headless run
+    camera = true;
+    time = static_cast<float>(settings.frame) / settings.framerate;
+    light.position = 5.0f * Point{cosf(time), 1.0f, sinf(time)};
+
+    const CameraPath::Keyframe keyframe = settings.path.sample(time);
+    camera3rd.position = keyframe.position;
+    camera3rd.target = keyframe.target;
+
+    sceneGraph.setLocal(lightNode, translate(light.position));
+    sceneGraph.update();
+
+    // The textures of the scene only live on the GPU
+    const ImageData ceres{Scene::ceresPath};
+
+    std::vector<PathTracer::Instance> instances{
+        {&scene->sphere, Identity(), &ceres},
+        {&scene->sphere, sceneGraph.getWorld(lightMarker), nullptr, true}
+    };
+    for(const Scene::Object& object: scene->objects) {
+        instances.push_back({object.mesh, object.model});
+    }
+
+    int viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    PathTracer tracer{viewport[2], viewport[3], settings.bounces};
+    tracer.setScene(instances);
+    tracer.setCamera(getView(), getProjection());
+    tracer.setLighting(light, PathTracer::Material{ambient, diffuse, specular, shininess},
+                       Color{background.r, background.g, background.b, 1.0f});
+
+    const auto start = std::chrono::steady_clock::now();
+    for(unsigned sample = 0 ; sample < settings.samples ; ++sample) {
+        tracer.render();
+    }
+    const float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "LOG : Path traced " << tracer.getSampleCount() << " samples per pixel in " << seconds << " s, "
+              << static_cast<float>(tracer.getRayCount()) / seconds / 1e6f << " million rays per second on "
+              << ThreadPool::global().getThreadCount() << " threads.\n";
+
+    const ImageData image = tracer.getImage();
+    if(!settings.output.empty()) {
+        image.write(settings.output);
+    }
+
+    scene->populate(0);
+
+    if(settings.golden.empty()) { return true; }
+
+    const float score = psnr(ImageData{settings.golden}, image);
+    std::cout << "LOG : PSNR against \"" << settings.golden << "\" : " << score << " dB (minimum "
+              << settings.minPsnr << " dB).\n";
+
+    return score >= settings.minPsnr;
+}
+
+void Application::drawScene() {
+    PROFILE_FUNCTION();
+
+    glClearColor(background.r, background.g, background.b, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    buildRenderQueue();
+
+    RenderQueue::Bindings bindings;
+    bindings.shader = [this](const Shader& shader) { updateUniforms(shader); };
+    bindings.material = [this](const Shader& shader, const Material& material) {
+        // Only the default shaders sample textures
+        if(&shader == lightShader || &shader == noLightShader) { return; }
+        material.texture ? bindTexture(shader, *material.texture) : bindTexture(shader);
+    };
+    bindings.model = [this](const Shader& shader, const Matrix4& model) { setModel(shader, model); };
+
+    const std::pair<RenderPass, const char*> passes[] = {
+        {RenderPass::noLight, "No light pass"},
+        {RenderPass::light, "Light pass"},
+        {RenderPass::opaque, "Default pass"}
+    };
+
+    for(const auto& [pass, name]: passes) {
+        PROFILE_SCOPE(name);
+        gpuTimer->begin(name);
+
+        renderQueue.execute(pass, bindings);
+
+        gpuTimer->end();
+    }
+
+//    setModel(translate(3.0f, 0.0f, 0.0f) * rotateY(45.0f));
+//    bindTexture(*scene->texCube);
+//    scene->cube.draw();
+//
+//    setModel(translate(-3.0f, 0.0f, 0.0f));
+//    bindTexture();
+//    scene->cylinder.draw();
+
+//    setModel(rotateX(90.0f));
+//    bindTexture();
+//    scene->klein.draw();
+
+//    setModel(Identity());
+//    bindTexture();
+//    scene->tube.draw();
+}
+
+void Application::buildRenderQueue() {
+    /* Scene graph */ {
+        PROFILE_SCOPE("Scene graph");
+
+        sceneGraph.setLocal(lightNode, translate(light.position));
+        sceneGraph.setLocal(targetNode, translate(camera3rd.target));
+        sceneGraph.update();
+    }
+
+    const Matrix4 viewProjection = getProjection() * getView();
+    const Point cameraPosition = camera ? camera3rd.position : camera1st.position;
+
+    const Frustum frustum = extractFrustum(viewProjection);
+
+    // The occluders are rendered while the frustum is tested
+    const bool occluding = occlusion && culling != Culling::none;
+    if(occluding) { renderOccluders(frustum, viewProjection, cameraPosition); }
+
+    /* Frustum culling */ {
+        PROFILE_SCOPE("Frustum culling");
+
+        RenderStats& stats = RenderStats::frame();
+        if(culling != Culling::none) {
+            stats.objectsVisible = scene->cull(frustum, culling == Culling::hierarchical,
+                                               occluding ? &occlusionCuller : nullptr);
+        } else {
+            scene->resetVisibility();
+            stats.objectsVisible = scene->objects.size();
+        }
+        stats.objectsCulled = scene->objects.size() - stats.objectsVisible;
+        stats.objectsOccluded = scene->getOccludedCount();
+    }
+
+    /* Render queue */ {
+        PROFILE_SCOPE("Render queue");
+
+        renderQueue.begin(cameraPosition, 100.0f);
+
+        // SHADER FOR OBJECTS NOT INFLUENCED BY LIGHT
+        // The target of the third person camera is only shown to guide the user
+        if(camera && !headless) {
+            renderQueue.submit(RenderPass::noLight, *noLightShader, Material{}, scene->sphere,
+                               sceneGraph.getWorld(targetMarker));
+        }
+
+        if(isAxisDrawn) { renderQueue.submit(RenderPass::noLight, *noLightShader, Material{}, scene->axis, Identity()); }
+        if(isGridDrawn) { renderQueue.submit(RenderPass::noLight, *noLightShader, Material{}, scene->grid, Identity()); }
+
+        // SHADER FOR LIGHTS
+        renderQueue.submit(RenderPass::light, *lightShader, Material{}, scene->sphere, sceneGraph.getWorld(lightMarker));
+
+        // DEFAULT SHADER
+        renderQueue.submit(RenderPass::opaque, *defaultShader, Material{scene->ceres.get()}, scene->sphere, Identity());
+        // Only the draw path in use uploads the visible objects
+        if(drawPath == DrawPath::indirect && scene->indirect) {
+            scene->uploadIndirectDraws();
+            renderQueue.submit(RenderPass::opaque, *defaultIndirectShader, Material{}, *scene->indirect);
+        } else if(drawPath == DrawPath::instanced) {
+            scene->uploadInstances();
+            for(const Scene::Batch& batch: scene->batches) {
+                if(batch.instances->getCount() == 0) { continue; }
+                renderQueue.submit(RenderPass::opaque, *defaultInstancedShader, Material{}, *batch.mesh, *batch.instances);
+            }
+        } else {
+            const std::vector<std::uint8_t>& visibility = scene->getVisibility();
+            for(std::size_t i = 0 ; i < scene->objects.size() ; ++i) {
+                if(!visibility[i]) { continue; }
+
+                const Scene::Object& object = scene->objects[i];
+                renderQueue.submit(RenderPass::opaque, *defaultShader, Material{}, *object.mesh, object.model);
+            }
+        }
+
+        renderQueue.sort();
+    }
+}
+
+void Application::renderOccluders(const Frustum& frustum, const Matrix4& viewProjection, const Point& cameraPosition) {
+    PROFILE_FUNCTION();
+
+    // Only close objects cover enough of the screen to hide others, the textured sphere is always one of them
+    constexpr unsigned maxOccluders = 32;
+    constexpr float maxDistance = 20.0f;
+
+    occlusionCuller.begin(viewProjection);
+    occlusionCuller.addOccluder(scene->sphere, Identity());
+
+    std::vector<unsigned> occluders;
+    scene->findOccluders(frustum, cameraPosition, maxOccluders, maxDistance, occluders);
+    for(unsigned object: occluders) {
+        occlusionCuller.addOccluder(*scene->objects[object].mesh, scene->objects[object].model);
+    }
+
+    occlusionCuller.render();
+}
+
+void Application::rasterizeScene(SoftwareRasterizer& rasterizer) {
+    PROFILE_FUNCTION();
+
+    buildRenderQueue();
+
+    rasterizer.setCamera(getView(), getProjection(), camera ? camera3rd.position : camera1st.position);
+    rasterizer.setLighting(light, SoftwareRasterizer::PhongMaterial{ambient, diffuse, specular, shininess});
+    rasterizer.setCulling(cullface);
+    rasterizer.begin(Color{background.r, background.g, background.b, 1.0f});
+
+    for(const RenderPass pass: {RenderPass::noLight, RenderPass::light, RenderPass::opaque}) {
+        renderQueue.execute(pass, rasterizer);
+    }
+
+    rasterizer.finish();
+}
+
+void Application::drawStatistics() {
+    frameTimes[frameTimesIndex] = delta * 1000.0f;
+    frameTimesIndex = (frameTimesIndex + 1) % frameTimes.size();
+
+    const float maxFrameTime = *std::max_element(frameTimes.begin(), frameTimes.end());
+
+    ImGui::Text("%.1f FPS, %.2f ms per frame", delta > 0.0f ? 1.0f / delta : 0.0f, delta * 1000.0f);
+    ImGui::PlotLines("##Frame Times", frameTimes.data(), static_cast<int>(frameTimes.size()), static_cast<int>(frameTimesIndex),
+                     nullptr, 0.0f, std::max(maxFrameTime * 1.2f, 1.0f), ImVec2{-1.0f, 60.0f});
+
+    const float gpuTime = static_cast<float>(gpuTimer->getTotal());
+    ImGui::Text("CPU %.2f ms, GPU %.2f ms (%s bound)", cpuTime, gpuTime, cpuTime >= gpuTime ? "CPU" : "GPU");
+    for(const GpuTimer::Result& result: gpuTimer->getResults()) {
+        ImGui::BulletText("%s : %.3f ms", result.name, result.milliseconds);
+    }
+
+    ImGui::Text("%llu draw calls, %llu triangles", frameStats.drawCalls, frameStats.triangles);
+    ImGui::Text("%llu state changes, %llu uniform uploads", frameStats.stateChanges, frameStats.uniformUploads);
+    ImGui::Text("%llu objects visible, %llu culled (%llu occluded)", frameStats.objectsVisible, frameStats.objectsCulled,
+                frameStats.objectsOccluded);
+    ImGui::Text("%.1f KiB uploaded to buffers, %.1f MiB of textures resident",
+                static_cast<double>(frameStats.bufferBytes) / 1024.0,
+                static_cast<double>(Texture::getResidentBytes()) / (1024.0 * 1024.0));
+
+    ImGui::Separator();
+}
+
+void Application::drawMemory() {
+    if(!ImGui::CollapsingHeader("Memory")) { return; }
+
+    constexpr double MiB = 1024.0 * 1024.0;
+
+    if(ImGui::BeginTable("Memory Usage", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("Tag");
+        ImGui::TableSetupColumn("CPU (MiB)");
+        ImGui::TableSetupColumn("CPU peak");
+        ImGui::TableSetupColumn("GPU (MiB)");
+        ImGui::TableSetupColumn("GPU peak");
+        ImGui::TableSetupColumn("GPU budget");
+        ImGui::TableHeadersRow();
+
+        for(unsigned i = 0 ; i < static_cast<unsigned>(MemoryTag::count) ; ++i) {
+            const MemoryTag tag = static_cast<MemoryTag>(i);
+            const MemoryTracker::Usage cpu = MemoryTracker::getUsage(tag);
+            const MemoryTracker::Usage gpu = MemoryTracker::getUsage(tag, MemoryDomain::gpu);
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", MemoryTracker::getName(tag));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", static_cast<double>(cpu.current) / MiB);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", static_cast<double>(cpu.peak) / MiB);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", static_cast<double>(gpu.current) / MiB);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", static_cast<double>(gpu.peak) / MiB);
+
+            // In MiB, 0 meaning no budget
+            ImGui::TableNextColumn();
+            unsigned budget = static_cast<unsigned>(static_cast<double>(gpu.budget) / MiB);
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::SetNextItemWidth(-1.0f);
+            if(ImGui::InputScalar("##Budget", ImGuiDataType_U32, &budget)) {
+                MemoryTracker::setBudget(tag, static_cast<unsigned long long>(budget * MiB), MemoryDomain::gpu);
+            }
+            ImGui::PopID();
         }
 
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        glfwSwapBuffers(window);
+        ImGui::EndTable();
     }
+
+    ImGui::Text("Total : %.1f MiB of main memory, %.1f MiB of video memory",
+                static_cast<double>(MemoryTracker::getTotal()) / MiB,
+                static_cast<double>(MemoryTracker::getTotal(MemoryDomain::gpu)) / MiB);
+}
+
+void Application::drawProfiler() {
+    if(!ImGui::CollapsingHeader("Profiler")) { return; }
+
+    bool enabled = Profiler::isEnabled();
+    if(ImGui::Checkbox("Profile", &enabled)) { Profiler::setEnabled(enabled); }
+    ImGui::SameLine();
+    if(ImGui::Button("Export Chrome Trace")) { exportTrace(); }
+
+    long long start, end;
+    const std::vector<Profiler::Event> events = Profiler::getLastFrame(start, end);
+    if(events.empty()) {
+        ImGui::Text("No scope was recorded during the last frame.");
+        return;
+    }
+
+    const double duration = static_cast<double>(end - start);
+    ImGui::Text("Last frame : %.3f ms", duration / 1e6);
+
+    unsigned maxDepth = 0;
+    for(const Profiler::Event& event: events) { maxDepth = std::max(maxDepth, event.depth); }
+
+    /* Flame View */ {
+        constexpr float rowHeight = 20.0f;
+
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float width = ImGui::GetContentRegionAvail().x;
+        ImGui::Dummy(ImVec2{width, rowHeight * static_cast<float>(maxDepth + 1)});
+
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+
+        for(const Profiler::Event& event: events) {
+            const float x0 = origin.x + width * static_cast<float>(static_cast<double>(event.start - start) / duration);
+            const float x1 = std::max(x0 + 1.0f,
+                                      origin.x + width * static_cast<float>(static_cast<double>(event.end - start) / duration));
+            const float y0 = origin.y + rowHeight * static_cast<float>(event.depth);
+            const float y1 = y0 + rowHeight - 1.0f;
+
+            // Colors only depend on the name so that scopes keep their color from one frame to the next
+            const std::size_t hash = std::hash<std::string_view>{}(event.name);
+            const ImU32 color = IM_COL32(60 + hash % 140, 60 + (hash >> 8) % 140, 60 + (hash >> 16) % 140, 255);
+            drawList->AddRectFilled(ImVec2{x0, y0}, ImVec2{x1, y1}, color);
+
+            if(x1 - x0 > ImGui::CalcTextSize(event.name).x + 4.0f) {
+                drawList->AddText(ImVec2{x0 + 2.0f, y0 + 2.0f}, IM_COL32_WHITE, event.name);
+            }
+
+            if(mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y1) {
+                ImGui::SetTooltip("%s : %.3f ms", event.name, static_cast<double>(event.end - event.start) / 1e6);
+            }
+        }
+    }
+}
+
+void Application::exportTrace() {
+    std::filesystem::create_directories("traces");
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "trace_%03u.json", traceCount++);
+    Profiler::writeChromeTrace(std::string("traces/") + name);
 }
 
 void Application::processInputs() {
@@ -278,84 +932,83 @@ void Application::processInputs() {
     if(getKey(GLFW_KEY_F1)) { toggleCursorVisibility(); }
     releaseKey(GLFW_KEY_F1);
 
+    if(getKey(GLFW_KEY_F11)) { toggleRecording(); }
+    releaseKey(GLFW_KEY_F11);
+
+    if(getKey(GLFW_KEY_F12)) { takeScreenshot(); }
+    releaseKey(GLFW_KEY_F12);
+
     toggleFlag(GLFW_KEY_F5, camera);
     toggleFlag(GLFW_KEY_G, isGridDrawn);
     toggleFlag(GLFW_KEY_Q, isAxisDrawn);
 
+    if(isCursorActive && glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS
+       && !ImGui::GetIO().WantCaptureMouse) {
+        pickObject();
+    }
+
     if(!isCursorActive) { camera ? processThirdPersonInputs() : processFirstPersonInputs(); }
 
     oldMousePos = mousePos;
 }
 
-void Application::bindTexture(const Texture& texture) const {
+void Application::bindTexture(const Shader& shader, const Texture& texture) const {
     texture.bind();
-    defaultShader->setUniform("u_hasTexture", texture.getId() != 0);
+    shader.setUniform("u_hasTexture", texture.getId() != 0);
 }
 
-void Application::setModel(const Matrix4& model) {
-    int id;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &id);
+void Application::setModel(const Shader& shader, const Matrix4& model) {
+    shader.setUniform("u_model", model);
 
-    if(id == defaultShader->id) {
-        defaultShader->setUniform("u_model", model);
-        defaultShader->setUniform("u_model_inverse", transpose(inverse(model)));
-    } else if(id == lightShader->id) {
-        lightShader->setUniform("u_model", model);
-    } else if(id == noLightShader->id) {
-        noLightShader->setUniform("u_model", model);
+    if(&shader == defaultShader) {
+        shader.setUniform("u_model_inverse", transpose(inverse(model)));
     }
 }
 
-void Application::updateUniforms() const {
-    Matrix4 view;
-    Point camPos;
+void Application::updateUniforms(const Shader& shader) const {
+    const Point camPos = camera ? camera3rd.position : camera1st.position;
 
-    if(camera) {
-        view = camera3rd.getLookAt();
-        camPos = camera3rd.position;
-    } else {
-        view = camera1st.getLookAt();
-        camPos = camera1st.position;
-    }
+    shader.setUniform("u_view", getView());
+    shader.setUniform("u_projection", getProjection());
 
-    int width, height;
-    glfwGetWindowSize(window, &width, &height);
-    Matrix4 projection = perspective(quarter_pi(), static_cast<float>(width) / static_cast<float>(height), 0.1f, 100.0f);
+    if(&shader == lightShader) {
+        shader.setUniform("u_lightColor", light.diffuse);
+    } else if(&shader != noLightShader) {
+        shader.setUniform("u_cameraPosition", camPos);
 
-    int id;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &id);
+        shader.setUniform("u_light.position", light.position);
+        shader.setUniform("u_light.ambient", light.ambient);
+        shader.setUniform("u_light.diffuse", light.diffuse);
+        shader.setUniform("u_light.specular", light.specular);
+
+        shader.setUniform("u_material.ambient", ambient);
+        shader.setUniform("u_material.diffuse", diffuse);
+        shader.setUniform("u_material.specular", specular);
+        shader.setUniform("u_material.shininess", shininess);
+    }
+}
 
-    if(id == defaultShader->id) {
-        defaultShader->setUniform("u_view", view);
-        defaultShader->setUniform("u_projection", projection);
-        defaultShader->setUniform("u_cameraPosition", camPos);
+Matrix4 Application::getView() const {
+    return camera ? camera3rd.getLookAt() : camera1st.getLookAt();
+}
 
-        defaultShader->setUniform("u_light.position", light.position);
-        defaultShader->setUniform("u_light.ambient", light.ambient);
-        defaultShader->setUniform("u_light.diffuse", light.diffuse);
-        defaultShader->setUniform("u_light.specular", light.specular);
+Matrix4 Application::getProjection() const {
+    // The viewport follows the window through the framebuffer size callback, or the offscreen framebuffer
+    int viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
 
-        defaultShader->setUniform("u_material.ambient", ambient);
-        defaultShader->setUniform("u_material.diffuse", diffuse);
-        defaultShader->setUniform("u_material.specular", specular);
-        defaultShader->setUniform("u_material.shininess", shininess);
-    } else if(id == lightShader->id) {
-        lightShader->setUniform("u_view", view);
-        lightShader->setUniform("u_projection", projection);
-        lightShader->setUniform("u_lightColor", light.diffuse);
-    } else if(id == noLightShader->id) {
-        noLightShader->setUniform("u_view", view);
-        noLightShader->setUniform("u_projection", projection);
-    }
+    return perspective(quarter_pi(), static_cast<float>(viewport[2]) / static_cast<float>(viewport[3]), 0.1f, 100.0f);
 }
 
 void Application::toggleWireframe() {
     glPolygonMode(GL_FRONT_AND_BACK, wireframe ? GL_FILL : GL_LINE);
+    ++RenderStats::frame().stateChanges;
     wireframe = !wireframe;
 }
 
 void Application::toggleCullface() {
     cullface ? glDisable(GL_CULL_FACE) : glEnable(GL_CULL_FACE);
+    ++RenderStats::frame().stateChanges;
     cullface = !cullface;
 }
 
@@ -364,6 +1017,24 @@ void Application::toggleCursorVisibility() {
     isCursorActive = !isCursorActive;
 }
 
+void Application::takeScreenshot() {
+    std::filesystem::create_directories("screenshots");
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "screenshot_%03u.png", screenshotCount++);
+    frameCapture->screenshot(std::string("screenshots/") + name);
+}
+
+void Application::toggleRecording() {
+    if(frameCapture->isRecording()) {
+        frameCapture->stopSequence();
+        std::cout << "LOG : Stopped recording.\n";
+    } else {
+        frameCapture->startSequence("captures");
+        std::cout << "LOG : Started recording to \"captures\".\n";
+    }
+}
+
 void Application::processFirstPersonInputs() {
     if(glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) { camera1st.processKeyboardInputs(CameraControls::forward, delta); }
     if(glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) { camera1st.processKeyboardInputs(CameraControls::backward, delta); }
@@ -384,6 +1055,36 @@ void Application::processThirdPersonInputs() {
     camera3rd.processMouseInputs(mousePos.x - oldMousePos.x, oldMousePos.y - mousePos.y);
 }
 
+void Application::pickObject() {
+    int width, height;
+    glfwGetWindowSize(window, &width, &height);
+    if(width == 0 || height == 0) { return; }
+
+    const float x = 2.0f * mousePos.x / static_cast<float>(width) - 1.0f;
+    const float y = 1.0f - 2.0f * mousePos.y / static_cast<float>(height);
+
+    const Ray ray = screenRay(getProjection() * getView(), x, y);
+
+    // The boxes of the objects only narrow the search down, the ray is cast against the triangles of their mesh in
+    // model space, where distances are the same as long as the direction is not normalized again
+    float closest = std::numeric_limits<float>::infinity();
+    const std::optional<SceneBVH::Hit> hit = scene->getBVH().raycast(ray, [&](unsigned object) {
+        const Scene::Object& candidate = scene->objects[object];
+        const Matrix4 toModel = inverse(candidate.model);
+        const vec4 direction = toModel * vec4{ray.direction.x, ray.direction.y, ray.direction.z, 0.0f};
+
+        const Ray modelRay{toModel * ray.origin, Vector{direction.x, direction.y, direction.z}};
+        const std::optional<MeshBVH::Hit> triangle = candidate.mesh->getBVH().raycast(modelRay, closest);
+        if(!triangle) { return std::numeric_limits<float>::infinity(); }
+
+        closest = triangle->distance;
+        pickedTriangle = *triangle;
+        return triangle->distance;
+    });
+
+    pickedObject = hit ? std::optional<unsigned>{hit->object} : std::nullopt;
+}
+
 bool Application::getKey(int key) {
     if(!keyFlags.contains(key)) {
         keyFlags.emplace(key, false);
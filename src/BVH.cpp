@@ -0,0 +1,208 @@
+/******************************************************************************************************
+ * @file  BVH.cpp
+ * @brief Implementation of the bounding volume hierarchy builder
+ ******************************************************************************************************/
+
+#include "BVH.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "Profiler.hpp"
+
+namespace {
+    constexpr unsigned binCount = 16;
+
+    // Cost of visiting a node relative to testing a primitive
+    constexpr float traversalCost = 1.0f;
+
+    float axis(const Point& point, int index) {
+        return index == 0 ? point.x : index == 1 ? point.y : point.z;
+    }
+
+    /**
+     * @brief Boxes of the primitives whose centroid falls in a bin
+     */
+    struct Bin {
+        AABB box;
+        unsigned count;
+    };
+
+    class Builder {
+    public:
+        Builder(const std::vector<AABB>& boxes, unsigned maxLeafSize, BVH& bvh)
+            : boxes{boxes}, maxLeafSize{maxLeafSize}, nodes{bvh.nodes}, parents{bvh.parents}, order{bvh.order},
+              centroids(boxes.size()), bins(3 * binCount), rightBins(binCount) {
+
+            for(std::size_t i = 0 ; i < boxes.size() ; ++i) { centroids[i] = boxes[i].center(); }
+        }
+
+        /**
+         * @brief Splits the primitives of the leaf at the best plane found by binning their centroids
+         * @return Whether the node was split
+         */
+        bool split(unsigned node) {
+            const unsigned first = nodes[node].first;
+            const unsigned count = nodes[node].count;
+            if(count <= 1) { return false; }
+
+            AABB bounds = AABB::empty();
+            for(unsigned i = first ; i < first + count ; ++i) {
+                bounds.extend(centroids[order[i]]);
+            }
+
+            // Bins of the centroids along each axis, small nodes use fewer of them since setting them up costs more
+            // than binning their primitives
+            const unsigned used = std::min(binCount, count);
+            const AABB empty = AABB::empty();
+
+            float scales[3];
+            for(int a = 0 ; a < 3 ; ++a) {
+                const float size = axis(bounds.max, a) - axis(bounds.min, a);
+                scales[a] = size > 0.0f ? static_cast<float>(used) / size : 0.0f;
+
+                for(unsigned b = 0 ; b < used ; ++b) { bins[a * binCount + b] = Bin{empty, 0}; }
+            }
+
+            const auto binOf = [&](const Point& centroid, int a) {
+                const float position = (axis(centroid, a) - axis(bounds.min, a)) * scales[a];
+                return std::min(static_cast<unsigned>(position), used - 1);
+            };
+
+            for(unsigned i = first ; i < first + count ; ++i) {
+                const AABB& box = boxes[order[i]];
+                const Point& centroid = centroids[order[i]];
+
+                for(int a = 0 ; a < 3 ; ++a) {
+                    Bin& bin = bins[a * binCount + binOf(centroid, a)];
+                    bin.box.extend(box);
+                    ++bin.count;
+                }
+            }
+
+            // Sweeping the bins from both ends gives the cost of splitting after each of them
+            float bestCost = std::numeric_limits<float>::infinity();
+            int bestAxis = -1;
+            unsigned bestSplit = 0;
+            AABB bestLeft, bestRight;
+
+            for(int a = 0 ; a < 3 ; ++a) {
+                if(scales[a] == 0.0f) { continue; }
+
+                const Bin* axisBins = &bins[a * binCount];
+
+                // Bin b of the scratch receives the box and the cost of the objects in the bins after b
+                AABB right = empty;
+                unsigned rightCount = 0;
+                for(unsigned b = used - 1 ; b > 0 ; --b) {
+                    if(axisBins[b].count > 0) { right.extend(axisBins[b].box); }
+                    rightCount += axisBins[b].count;
+                    rightBins[b - 1] = Bin{right, rightCount};
+                }
+
+                AABB left = empty;
+                unsigned leftCount = 0;
+                for(unsigned b = 0 ; b < used - 1 ; ++b) {
+                    if(axisBins[b].count > 0) { left.extend(axisBins[b].box); }
+                    leftCount += axisBins[b].count;
+                    if(leftCount == 0 || leftCount == count) { continue; }
+
+                    const float cost = left.surfaceArea() * static_cast<float>(leftCount)
+                                     + rightBins[b].box.surfaceArea() * static_cast<float>(rightBins[b].count);
+                    if(cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = a;
+                        bestSplit = b;
+                        bestLeft = left;
+                        bestRight = rightBins[b].box;
+                    }
+                }
+            }
+
+            // Every centroid is at the same place, the primitives cannot be told apart
+            if(bestAxis < 0) { return false; }
+
+            const float leafCost = static_cast<float>(count);
+            const float splitCost = traversalCost + bestCost / nodes[node].box.surfaceArea();
+            if(splitCost >= leafCost && count <= maxLeafSize) { return false; }
+
+            const auto middle = std::partition(order.begin() + first, order.begin() + first + count, [&](unsigned object) {
+                return binOf(centroids[object], bestAxis) <= bestSplit;
+            });
+            const unsigned leftCount = static_cast<unsigned>(middle - order.begin()) - first;
+
+            const unsigned child = static_cast<unsigned>(nodes.size());
+            nodes.push_back(BVHNode{bestLeft, first, leftCount});
+            nodes.push_back(BVHNode{bestRight, first + leftCount, count - leftCount});
+            parents.push_back(node);
+            parents.push_back(node);
+
+            nodes[node].first = child;
+            nodes[node].count = 0;
+
+            return true;
+        }
+
+    private:
+        const std::vector<AABB>& boxes;
+        const unsigned maxLeafSize;
+
+        std::vector<BVHNode>& nodes;
+        std::vector<unsigned>& parents;
+        std::vector<unsigned>& order;
+
+        // Kept between splits since constructing them for every node costs more than splitting the smallest ones
+        std::vector<Point> centroids;
+        std::vector<Bin> bins; // binCount per axis
+        std::vector<Bin> rightBins;
+    };
+}
+
+BVH buildBVH(const std::vector<AABB>& boxes, unsigned maxLeafSize) {
+    PROFILE_FUNCTION();
+
+    BVH bvh;
+    const unsigned count = static_cast<unsigned>(boxes.size());
+
+    bvh.order.resize(count);
+    std::iota(bvh.order.begin(), bvh.order.end(), 0u);
+
+    if(count == 0) { return bvh; }
+
+    // A binary tree with at least one primitive per leaf has at most 2n - 1 nodes
+    bvh.nodes.reserve(2 * count - 1);
+    bvh.parents.reserve(2 * count - 1);
+
+    AABB root = AABB::empty();
+    for(const AABB& box: boxes) { root.extend(box); }
+
+    bvh.nodes.push_back(BVHNode{root, 0, count});
+    bvh.parents.push_back(0);
+
+    Builder builder{boxes, maxLeafSize, bvh};
+
+    std::vector<unsigned> stack{0};
+    while(!stack.empty()) {
+        const unsigned node = stack.back();
+        stack.pop_back();
+
+        if(builder.split(node)) {
+            stack.push_back(bvh.nodes[node].first);
+            stack.push_back(bvh.nodes[node].first + 1);
+        }
+    }
+
+    return bvh;
+}
+
+float surfaceAreaCost(const std::vector<BVHNode>& nodes) {
+    if(nodes.empty() || nodes[0].box.surfaceArea() <= 0.0f) { return 0.0f; }
+
+    float cost = 0.0f;
+    for(const BVHNode& node: nodes) {
+        cost += node.box.surfaceArea() * (node.count == 0 ? traversalCost : static_cast<float>(node.count));
+    }
+
+    return cost / nodes[0].box.surfaceArea();
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+/******************************************************************************************************
+ * @file  CameraPath.cpp
+ * @brief Implementation of the CameraPath class
+ ******************************************************************************************************/
+
+#include "CameraPath.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "maths/constants.hpp"
+
+namespace {
+    Point catmullRom(const Point& P0, const Point& P1, const Point& P2, const Point& P3, float t) {
+        const float t2 = t * t;
+        const float t3 = t2 * t;
+
+        return 0.5f * ((2.0f * P1) + (P2 - P0) * t + (2.0f * P0 - 5.0f * P1 + 4.0f * P2 - P3) * t2
+                       + (3.0f * P1 - P0 - 3.0f * P2 + P3) * t3);
+    }
+}
+
+CameraPath::CameraPath(bool loop) : loop{loop} { }
+
+void CameraPath::add(float time, const Point& position, const Point& target) {
+    if(!keyframes.empty() && time <= keyframes.back().time) {
+        throw std::invalid_argument{"Camera path keyframes must be added in chronological order."};
+    }
+
+    keyframes.push_back(Keyframe{time, position, target});
+}
+
+CameraPath::Keyframe CameraPath::sample(float time) const {
+    if(keyframes.empty()) {
+        throw std::runtime_error{"Cannot sample an empty camera path."};
+    }
+
+    const int count = static_cast<int>(keyframes.size());
+    if(count == 1) { return keyframes.front(); }
+
+    const float start = keyframes.front().time;
+    const float duration = getDuration();
+
+    if(loop) {
+        time = start + std::fmod(std::fmod(time - start, duration) + duration, duration);
+    } else {
+        time = std::clamp(time, start, keyframes.back().time);
+    }
+
+    int i = 0;
+    while(i < count - 2 && keyframes[i + 1].time <= time) { ++i; }
+
+    // Looping paths end on their first keyframe, so neighbours wrap around without repeating it
+    auto at = [&](int index) -> const Keyframe& {
+        if(loop) {
+            const int period = count - 1;
+            return keyframes[(index % period + period) % period];
+        }
+
+        return keyframes[std::clamp(index, 0, count - 1)];
+    };
+
+    const Keyframe& K1 = keyframes[i];
+    const Keyframe& K2 = keyframes[i + 1];
+    const float t = (time - K1.time) / (K2.time - K1.time);
+
+    return Keyframe{
+        time,
+        catmullRom(at(i - 1).position, K1.position, K2.position, at(i + 2).position, t),
+        catmullRom(at(i - 1).target, K1.target, K2.target, at(i + 2).target, t)
+    };
+}
+
+float CameraPath::getDuration() const {
+    if(keyframes.size() < 2) { return 0.0f; }
+    return keyframes.back().time - keyframes.front().time;
+}
+
+bool CameraPath::isEmpty() const {
+    return keyframes.empty();
+}
+
+CameraPath CameraPath::orbit(const Point& center, float radius, float height, float duration, unsigned keyframes) {
+    CameraPath path{true};
+
+    // The last keyframe is the first one again so that the loop closes smoothly
+    for(unsigned i = 0 ; i <= keyframes ; ++i) {
+        const float angle = two_pi() * static_cast<float>(i) / static_cast<float>(keyframes);
+        const Point position = center + Point{radius * cosf(angle), height, radius * sinf(angle)};
+
+        path.add(duration * static_cast<float>(i) / static_cast<float>(keyframes), position, center);
+    }
+
+    return path;
+}
\ No newline at end of file
@@ -0,0 +1,497 @@
+/******************************************************************************************************
+ * @file  CompressedImage.cpp
+ * @brief Implementation of the CompressedImage class
+ ******************************************************************************************************/
+
+#include "CompressedImage.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "MipChain.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+    constexpr char magic[4] = {'G', 'T', 'E', 'X'};
+    constexpr std::uint32_t version = 1;
+
+    // Limits of a valid file, a 65536x65536 image has 17 levels
+    constexpr std::uint32_t maxSize = 1 << 16;
+    constexpr std::uint32_t maxLevels = 32;
+
+    /**
+     * @brief Gathers a 4x4 block of RGBA pixels, clamping at the borders of the image
+     */
+    void fetchBlock(const ImageData& image, int blockX, int blockY, unsigned char block[64]) {
+        const int width = image.getWidth();
+        const int height = image.getHeight();
+        const int channels = image.getColorChannels();
+        const unsigned char* data = image.getData();
+
+        for(int y = 0 ; y < 4 ; ++y) {
+            const int j = std::min(blockY * 4 + y, height - 1);
+
+            for(int x = 0 ; x < 4 ; ++x) {
+                const int i = std::min(blockX * 4 + x, width - 1);
+                const unsigned char* pixel = data + (j * width + i) * channels;
+                unsigned char* texel = block + (y * 4 + x) * 4;
+
+                if(channels >= 3) {
+                    texel[0] = pixel[0];
+                    texel[1] = pixel[1];
+                    texel[2] = pixel[2];
+                } else {
+                    texel[0] = texel[1] = texel[2] = pixel[0];
+                }
+
+                texel[3] = (channels == 4) ? pixel[3] : (channels == 2) ? pixel[1] : 255;
+            }
+        }
+    }
+
+    /**
+     * @brief Computes the per channel minimum and maximum of a block
+     */
+    void blockBounds(const unsigned char block[64], unsigned char min[4], unsigned char max[4]) {
+#ifdef __SSE2__
+        const __m128i* rows = reinterpret_cast<const __m128i*>(block);
+
+        __m128i low = _mm_min_epu8(_mm_min_epu8(_mm_loadu_si128(rows), _mm_loadu_si128(rows + 1)),
+                                   _mm_min_epu8(_mm_loadu_si128(rows + 2), _mm_loadu_si128(rows + 3)));
+        __m128i high = _mm_max_epu8(_mm_max_epu8(_mm_loadu_si128(rows), _mm_loadu_si128(rows + 1)),
+                                    _mm_max_epu8(_mm_loadu_si128(rows + 2), _mm_loadu_si128(rows + 3)));
+
+        // Reduce the 4 pixels left in each register
+        low = _mm_min_epu8(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(1, 0, 3, 2)));
+        low = _mm_min_epu8(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+        high = _mm_max_epu8(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(1, 0, 3, 2)));
+        high = _mm_max_epu8(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        const int minimum = _mm_cvtsi128_si32(low);
+        const int maximum = _mm_cvtsi128_si32(high);
+        std::memcpy(min, &minimum, 4);
+        std::memcpy(max, &maximum, 4);
+#else
+        for(int c = 0 ; c < 4 ; ++c) {
+            min[c] = 255;
+            max[c] = 0;
+        }
+
+        for(int i = 0 ; i < 16 ; ++i) {
+            for(int c = 0 ; c < 4 ; ++c) {
+                min[c] = std::min(min[c], block[i * 4 + c]);
+                max[c] = std::max(max[c], block[i * 4 + c]);
+            }
+        }
+#endif
+    }
+
+    std::uint16_t to565(const int color[3]) {
+        const int r = (color[0] * 31 + 127) / 255;
+        const int g = (color[1] * 63 + 127) / 255;
+        const int b = (color[2] * 31 + 127) / 255;
+
+        return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void from565(std::uint16_t color, int rgb[3]) {
+        const int r = (color >> 11) & 31;
+        const int g = (color >> 5) & 63;
+        const int b = color & 31;
+
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    void colorPalette(std::uint16_t color0, std::uint16_t color1, bool fourColors, int palette[4][3]) {
+        from565(color0, palette[0]);
+        from565(color1, palette[1]);
+
+        for(int c = 0 ; c < 3 ; ++c) {
+            if(fourColors) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            } else {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Encodes the colors of a block in the 8 bytes BC1 layout, always using the 4 colors mode
+     */
+    void encodeColorBlock(const unsigned char block[64], unsigned char* output) {
+        unsigned char min[4], max[4];
+        blockBounds(block, min, max);
+
+        int low[3], high[3];
+        for(int c = 0 ; c < 3 ; ++c) {
+            // Inset the bounding box a bit since its corners are rarely the best endpoints
+            const int inset = (max[c] - min[c]) >> 4;
+            low[c] = min[c] + inset;
+            high[c] = max[c] - inset;
+        }
+
+        // The bounding box diagonal only follows the colors if the channels are positively correlated
+        int mean[3] = {};
+        for(int i = 0 ; i < 16 ; ++i) {
+            for(int c = 0 ; c < 3 ; ++c) { mean[c] += block[i * 4 + c]; }
+        }
+        for(int& m: mean) { m /= 16; }
+
+        int widest = 0;
+        for(int c = 1 ; c < 3 ; ++c) {
+            if(max[c] - min[c] > max[widest] - min[widest]) { widest = c; }
+        }
+
+        for(int c = 0 ; c < 3 ; ++c) {
+            if(c == widest) { continue; }
+
+            int covariance = 0;
+            for(int i = 0 ; i < 16 ; ++i) {
+                covariance += (block[i * 4 + widest] - mean[widest]) * (block[i * 4 + c] - mean[c]);
+            }
+
+            if(covariance < 0) { std::swap(low[c], high[c]); }
+        }
+
+        std::uint16_t color0 = to565(high);
+        std::uint16_t color1 = to565(low);
+        std::uint32_t indices = 0;
+
+        if(color0 != color1) {
+            // Color 0 has to be the greater one for the block to be decoded in 4 colors mode
+            const bool swapped = color0 < color1;
+            if(swapped) { std::swap(color0, color1); }
+
+            int palette[4][3];
+            colorPalette(color0, color1, true, palette);
+
+            for(int i = 0 ; i < 16 ; ++i) {
+                int best = 0;
+                int bestDistance = 1 << 30;
+
+                for(int p = 0 ; p < 4 ; ++p) {
+                    int distance = 0;
+                    for(int c = 0 ; c < 3 ; ++c) {
+                        const int difference = block[i * 4 + c] - palette[p][c];
+                        distance += difference * difference;
+                    }
+
+                    if(distance < bestDistance) {
+                        bestDistance = distance;
+                        best = p;
+                    }
+                }
+
+                indices |= static_cast<std::uint32_t>(best) << (2 * i);
+            }
+        }
+
+        std::memcpy(output, &color0, 2);
+        std::memcpy(output + 2, &color1, 2);
+        std::memcpy(output + 4, &indices, 4);
+    }
+
+    /**
+     * @brief Encodes the alpha of a block in the 8 bytes BC3 alpha layout, using the 8 values mode
+     */
+    void encodeAlphaBlock(const unsigned char block[64], unsigned char* output) {
+        unsigned char min[4], max[4];
+        blockBounds(block, min, max);
+
+        const int inset = (max[3] - min[3]) >> 5;
+        const int alpha0 = max[3] - inset;
+        const int alpha1 = min[3] + inset;
+
+        std::uint64_t indices = 0;
+
+        if(alpha0 > alpha1) {
+            int palette[8] = {alpha0, alpha1};
+            for(int p = 1 ; p < 7 ; ++p) {
+                palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7;
+            }
+
+            for(int i = 0 ; i < 16 ; ++i) {
+                int best = 0;
+                for(int p = 1 ; p < 8 ; ++p) {
+                    if(std::abs(block[i * 4 + 3] - palette[p]) < std::abs(block[i * 4 + 3] - palette[best])) {
+                        best = p;
+                    }
+                }
+
+                indices |= static_cast<std::uint64_t>(best) << (3 * i);
+            }
+        }
+
+        output[0] = static_cast<unsigned char>(alpha0);
+        output[1] = static_cast<unsigned char>(alpha0 > alpha1 ? alpha1 : alpha0);
+        std::memcpy(output + 2, &indices, 6);
+    }
+
+    void decodeColorBlock(const unsigned char* input, bool fourColors, unsigned char block[64]) {
+        std::uint16_t color0, color1;
+        std::uint32_t indices;
+        std::memcpy(&color0, input, 2);
+        std::memcpy(&color1, input + 2, 2);
+        std::memcpy(&indices, input + 4, 4);
+
+        int palette[4][3];
+        colorPalette(color0, color1, fourColors || color0 > color1, palette);
+
+        for(int i = 0 ; i < 16 ; ++i) {
+            const int index = static_cast<int>((indices >> (2 * i)) & 3);
+            for(int c = 0 ; c < 3 ; ++c) {
+                block[i * 4 + c] = static_cast<unsigned char>(palette[index][c]);
+            }
+            block[i * 4 + 3] = (!fourColors && color0 <= color1 && index == 3) ? 0 : 255;
+        }
+    }
+
+    void decodeAlphaBlock(const unsigned char* input, unsigned char block[64]) {
+        const int alpha0 = input[0];
+        const int alpha1 = input[1];
+
+        std::uint64_t indices = 0;
+        std::memcpy(&indices, input + 2, 6);
+
+        int palette[8] = {alpha0, alpha1};
+        if(alpha0 > alpha1) {
+            for(int p = 1 ; p < 7 ; ++p) { palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7; }
+        } else {
+            for(int p = 1 ; p < 5 ; ++p) { palette[p + 1] = ((5 - p) * alpha0 + p * alpha1) / 5; }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        for(int i = 0 ; i < 16 ; ++i) {
+            block[i * 4 + 3] = static_cast<unsigned char>(palette[(indices >> (3 * i)) & 7]);
+        }
+    }
+
+    CompressedImage::Level encodeLevel(const ImageData& image, CompressionFormat format) {
+        const int blocksX = (image.getWidth() + 3) / 4;
+        const int blocksY = (image.getHeight() + 3) / 4;
+        const unsigned size = CompressedImage::blockSize(format);
+
+        CompressedImage::Level level{image.getWidth(), image.getHeight(), {}};
+        level.data.resize(static_cast<std::size_t>(blocksX) * blocksY * size);
+
+        ThreadPool::global().parallelFor(0, blocksY, [&](unsigned first, unsigned last) {
+            unsigned char block[64];
+
+            for(unsigned by = first ; by < last ; ++by) {
+                for(int bx = 0 ; bx < blocksX ; ++bx) {
+                    unsigned char* output = level.data.data() + (by * blocksX + bx) * size;
+                    fetchBlock(image, bx, static_cast<int>(by), block);
+
+                    if(format == CompressionFormat::BC3) {
+                        encodeAlphaBlock(block, output);
+                        output += 8;
+                    }
+                    encodeColorBlock(block, output);
+                }
+            }
+        });
+
+        return level;
+    }
+
+    void writeUnsigned(std::ofstream& file, std::uint32_t value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    std::uint32_t readUnsigned(std::ifstream& file) {
+        std::uint32_t value = 0;
+        file.read(reinterpret_cast<char*>(&value), sizeof(value));
+        return value;
+    }
+}
+
+CompressedImage::CompressedImage(const std::string& path) : format{} {
+    std::ifstream file{path, std::ios::binary};
+    if(!file.is_open()) {
+        throw std::runtime_error{"Compressed image was not found at path: \"" + path + "\"."};
+    }
+
+    char header[4];
+    file.read(header, 4);
+    if(!file || std::memcmp(header, magic, 4) != 0 || readUnsigned(file) != version) {
+        throw std::runtime_error{"Not a supported compressed image: \"" + path + "\"."};
+    }
+
+    format = static_cast<CompressionFormat>(readUnsigned(file));
+    if(format != CompressionFormat::BC1 && format != CompressionFormat::BC3) {
+        throw std::runtime_error{"Unknown compression format in: \"" + path + "\"."};
+    }
+
+    const std::uint32_t width = readUnsigned(file);
+    const std::uint32_t height = readUnsigned(file);
+    const std::uint32_t levelCount = readUnsigned(file);
+    if(!file || width == 0 || height == 0 || width > maxSize || height > maxSize
+       || levelCount == 0 || levelCount > maxLevels) {
+        throw std::runtime_error{"Invalid size in compressed image: \"" + path + "\"."};
+    }
+
+    // Sizes are checked before allocating anything, so that a corrupt file cannot ask for gigabytes
+    const std::streamoff start = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff remaining = file.tellg() - start;
+    file.seekg(start);
+
+    levels.resize(levelCount);
+    for(unsigned i = 0 ; i < levelCount ; ++i) {
+        Level& level = levels[i];
+        level.width = static_cast<int>(readUnsigned(file));
+        level.height = static_cast<int>(readUnsigned(file));
+        const std::uint32_t size = readUnsigned(file);
+        remaining -= 12;
+        if(!file) {
+            throw std::runtime_error{"Compressed image is truncated: \"" + path + "\"."};
+        }
+
+        // The first level has the size of the image, each one after it half the size of the previous one
+        const int expectedWidth = i == 0 ? static_cast<int>(width) : std::max(1, levels[i - 1].width / 2);
+        const int expectedHeight = i == 0 ? static_cast<int>(height) : std::max(1, levels[i - 1].height / 2);
+        if(level.width != expectedWidth || level.height != expectedHeight) {
+            throw std::runtime_error{"Invalid level size in compressed image: \"" + path + "\"."};
+        }
+
+        const auto blocks = static_cast<unsigned long long>((level.width + 3) / 4) * ((level.height + 3) / 4);
+        if(size != blocks * blockSize(format)) {
+            throw std::runtime_error{"Invalid level data size in compressed image: \"" + path + "\"."};
+        }
+        if(size > remaining) {
+            throw std::runtime_error{"Compressed image is truncated: \"" + path + "\"."};
+        }
+
+        level.data.resize(size);
+        file.read(reinterpret_cast<char*>(level.data.data()), static_cast<std::streamsize>(level.data.size()));
+        remaining -= size;
+    }
+
+    if(!file) {
+        throw std::runtime_error{"Compressed image is truncated: \"" + path + "\"."};
+    }
+    std::cout << "Read compressed image: \"" + path.substr(path.find_last_of('/') + 1) + "\".\n";
+}
+
+CompressedImage::CompressedImage(const ImageData& image, CompressionFormat format, bool mipmaps) : format{format} {
+    if(!mipmaps) {
+        levels.push_back(encodeLevel(image, format));
+        return;
+    }
+
+    for(const ImageData& level: buildMipChain(image)) {
+        levels.push_back(encodeLevel(level, format));
+    }
+}
+
+void CompressedImage::write(const std::string& path) const {
+    std::ofstream file{path, std::ios::binary};
+    if(!file.is_open()) {
+        throw std::runtime_error{"Failed to write compressed image: \"" + path + "\"."};
+    }
+
+    file.write(magic, 4);
+    writeUnsigned(file, version);
+    writeUnsigned(file, static_cast<std::uint32_t>(format));
+    writeUnsigned(file, getWidth());
+    writeUnsigned(file, getHeight());
+    writeUnsigned(file, getLevelCount());
+
+    for(const Level& level: levels) {
+        writeUnsigned(file, level.width);
+        writeUnsigned(file, level.height);
+        writeUnsigned(file, static_cast<std::uint32_t>(level.data.size()));
+        file.write(reinterpret_cast<const char*>(level.data.data()), static_cast<std::streamsize>(level.data.size()));
+    }
+
+    if(!file) {
+        throw std::runtime_error{"Failed to write compressed image: \"" + path + "\"."};
+    }
+    std::cout << "LOG : Wrote compressed image: \"" << path << "\".\n";
+}
+
+ImageData CompressedImage::decode(unsigned level) const {
+    const Level& source = getLevel(level);
+    const int channels = (format == CompressionFormat::BC3) ? 4 : 3;
+    const int blocksX = (source.width + 3) / 4;
+    const int blocksY = (source.height + 3) / 4;
+    const unsigned size = blockSize(format);
+    if(source.data.size() != static_cast<std::size_t>(blocksX) * blocksY * size) {
+        throw std::runtime_error{"Compressed image level " + std::to_string(level) + " does not match its size."};
+    }
+
+    ImageData image{source.width, source.height, channels};
+    unsigned char* data = image.getData();
+
+    unsigned char block[64];
+    for(int by = 0 ; by < blocksY ; ++by) {
+        for(int bx = 0 ; bx < blocksX ; ++bx) {
+            const unsigned char* input = source.data.data() + (by * blocksX + bx) * size;
+
+            if(format == CompressionFormat::BC3) {
+                decodeColorBlock(input + 8, true, block);
+                decodeAlphaBlock(input, block);
+            } else {
+                decodeColorBlock(input, false, block);
+            }
+
+            for(int y = 0 ; y < 4 && by * 4 + y < source.height ; ++y) {
+                for(int x = 0 ; x < 4 && bx * 4 + x < source.width ; ++x) {
+                    std::memcpy(data + ((by * 4 + y) * source.width + bx * 4 + x) * channels, block + (y * 4 + x) * 4, channels);
+                }
+            }
+        }
+    }
+
+    return image;
+}
+
+CompressionFormat CompressedImage::getFormat() const {
+    return format;
+}
+
+int CompressedImage::getWidth() const {
+    return levels.front().width;
+}
+
+int CompressedImage::getHeight() const {
+    return levels.front().height;
+}
+
+unsigned CompressedImage::getLevelCount() const {
+    return static_cast<unsigned>(levels.size());
+}
+
+const CompressedImage::Level& CompressedImage::getLevel(unsigned level) const {
+    if(level >= levels.size()) {
+        throw std::out_of_range{"Compressed image has no level " + std::to_string(level) + "."};
+    }
+
+    return levels[level];
+}
+
+unsigned long long CompressedImage::getSize() const {
+    unsigned long long size = 0;
+    for(const Level& level: levels) {
+        size += level.data.size();
+    }
+
+    return size;
+}
+
+unsigned CompressedImage::blockSize(CompressionFormat format) {
+    return format == CompressionFormat::BC3 ? 16 : 8;
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+/******************************************************************************************************
+ * @file  FrameBenchmark.cpp
+ * @brief Implementation of the FrameBenchmark class
+ ******************************************************************************************************/
+
+#include "FrameBenchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#include "MemoryTracker.hpp"
+
+namespace {
+    double milliseconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    std::string escape(const std::string& string) {
+        std::string escaped;
+        escaped.reserve(string.size());
+
+        for(char c: string) {
+            if(c == '"' || c == '\\') {
+                escaped += '\\';
+                escaped += c;
+            } else if(static_cast<unsigned char>(c) < 0x20) {
+                escaped += ' ';
+            } else {
+                escaped += c;
+            }
+        }
+
+        return escaped;
+    }
+
+    void writeSummary(std::ostream& stream, const FrameBenchmark::Summary& summary) {
+        stream << "{\"mean\": " << summary.mean << ", \"min\": " << summary.min << ", \"p50\": " << summary.p50
+               << ", \"p95\": " << summary.p95 << ", \"p99\": " << summary.p99 << ", \"max\": " << summary.max << '}';
+    }
+}
+
+FrameBenchmark::FrameBenchmark() : frameStart{}, stageStart{} { }
+
+void FrameBenchmark::beginFrame() {
+    frameStart = Clock::now();
+    stageStart = frameStart;
+}
+
+void FrameBenchmark::endStage(std::string_view stage) {
+    const Clock::time_point now = Clock::now();
+    find(stages, stage).push_back(milliseconds(now - stageStart));
+    stageStart = now;
+}
+
+void FrameBenchmark::record(std::string_view counter, double value) {
+    find(counters, counter).push_back(value);
+}
+
+void FrameBenchmark::recordGpu(std::string_view pass, double milliseconds) {
+    find(gpuPasses, pass).push_back(milliseconds);
+}
+
+void FrameBenchmark::endFrame() {
+    frameTimes.push_back(milliseconds(Clock::now() - frameStart));
+}
+
+void FrameBenchmark::clear() {
+    frameTimes.clear();
+    stages.clear();
+    counters.clear();
+    gpuPasses.clear();
+}
+
+void FrameBenchmark::setProperty(const std::string& name, const std::string& value) {
+    properties.emplace_back(name, '"' + escape(value) + '"');
+}
+
+void FrameBenchmark::setProperty(const std::string& name, double value) {
+    std::ostringstream stream;
+    stream << value;
+    properties.emplace_back(name, stream.str());
+}
+
+unsigned FrameBenchmark::getFrameCount() const {
+    return static_cast<unsigned>(frameTimes.size());
+}
+
+FrameBenchmark::Summary FrameBenchmark::getFrameTimes() const {
+    return summarize(frameTimes);
+}
+
+std::string FrameBenchmark::toJson() const {
+    std::ostringstream stream;
+    stream << std::setprecision(6);
+
+    stream << "{\n  \"properties\": {";
+    for(std::size_t i = 0 ; i < properties.size() ; ++i) {
+        stream << (i == 0 ? "\n" : ",\n") << "    \"" << escape(properties[i].first) << "\": " << properties[i].second;
+    }
+    stream << "\n  },\n";
+
+    stream << "  \"frames\": " << frameTimes.size() << ",\n";
+    stream << "  \"frameTime\": ";
+    writeSummary(stream, getFrameTimes());
+    stream << ",\n";
+
+    auto writeSeries = [&stream](const char* name, const std::vector<Series>& series) {
+        stream << "  \"" << name << "\": {";
+        for(std::size_t i = 0 ; i < series.size() ; ++i) {
+            stream << (i == 0 ? "\n" : ",\n") << "    \"" << escape(series[i].first) << "\": ";
+            writeSummary(stream, summarize(series[i].second));
+        }
+        stream << "\n  }";
+    };
+
+    writeSeries("stages", stages);
+    stream << ",\n";
+    writeSeries("counters", counters);
+    stream << ",\n";
+    writeSeries("gpuPasses", gpuPasses);
+    stream << ",\n";
+
+    // Memory usage in bytes when the results are written, peaks cover the whole run
+    stream << "  \"memory\": {";
+    for(unsigned i = 0 ; i < static_cast<unsigned>(MemoryTag::count) ; ++i) {
+        const MemoryTag tag = static_cast<MemoryTag>(i);
+        const MemoryTracker::Usage cpu = MemoryTracker::getUsage(tag);
+        const MemoryTracker::Usage gpu = MemoryTracker::getUsage(tag, MemoryDomain::gpu);
+
+        stream << (i == 0 ? "\n" : ",\n") << "    \"" << MemoryTracker::getName(tag) << "\": {\"cpu\": " << cpu.current
+               << ", \"cpuPeak\": " << cpu.peak << ", \"gpu\": " << gpu.current << ", \"gpuPeak\": " << gpu.peak << '}';
+    }
+    stream << "\n  }\n}\n";
+
+    return stream.str();
+}
+
+void FrameBenchmark::write(const std::string& path) const {
+    std::ofstream file{path};
+    if(!file.is_open()) {
+        throw std::runtime_error{"Failed to open \"" + path + "\"."};
+    }
+
+    file << toJson();
+    std::cout << "LOG : Wrote benchmark results to \"" << path << "\".\n";
+}
+
+FrameBenchmark::Summary FrameBenchmark::summarize(std::vector<double> values) {
+    if(values.empty()) { return Summary{}; }
+
+    std::sort(values.begin(), values.end());
+
+    auto percentile = [&values](double p) {
+        const std::size_t rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(values.size())));
+        return values[std::clamp<std::size_t>(rank, 1, values.size()) - 1];
+    };
+
+    return Summary{
+        std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size()),
+        values.front(),
+        percentile(0.50),
+        percentile(0.95),
+        percentile(0.99),
+        values.back()
+    };
+}
+
+std::vector<double>& FrameBenchmark::find(std::vector<Series>& series, std::string_view name) {
+    for(Series& entry: series) {
+        if(entry.first == name) { return entry.second; }
+    }
+
+    return series.emplace_back(std::string{name}, std::vector<double>{}).second;
+}
\ No newline at end of file
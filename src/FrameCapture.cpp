@@ -0,0 +1,181 @@
+/******************************************************************************************************
+ * @file  FrameCapture.cpp
+ * @brief Implementation of the FrameCapture class
+ ******************************************************************************************************/
+
+#include "FrameCapture.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+#include "MemoryTracker.hpp"
+
+FrameCapture::FrameCapture(unsigned latency)
+    : next{}, recording{false}, sequenceFrame{}, framesCaptured{}, writer{} {
+
+    slots.resize(std::max(latency, 1u));
+    for(Slot& slot: slots) {
+        glGenBuffers(1, &slot.pbo);
+        slot.fence = nullptr;
+        slot.size = 0;
+        slot.width = 0;
+        slot.height = 0;
+    }
+}
+
+FrameCapture::~FrameCapture() {
+    // A readback that cannot complete anymore must not escape the destructor, its frame is lost anyway
+    try {
+        flush();
+    } catch(const std::exception& exception) {
+        std::cout << "LOG : " << exception.what() << " Pending frames were dropped.\n";
+    }
+
+    for(Slot& slot: slots) {
+        glDeleteBuffers(1, &slot.pbo);
+        MemoryTracker::untrack(MemoryTag::capture, slot.size, MemoryDomain::gpu);
+    }
+}
+
+void FrameCapture::screenshot(const std::string& path) {
+    requests.emplace_back([this, path](ImageData image) {
+        writer.write(image, path);
+        std::cout << "LOG : Captured screenshot: \"" << path << "\".\n";
+    });
+}
+
+void FrameCapture::capture(std::function<void(ImageData)> callback) {
+    requests.push_back(std::move(callback));
+}
+
+void FrameCapture::startSequence(const std::string& directory, const std::string& extension) {
+    std::filesystem::create_directories(directory);
+
+    recording = true;
+    sequenceDirectory = directory;
+    sequenceExtension = extension;
+    sequenceFrame = 0;
+}
+
+void FrameCapture::stopSequence() {
+    recording = false;
+}
+
+bool FrameCapture::isRecording() const {
+    return recording;
+}
+
+void FrameCapture::update(int width, int height) {
+    // Readbacks that are done are collected without waiting, oldest first so that consumers see frames in order
+    for(unsigned i = 0 ; i < slots.size() ; ++i) {
+        Slot& slot = slots[(next + i) % slots.size()];
+        if(slot.fence && !collect(slot, false)) { break; }
+    }
+
+    if(recording) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "frame_%05u.", sequenceFrame++);
+        const std::string path = sequenceDirectory + '/' + name + sequenceExtension;
+
+        requests.emplace_back([this, path](ImageData image) { writer.write(image, path); });
+    }
+
+    if(requests.empty()) { return; }
+
+    // Every request of a frame shares a single readback
+    std::vector<std::function<void(ImageData)>> consumers = std::move(requests);
+    requests.clear();
+
+    read(width, height, [consumers = std::move(consumers)](ImageData image) {
+        for(const std::function<void(ImageData)>& consumer: consumers) {
+            consumer(image);
+        }
+    });
+}
+
+void FrameCapture::flush() {
+    for(unsigned i = 0 ; i < slots.size() ; ++i) {
+        Slot& slot = slots[(next + i) % slots.size()];
+        if(slot.fence) { collect(slot, true); }
+    }
+
+    writer.wait();
+}
+
+unsigned FrameCapture::getFramesCaptured() const {
+    return framesCaptured;
+}
+
+ImageWriter& FrameCapture::getWriter() {
+    return writer;
+}
+
+void FrameCapture::read(int width, int height, std::function<void(ImageData)> consumer) {
+    Slot& slot = slots[next];
+    next = (next + 1) % slots.size();
+
+    // The ring is full, the oldest readback has to be waited for
+    if(slot.fence) { collect(slot, true); }
+
+    const unsigned long long size = 3ull * width * height;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    if(slot.size != size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+
+        MemoryTracker::untrack(MemoryTag::capture, slot.size, MemoryDomain::gpu);
+        MemoryTracker::track(MemoryTag::capture, size, MemoryDomain::gpu);
+        slot.size = size;
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.width = width;
+    slot.height = height;
+    slot.consumer = std::move(consumer);
+}
+
+bool FrameCapture::collect(Slot& slot, bool wait) {
+    const GLuint64 timeout = wait ? 1'000'000'000ull : 0ull;
+    const GLenum status = glClientWaitSync(slot.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeout);
+
+    if(status == GL_TIMEOUT_EXPIRED) {
+        if(wait) { throw std::runtime_error{"Timed out while waiting for a frame readback."}; }
+        return false;
+    }
+
+    if(status == GL_WAIT_FAILED) {
+        throw std::runtime_error{"Failed to wait for a frame readback."};
+    }
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(slot.size), GL_MAP_READ_BIT);
+    if(!pixels) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        throw std::runtime_error{"Failed to map a frame readback."};
+    }
+
+    // Rows come bottom first from OpenGL, which is also how an ImageData stores them. Copying through a view hands out
+    // no mutable pointer, so every consumer of the frame shares the same pixels
+    ImageData image{ImageView{static_cast<const unsigned char*>(pixels), slot.width, slot.height, 3}};
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    ++framesCaptured;
+
+    std::function<void(ImageData)> consumer = std::move(slot.consumer);
+    slot.consumer = nullptr;
+    consumer(std::move(image));
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+/******************************************************************************************************
+ * @file  Framebuffer.cpp
+ * @brief Implementation of the Framebuffer class
+ ******************************************************************************************************/
+
+#include "Framebuffer.hpp"
+
+#include <stdexcept>
+
+#include "MemoryTracker.hpp"
+
+Framebuffer::Framebuffer(int width, int height) : id{}, color{}, depth{}, width{width}, height{height} {
+    if(width <= 0 || height <= 0) {
+        throw std::invalid_argument{"Framebuffer dimensions must be positive."};
+    }
+
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &id);
+    glBindFramebuffer(GL_FRAMEBUFFER, id);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if(status != GL_FRAMEBUFFER_COMPLETE) {
+        glDeleteFramebuffers(1, &id);
+        glDeleteRenderbuffers(1, &color);
+        glDeleteRenderbuffers(1, &depth);
+        throw std::runtime_error{"Framebuffer is incomplete."};
+    }
+
+    MemoryTracker::track(MemoryTag::textures, getSize(), MemoryDomain::gpu);
+}
+
+Framebuffer::~Framebuffer() {
+    glDeleteFramebuffers(1, &id);
+    glDeleteRenderbuffers(1, &color);
+    glDeleteRenderbuffers(1, &depth);
+
+    MemoryTracker::untrack(MemoryTag::textures, getSize(), MemoryDomain::gpu);
+}
+
+void Framebuffer::bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, id);
+    glViewport(0, 0, width, height);
+}
+
+void Framebuffer::unbind() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+unsigned Framebuffer::getId() const {
+    return id;
+}
+
+int Framebuffer::getWidth() const {
+    return width;
+}
+
+int Framebuffer::getHeight() const {
+    return height;
+}
+
+unsigned long long Framebuffer::getSize() const {
+    // 4 bytes of color and 4 of depth, since 24 bit depth buffers are padded
+    return 8ull * width * height;
+}
\ No newline at end of file
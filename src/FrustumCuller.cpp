@@ -0,0 +1,201 @@
+/******************************************************************************************************
+ * @file  FrustumCuller.cpp
+ * @brief Implementation of the FrustumCuller class
+ ******************************************************************************************************/
+
+#include "FrustumCuller.hpp"
+
+#include <atomic>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+    // Below this many volumes, waking the thread pool costs more than it saves
+    constexpr unsigned parallelThreshold = 1 << 14;
+
+#if defined(__AVX__)
+    using Lanes = __m256;
+
+    inline Lanes load(const float* values) { return _mm256_loadu_ps(values); }
+    inline Lanes broadcast(float value) { return _mm256_set1_ps(value); }
+    inline Lanes plus(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+    inline Lanes times(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+    inline Lanes greaterEqual(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+    inline Lanes both(Lanes a, Lanes b) { return _mm256_and_ps(a, b); }
+    inline Lanes allSet() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+    inline unsigned mask(Lanes a) { return static_cast<unsigned>(_mm256_movemask_ps(a)); }
+#elif defined(__SSE2__)
+    using Lanes = __m128;
+
+    inline Lanes load(const float* values) { return _mm_loadu_ps(values); }
+    inline Lanes broadcast(float value) { return _mm_set1_ps(value); }
+    inline Lanes plus(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+    inline Lanes times(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+    inline Lanes greaterEqual(Lanes a, Lanes b) { return _mm_cmpge_ps(a, b); }
+    inline Lanes both(Lanes a, Lanes b) { return _mm_and_ps(a, b); }
+    inline Lanes allSet() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+    inline unsigned mask(Lanes a) { return static_cast<unsigned>(_mm_movemask_ps(a)); }
+#else
+    using Lanes = float;
+
+    inline Lanes load(const float* values) { return *values; }
+    inline Lanes broadcast(float value) { return value; }
+    inline Lanes plus(Lanes a, Lanes b) { return a + b; }
+    inline Lanes times(Lanes a, Lanes b) { return a * b; }
+    inline Lanes greaterEqual(Lanes a, Lanes b) { return a >= b ? 1.0f : 0.0f; }
+    inline Lanes both(Lanes a, Lanes b) { return a * b; }
+    inline Lanes allSet() { return 1.0f; }
+    inline unsigned mask(Lanes a) { return a != 0.0f ? 1u : 0u; }
+#endif
+
+    /**
+     * @brief Plane broadcast to every lane, with the absolute values of its normal for the box tests
+     */
+    struct PlaneLanes {
+        Lanes normalX, normalY, normalZ;
+        Lanes absoluteX, absoluteY, absoluteZ;
+        Lanes distance;
+    };
+
+    unsigned paddedSize(unsigned count) {
+        return (count + FrustumCuller::width - 1) / FrustumCuller::width * FrustumCuller::width;
+    }
+}
+
+FrustumCuller::FrustumCuller() : count{} { }
+
+void FrustumCuller::clear() {
+    for(std::vector<float>* array: {&sphereX, &sphereY, &sphereZ, &sphereRadius,
+                                    &boxX, &boxY, &boxZ, &extentX, &extentY, &extentZ}) {
+        array->clear();
+    }
+
+    count = 0;
+}
+
+void FrustumCuller::reserve(unsigned count) {
+    for(std::vector<float>* array: {&sphereX, &sphereY, &sphereZ, &sphereRadius,
+                                    &boxX, &boxY, &boxZ, &extentX, &extentY, &extentZ}) {
+        array->reserve(paddedSize(count));
+    }
+}
+
+unsigned FrustumCuller::add(const BoundingSphere& sphere, const AABB& box) {
+    const unsigned index = count++;
+
+    if(index == sphereX.size()) {
+        for(std::vector<float>* array: {&sphereX, &sphereY, &sphereZ, &sphereRadius,
+                                        &boxX, &boxY, &boxZ, &extentX, &extentY, &extentZ}) {
+            array->resize(paddedSize(count), 0.0f);
+        }
+    }
+
+    update(index, sphere, box);
+
+    return index;
+}
+
+void FrustumCuller::update(unsigned index, const BoundingSphere& sphere, const AABB& box) {
+    sphereX[index] = sphere.center.x;
+    sphereY[index] = sphere.center.y;
+    sphereZ[index] = sphere.center.z;
+    sphereRadius[index] = sphere.radius;
+
+    const Point center = box.center();
+    const Vector extent = box.extent();
+
+    boxX[index] = center.x;
+    boxY[index] = center.y;
+    boxZ[index] = center.z;
+    extentX[index] = extent.x;
+    extentY[index] = extent.y;
+    extentZ[index] = extent.z;
+}
+
+unsigned FrustumCuller::cull(const Frustum& frustum, std::vector<std::uint8_t>& visibility) const {
+    PROFILE_FUNCTION();
+
+    visibility.resize(count);
+
+    const unsigned blocks = paddedSize(count) / width;
+    if(count < parallelThreshold) {
+        return cullBlocks(frustum, 0, blocks, visibility.data());
+    }
+
+    std::atomic<unsigned> visible = 0;
+    ThreadPool::global().parallelFor(0, blocks, [&](unsigned first, unsigned last) {
+        visible += cullBlocks(frustum, first, last, visibility.data());
+    }, parallelThreshold / (4 * width));
+
+    return visible;
+}
+
+unsigned FrustumCuller::getSize() const {
+    return count;
+}
+
+unsigned FrustumCuller::cullBlocks(const Frustum& frustum, unsigned first, unsigned last, std::uint8_t* visibility) const {
+    PlaneLanes planes[6];
+    for(int i = 0 ; i < 6 ; ++i) {
+        const Plane& plane = frustum.planes[i];
+
+        planes[i] = PlaneLanes{broadcast(plane.normal.x), broadcast(plane.normal.y), broadcast(plane.normal.z),
+                               broadcast(std::abs(plane.normal.x)), broadcast(std::abs(plane.normal.y)),
+                               broadcast(std::abs(plane.normal.z)), broadcast(plane.distance)};
+    }
+
+    const Lanes zero = broadcast(0.0f);
+    unsigned visible = 0;
+
+    for(unsigned block = first ; block < last ; ++block) {
+        const unsigned index = block * width;
+
+        const Lanes sx = load(&sphereX[index]);
+        const Lanes sy = load(&sphereY[index]);
+        const Lanes sz = load(&sphereZ[index]);
+        const Lanes sr = load(&sphereRadius[index]);
+
+        const Lanes bx = load(&boxX[index]);
+        const Lanes by = load(&boxY[index]);
+        const Lanes bz = load(&boxZ[index]);
+        const Lanes ex = load(&extentX[index]);
+        const Lanes ey = load(&extentY[index]);
+        const Lanes ez = load(&extentZ[index]);
+
+        Lanes inside = allSet();
+        for(const PlaneLanes& plane: planes) {
+            // Signed distance of the sphere center, plus its radius, must not be negative
+            const Lanes sphereDistance = plus(plus(times(plane.normalX, sx), times(plane.normalY, sy)),
+                                              plus(times(plane.normalZ, sz), plane.distance));
+            inside = both(inside, greaterEqual(plus(sphereDistance, sr), zero));
+
+            // Same for the box, whose radius along the normal comes from its extent
+            const Lanes boxDistance = plus(plus(times(plane.normalX, bx), times(plane.normalY, by)),
+                                           plus(times(plane.normalZ, bz), plane.distance));
+            const Lanes boxRadius = plus(plus(times(plane.absoluteX, ex), times(plane.absoluteY, ey)),
+                                         times(plane.absoluteZ, ez));
+            inside = both(inside, greaterEqual(plus(boxDistance, boxRadius), zero));
+        }
+
+        const unsigned lanes = std::min(width, count - index);
+        unsigned bits = mask(inside) & ((1u << lanes) - 1);
+
+        for(unsigned lane = 0 ; lane < lanes ; ++lane) {
+            visibility[index + lane] = static_cast<std::uint8_t>((bits >> lane) & 1);
+        }
+
+        visible += static_cast<unsigned>(std::popcount(bits));
+    }
+
+    return visible;
+}
\ No newline at end of file
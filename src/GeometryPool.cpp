@@ -0,0 +1,338 @@
+/******************************************************************************************************
+ * @file  GeometryPool.cpp
+ * @brief Implementation of the GeometryPool and IndirectDraws classes
+ ******************************************************************************************************/
+
+#include "GeometryPool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+
+#include "MemoryTracker.hpp"
+#include "Profiler.hpp"
+#include "RenderStats.hpp"
+
+GeometryPool::GeometryPool(unsigned vertexCapacity, unsigned indexCapacity)
+    : vertices{vertexCapacity}, indices{indexCapacity}, VAO{}, VBO{}, EBO{}, drawIndexVBO{}, drawIndexCount{} {
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+    glGenBuffers(1, &drawIndexVBO);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(vertexCapacity * sizeof(Vertex)), nullptr, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(indexCapacity * sizeof(unsigned)), nullptr, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    MemoryTracker::track(MemoryTag::meshes, vertexCapacity * sizeof(Vertex) + indexCapacity * sizeof(unsigned),
+                         MemoryDomain::gpu);
+
+    setAttributes();
+}
+
+GeometryPool::~GeometryPool() {
+    MemoryTracker::untrack(MemoryTag::meshes, vertices.getCapacity() * sizeof(Vertex)
+                                              + indices.getCapacity() * sizeof(unsigned)
+                                              + drawIndexCount * sizeof(unsigned), MemoryDomain::gpu);
+
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    glDeleteBuffers(1, &drawIndexVBO);
+}
+
+GeometryPool::Range GeometryPool::add(Mesh& mesh) {
+    PROFILE_FUNCTION();
+
+    if(mesh.getPrimitive() != GL_TRIANGLES) {
+        throw std::runtime_error{"Only triangle meshes can be added to the geometry pool"};
+    }
+
+    const MeshArray<Point>& positions = *mesh.getPositions();
+    if(positions.empty()) {
+        throw std::runtime_error{"Nothing to add to the geometry pool"};
+    }
+
+    if(mesh.getNormals()->empty() && !mesh.getIndices()->empty()) {
+        mesh.computeNormals();
+    }
+
+    const MeshArray<Vector>& normals = *mesh.getNormals();
+    const MeshArray<Color>& colors = *mesh.getColors();
+    const MeshArray<TexCoord>& texcoords = *mesh.getTexcoords();
+
+    std::vector<Vertex> data(positions.size());
+    for(std::size_t i = 0 ; i < data.size() ; ++i) {
+        data[i].position = positions[i];
+        data[i].normal = i < normals.size() ? normals[i] : Vector{};
+        data[i].color = i < colors.size() ? colors[i] : White();
+        data[i].texcoord = i < texcoords.size() ? texcoords[i] : TexCoord{};
+    }
+
+    std::vector<unsigned> meshIndices{mesh.getIndices()->begin(), mesh.getIndices()->end()};
+    if(meshIndices.empty()) {
+        meshIndices.resize(positions.size());
+        std::iota(meshIndices.begin(), meshIndices.end(), 0u);
+    }
+
+    Range range{};
+    range.vertexCount = static_cast<unsigned>(data.size());
+    range.indexCount = static_cast<unsigned>(meshIndices.size());
+
+    if(!vertices.allocate(range.vertexCount, range.firstVertex)) {
+        const unsigned capacity = std::max(2 * vertices.getCapacity(), vertices.getCapacity() + range.vertexCount);
+
+        resize(VBO, vertices.getCapacity() * sizeof(Vertex), capacity * sizeof(Vertex));
+        MemoryTracker::track(MemoryTag::meshes, (capacity - vertices.getCapacity()) * sizeof(Vertex), MemoryDomain::gpu);
+
+        vertices.grow(capacity);
+        vertices.allocate(range.vertexCount, range.firstVertex);
+        setAttributes();
+    }
+
+    if(!indices.allocate(range.indexCount, range.firstIndex)) {
+        const unsigned capacity = std::max(2 * indices.getCapacity(), indices.getCapacity() + range.indexCount);
+
+        resize(EBO, indices.getCapacity() * sizeof(unsigned), capacity * sizeof(unsigned));
+        MemoryTracker::track(MemoryTag::meshes, (capacity - indices.getCapacity()) * sizeof(unsigned), MemoryDomain::gpu);
+
+        indices.grow(capacity);
+        indices.allocate(range.indexCount, range.firstIndex);
+        setAttributes();
+    }
+
+    // The copy target keeps the element array binding of whichever vertex array is bound untouched
+    glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(range.firstVertex * sizeof(Vertex)),
+                    static_cast<GLsizeiptr>(data.size() * sizeof(Vertex)), data.data());
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(range.firstIndex * sizeof(unsigned)),
+                    static_cast<GLsizeiptr>(meshIndices.size() * sizeof(unsigned)), meshIndices.data());
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    RenderStats::frame().bufferBytes += data.size() * sizeof(Vertex) + meshIndices.size() * sizeof(unsigned);
+
+    return range;
+}
+
+void GeometryPool::remove(const Range& range) {
+    vertices.release(range.firstVertex, range.vertexCount);
+    indices.release(range.firstIndex, range.indexCount);
+}
+
+void GeometryPool::bind(unsigned count) {
+    if(count > drawIndexCount) {
+        const unsigned newCount = std::max(count, 2 * drawIndexCount);
+
+        std::vector<unsigned> drawIndices(newCount);
+        std::iota(drawIndices.begin(), drawIndices.end(), 0u);
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, drawIndexVBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newCount * sizeof(unsigned)), drawIndices.data(),
+                     GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        MemoryTracker::track(MemoryTag::meshes, (newCount - drawIndexCount) * sizeof(unsigned), MemoryDomain::gpu);
+        RenderStats::frame().bufferBytes += newCount * sizeof(unsigned);
+
+        drawIndexCount = newCount;
+    }
+
+    glBindVertexArray(VAO);
+    ++RenderStats::frame().stateChanges;
+}
+
+unsigned GeometryPool::getVertexCapacity() const {
+    return vertices.getCapacity();
+}
+
+unsigned GeometryPool::getIndexCapacity() const {
+    return indices.getCapacity();
+}
+
+void GeometryPool::resize(unsigned& buffer, unsigned long long oldSize, unsigned long long newSize) {
+    unsigned resized;
+    glGenBuffers(1, &resized);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, resized);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newSize), nullptr, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(oldSize));
+
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glDeleteBuffers(1, &buffer);
+    buffer = resized;
+}
+
+void GeometryPool::setAttributes() {
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, position)));
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, normal)));
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, color)));
+    glEnableVertexAttribArray(2);
+
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, texcoord)));
+    glEnableVertexAttribArray(3);
+
+    glBindBuffer(GL_ARRAY_BUFFER, drawIndexVBO);
+    glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(unsigned), nullptr);
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(4, 1);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+GeometryPool::Allocator::Allocator(unsigned capacity) : ranges{}, capacity{} {
+    grow(capacity);
+}
+
+bool GeometryPool::Allocator::allocate(unsigned count, unsigned& first) {
+    for(auto it = ranges.begin() ; it != ranges.end() ; ++it) {
+        if(it->second < count) { continue; }
+
+        first = it->first;
+        const unsigned remaining = it->second - count;
+
+        ranges.erase(it);
+        if(remaining > 0) { ranges.emplace(first + count, remaining); }
+
+        return true;
+    }
+
+    return false;
+}
+
+void GeometryPool::Allocator::release(unsigned first, unsigned count) {
+    if(count == 0) { return; }
+
+    auto next = ranges.lower_bound(first);
+
+    if(next != ranges.begin()) {
+        auto previous = std::prev(next);
+        if(previous->first + previous->second == first) {
+            first = previous->first;
+            count += previous->second;
+            ranges.erase(previous);
+        }
+    }
+
+    if(next != ranges.end() && first + count == next->first) {
+        count += next->second;
+        ranges.erase(next);
+    }
+
+    ranges.emplace(first, count);
+}
+
+void GeometryPool::Allocator::grow(unsigned capacity) {
+    if(capacity <= this->capacity) { return; }
+
+    const unsigned previous = this->capacity;
+    this->capacity = capacity;
+    release(previous, capacity - previous);
+}
+
+unsigned GeometryPool::Allocator::getCapacity() const {
+    return capacity;
+}
+
+IndirectDraws::IndirectDraws(GeometryPool& pool)
+    : pool{pool}, triangles{}, uploadedTriangles{}, commandBuffer{}, drawBuffer{}, uploadedSize{}, uploadedCount{} {
+
+    if(!isSupported()) {
+        throw std::runtime_error{"Multi-draw indirect needs OpenGL 4.3"};
+    }
+
+    glGenBuffers(1, &commandBuffer);
+    glGenBuffers(1, &drawBuffer);
+}
+
+IndirectDraws::~IndirectDraws() {
+    MemoryTracker::untrack(MemoryTag::meshes, uploadedSize, MemoryDomain::gpu);
+
+    glDeleteBuffers(1, &commandBuffer);
+    glDeleteBuffers(1, &drawBuffer);
+}
+
+void IndirectDraws::clear() {
+    commands.clear();
+    draws.clear();
+    triangles = 0;
+}
+
+void IndirectDraws::add(const GeometryPool::Range& range, const Matrix4& model, const Color& color) {
+    commands.push_back(Command{range.indexCount, 1, range.firstIndex, static_cast<int>(range.firstVertex),
+                               static_cast<unsigned>(commands.size())});
+    draws.push_back(Instance{model, color});
+
+    triangles += range.indexCount / 3;
+}
+
+void IndirectDraws::upload() {
+    PROFILE_FUNCTION();
+
+    const unsigned long long commandsSize = commands.size() * sizeof(Command);
+    const unsigned long long drawsSize = draws.size() * sizeof(Instance);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(commandsSize), commands.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(drawsSize), draws.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    MemoryTracker::untrack(MemoryTag::meshes, uploadedSize, MemoryDomain::gpu);
+    uploadedSize = commandsSize + drawsSize;
+    MemoryTracker::track(MemoryTag::meshes, uploadedSize, MemoryDomain::gpu);
+
+    uploadedCount = static_cast<unsigned>(commands.size());
+    uploadedTriangles = triangles;
+    RenderStats::frame().bufferBytes += uploadedSize;
+}
+
+void IndirectDraws::draw() const {
+    if(uploadedCount == 0) { return; }
+
+    pool.bind(uploadedCount);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawBuffer);
+
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<int>(uploadedCount), 0);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    RenderStats& stats = RenderStats::frame();
+    ++stats.drawCalls;
+    stats.triangles += uploadedTriangles;
+}
+
+unsigned IndirectDraws::getCount() const {
+    return uploadedCount;
+}
+
+bool IndirectDraws::isSupported() {
+    return GLAD_GL_VERSION_4_3;
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+/******************************************************************************************************
+ * @file  GpuTimer.cpp
+ * @brief Implementation of the GpuTimer class
+ ******************************************************************************************************/
+
+#include "GpuTimer.hpp"
+
+#include <glad/glad.h>
+
+GpuTimer::GpuTimer() : frames{}, current{}, frameNumber{}, active{false}, resultsFrame{} { }
+
+GpuTimer::~GpuTimer() {
+    if(active) { end(); }
+
+    for(Frame& frame: frames) {
+        for(const Query& query: frame.queries) {
+            glDeleteQueries(1, &query.id);
+        }
+    }
+}
+
+void GpuTimer::beginFrame() {
+    if(active) { end(); }
+
+    poll();
+
+    // Queries the GPU still has not answered after a whole round of the pool are dropped rather than waited for
+    current = (current + 1) % latency;
+    frames[current].used = 0;
+    frames[current].number = ++frameNumber;
+}
+
+void GpuTimer::begin(const char* name) {
+    if(active) { end(); }
+
+    Frame& frame = frames[current];
+    if(frame.used == frame.queries.size()) {
+        unsigned id;
+        glGenQueries(1, &id);
+        frame.queries.push_back(Query{name, id});
+    }
+
+    Query& query = frame.queries[frame.used++];
+    query.name = name;
+
+    glBeginQuery(GL_TIME_ELAPSED, query.id);
+    active = true;
+}
+
+void GpuTimer::end() {
+    glEndQuery(GL_TIME_ELAPSED);
+    active = false;
+}
+
+const std::vector<GpuTimer::Result>& GpuTimer::getResults() const {
+    return results;
+}
+
+unsigned long long GpuTimer::getResultsFrame() const {
+    return resultsFrame;
+}
+
+double GpuTimer::getTotal() const {
+    double total = 0.0;
+    for(const Result& result: results) { total += result.milliseconds; }
+
+    return total;
+}
+
+void GpuTimer::poll() {
+    // From the oldest frame to the newest, so that the results end up being the ones of the newest finished frame
+    for(unsigned i = 1 ; i <= latency ; ++i) {
+        Frame& frame = frames[(current + i) % latency];
+        if(frame.used == 0 || frame.number <= resultsFrame) { continue; }
+
+        // Queries complete in order, so the last one being available means the whole frame is
+        int available = 0;
+        glGetQueryObjectiv(frame.queries[frame.used - 1].id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available) { break; }
+
+        results.clear();
+        for(unsigned j = 0 ; j < frame.used ; ++j) {
+            GLuint64 elapsed;
+            glGetQueryObjectui64v(frame.queries[j].id, GL_QUERY_RESULT, &elapsed);
+            results.push_back(Result{frame.queries[j].name, static_cast<double>(elapsed) / 1e6});
+        }
+
+        resultsFrame = frame.number;
+    }
+}
\ No newline at end of file
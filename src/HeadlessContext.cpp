@@ -0,0 +1,133 @@
+/******************************************************************************************************
+ * @file  HeadlessContext.cpp
+ * @brief Implementation of the HeadlessContext class
+ ******************************************************************************************************/
+
+#include "HeadlessContext.hpp"
+
+#include <stdexcept>
+
+#ifdef GRAPHICS_ENGINE_EGL
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <iostream>
+#include <string>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+namespace {
+    EGLDisplay getDisplay() {
+        // The surfaceless platform does not need a GPU, a display server or even a device node
+        auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+        if(getPlatformDisplay) {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if(display != EGL_NO_DISPLAY) { return display; }
+        }
+
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+}
+
+HeadlessContext::HeadlessContext() : display{}, context{}, majorVersion{}, minorVersion{} {
+    EGLDisplay eglDisplay = getDisplay();
+    if(eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, nullptr, nullptr)) {
+        throw std::runtime_error{"Failed to initialize EGL display"};
+    }
+    display = eglDisplay;
+
+    if(!eglBindAPI(EGL_OPENGL_API)) {
+        eglTerminate(eglDisplay);
+        throw std::runtime_error{"EGL display does not support OpenGL"};
+    }
+
+    // The config is only used to create the context, nothing is ever drawn to an EGL surface.
+    // Configs default to window surfaces, which the surfaceless platform does not have
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint configCount;
+    if(!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        eglTerminate(eglDisplay);
+        throw std::runtime_error{"Failed to find an EGL config for OpenGL"};
+    }
+
+    constexpr int versions[][2] = {{4, 6}, {4, 5}, {3, 3}};
+    for(const auto& [major, minor]: versions) {
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, major,
+            EGL_CONTEXT_MINOR_VERSION, minor,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+
+        EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+        if(eglContext != EGL_NO_CONTEXT) {
+            context = eglContext;
+            majorVersion = major;
+            minorVersion = minor;
+            break;
+        }
+    }
+
+    if(!context) {
+        eglTerminate(eglDisplay);
+        throw std::runtime_error{"Failed to create an OpenGL context with EGL"};
+    }
+
+    if(!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        eglDestroyContext(eglDisplay, context);
+        eglTerminate(eglDisplay);
+        throw std::runtime_error{"Failed to make the EGL context current"};
+    }
+
+    std::cout << "LOG : Created headless OpenGL " << majorVersion << '.' << minorVersion << " context.\n";
+}
+
+HeadlessContext::~HeadlessContext() {
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+}
+
+void* HeadlessContext::getProcAddress(const char* name) {
+    return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
+
+bool HeadlessContext::isAvailable() {
+    return true;
+}
+
+#else
+
+HeadlessContext::HeadlessContext() : display{}, context{}, majorVersion{}, minorVersion{} {
+    throw std::runtime_error{"The engine was built without EGL, headless contexts are unavailable"};
+}
+
+HeadlessContext::~HeadlessContext() = default;
+
+void* HeadlessContext::getProcAddress(const char* /* name */) {
+    return nullptr;
+}
+
+bool HeadlessContext::isAvailable() {
+    return false;
+}
+
+#endif
+
+int HeadlessContext::getMajorVersion() const {
+    return majorVersion;
+}
+
+int HeadlessContext::getMinorVersion() const {
+    return minorVersion;
+}
\ No newline at end of file
@@ -5,96 +5,153 @@
 
 #include "ImageData.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <stb_image.h>
-#include <stb_image_write.h>
 #include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "ImageWriter.hpp"
+#include "MemoryTracker.hpp"
+#include "Profiler.hpp"
+
+namespace {
+    std::atomic<unsigned long long> bytesCopied{0};
+
+    std::shared_ptr<unsigned char[]> allocatePixels(std::size_t size) {
+        auto* pixels = static_cast<unsigned char*>(MemoryTracker::allocate(MemoryTag::images, size));
+        if(!pixels) { throw std::bad_alloc{}; }
+
+        return std::shared_ptr<unsigned char[]>(pixels, MemoryTracker::release);
+    }
+}
+
+ImageData::ImageData(const std::string& path) : width{}, height{}, colorChannels{}, data{}, writable{false} {
+    PROFILE_SCOPE("ImageData load");
 
-ImageData::ImageData(const std::string& path) : width{}, height{}, colorChannels{}, data{}, isHeapAllocated{false} {
     stbi_set_flip_vertically_on_load(true);
 
-    data = stbi_load(path.c_str(), &width, &height, &colorChannels, 0);
-    if(!data) {
+    unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &colorChannels, 0);
+    if(!pixels) {
         throw std::runtime_error{"Image was not found at path: \"" + path + "\"."};
     }
+    data = std::shared_ptr<unsigned char[]>(pixels, stbi_image_free);
+
     std::cout << "Read image: \"" + path.substr(path.find_last_of('/') + 1) + "\".\n";
 }
 
-ImageData::ImageData(const ImageData& im) : width{im.width}, height{im.height}, colorChannels{im.colorChannels}, isHeapAllocated{true} {
-    const int size = width * height * colorChannels;
+ImageData::ImageData(int width, int height, int colorChannels)
+    : width{width}, height{height}, colorChannels{colorChannels},
+      data{allocatePixels(static_cast<std::size_t>(width) * height * colorChannels)}, writable{false} {
 
-    data = new unsigned char[size];
-    for(int i = 0 ; i < size ; ++i) {
-        data[i] = im.data[i];
-    }
+    std::memset(data.get(), 0, static_cast<std::size_t>(width) * height * colorChannels);
 }
 
-ImageData& ImageData::operator =(const ImageData& im) {
-    if(this == &im) { return *this; }
+ImageData::ImageData(const ImageView& view)
+    : width{view.getWidth()}, height{view.getHeight()}, colorChannels{view.getColorChannels()},
+      data{allocatePixels(static_cast<std::size_t>(width) * height * colorChannels)}, writable{false} {
+
+    const std::size_t rowSize = static_cast<std::size_t>(width) * colorChannels;
 
-    if(isHeapAllocated) {
-        delete data;
+    if(view.isContiguous()) {
+        std::memcpy(data.get(), view.getData(), rowSize * height);
     } else {
-        stbi_image_free(data);
+        for(int j = 0 ; j < height ; ++j) {
+            std::memcpy(data.get() + j * rowSize, view.row(j), rowSize);
+        }
     }
 
-    width = im.width;
-    height = im.height;
-    colorChannels = im.colorChannels;
+    bytesCopied += rowSize * height;
+}
+
+ImageData::ImageData(const ImageData& im)
+    : width{im.width}, height{im.height}, colorChannels{im.colorChannels}, data{im.data}, writable{false} {
 
-    const int size = width * height * colorChannels;
+    // The pointer handed out by the source must not write into the copy
+    if(im.writable) { *this = im.clone(); }
+}
 
-    data = new unsigned char[size];
-    for(int i = 0 ; i < size ; ++i) {
-        data[i] = im.data[i];
-    }
+ImageData::ImageData(ImageData&& im) noexcept
+    : width{std::exchange(im.width, 0)}, height{std::exchange(im.height, 0)},
+      colorChannels{std::exchange(im.colorChannels, 0)}, data{std::move(im.data)},
+      writable{std::exchange(im.writable, false)} { }
 
-    isHeapAllocated = true;
+ImageData& ImageData::operator =(const ImageData& im) {
+    if(this == &im) { return *this; }
 
-    return *this;
+    return *this = ImageData{im};
 }
 
-ImageData::~ImageData() {
-    if(isHeapAllocated) {
-        delete data;
-    } else {
-        stbi_image_free(data);
-    }
+ImageData& ImageData::operator =(ImageData&& im) noexcept {
+    if(this == &im) { return *this; }
+
+    width = std::exchange(im.width, 0);
+    height = std::exchange(im.height, 0);
+    colorChannels = std::exchange(im.colorChannels, 0);
+    data = std::move(im.data);
+    writable = std::exchange(im.writable, false);
+
+    return *this;
 }
 
-// todo : check if this works
 Color ImageData::operator ()(int i, int j) const {
+    const unsigned char* pixel = data.get() + (static_cast<std::size_t>(j) * width + i) * colorChannels;
+
+    // Grayscale images have the same value in every color channel
     Color color;
 
-    color.r = static_cast<float>(data[i + width * j]) / 255.f;
-    color.g = static_cast<float>(data[i + width * j]) / 255.f;
-    color.b = static_cast<float>(data[i + width * j]) / 255.f;
-    color.a = (colorChannels == 4) ? static_cast<float>(data[i + width * j]) / 255.f : 1.0f;
+    color.r = static_cast<float>(pixel[0]) / 255.f;
+    color.g = static_cast<float>(pixel[colorChannels >= 3 ? 1 : 0]) / 255.f;
+    color.b = static_cast<float>(pixel[colorChannels >= 3 ? 2 : 0]) / 255.f;
+    color.a = (colorChannels == 4 || colorChannels == 2) ? static_cast<float>(pixel[colorChannels - 1]) / 255.f : 1.0f;
 
     return color;
 }
 
+Color ImageData::sample(const TexCoord& texcoord) const {
+    // Texel centers are at half coordinates
+    const float x = texcoord.x * static_cast<float>(width) - 0.5f;
+    const float y = texcoord.y * static_cast<float>(height) - 0.5f;
+    const float left = std::floor(x);
+    const float bottom = std::floor(y);
+    const float tx = x - left;
+    const float ty = y - bottom;
+
+    const auto wrap = [](int i, int size) { return (i % size + size) % size; };
+    const int x0 = wrap(static_cast<int>(left), width);
+    const int x1 = wrap(static_cast<int>(left) + 1, width);
+    const int y0 = wrap(static_cast<int>(bottom), height);
+    const int y1 = wrap(static_cast<int>(bottom) + 1, height);
+
+    return (1.0f - ty) * ((1.0f - tx) * (*this)(x0, y0) + tx * (*this)(x1, y0))
+         + ty * ((1.0f - tx) * (*this)(x0, y1) + tx * (*this)(x1, y1));
+}
+
 void ImageData::write(const std::string& path) const {
-    bool success;
-
-    if(path.find(".png") != std::string::npos) {
-        success = stbi_write_png(path.c_str(), width, height, colorChannels, data, 0);
-    } else if(path.find(".jpg") != std::string::npos) {
-        success = stbi_write_jpg(path.c_str(), width, height, colorChannels, data, 100);
-    } else if(path.find(".bmp") != std::string::npos) {
-        success = stbi_write_bmp(path.c_str(), width, height, colorChannels, data);
-    } else if(path.find(".tga") != std::string::npos) {
-        success = stbi_write_tga(path.c_str(), width, height, colorChannels, data);
-    } else {
-        throw std::runtime_error{"File extension not supported: \"" + path + "\"."};
-    }
+    const std::vector<unsigned char> bytes = ImageWriter::encode(*this, ImageWriter::formatFromPath(path), 100);
 
-    if(!success) {
+    std::ofstream file{path, std::ios::binary};
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+    if(!file) {
         throw std::runtime_error{"Failed to write image: \"" + path + "\".\n"};
     }
     std::cout << "LOG : Wrote image: \"" << path << "\".\n";
 }
 
+ImageView ImageData::view() const {
+    return ImageView{data.get(), width, height, colorChannels};
+}
+
+ImageData ImageData::clone() const {
+    return ImageData{view()};
+}
+
 int ImageData::getWidth() const {
     return width;
 }
@@ -107,6 +164,50 @@ int ImageData::getColorChannels() const {
     return colorChannels;
 }
 
+unsigned long long ImageData::getSize() const {
+    return static_cast<unsigned long long>(width) * height * colorChannels;
+}
+
 const unsigned char* ImageData::getData() const {
-    return data;
+    return data.get();
+}
+
+unsigned char* ImageData::getData() {
+    if(data.use_count() > 1) {
+        *this = clone();
+    } else {
+        // The count is read relaxed, the last copy released on another thread must be done reading the pixels
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+
+    writable = true;
+    return data.get();
+}
+
+unsigned long long ImageData::getBytesCopied() {
+    return bytesCopied;
+}
+
+float psnr(const ImageData& reference, const ImageData& image) {
+    if(reference.getWidth() != image.getWidth() || reference.getHeight() != image.getHeight()) {
+        throw std::runtime_error{"Cannot compare images of different sizes."};
+    }
+
+    // Only the channels both images have are compared
+    const int channels = std::min(reference.getColorChannels(), image.getColorChannels());
+    const int pixels = reference.getWidth() * reference.getHeight();
+
+    double squaredError = 0.0;
+    for(int i = 0 ; i < pixels ; ++i) {
+        for(int c = 0 ; c < channels ; ++c) {
+            const double difference = reference.getData()[i * reference.getColorChannels() + c]
+                                    - image.getData()[i * image.getColorChannels() + c];
+            squaredError += difference * difference;
+        }
+    }
+
+    const double mse = squaredError / (static_cast<double>(pixels) * channels);
+    if(mse == 0.0) { return INFINITY; }
+
+    return static_cast<float>(10.0 * std::log10(255.0 * 255.0 / mse));
 }
\ No newline at end of file
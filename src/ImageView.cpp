@@ -0,0 +1,54 @@
+/******************************************************************************************************
+ * @file  ImageView.cpp
+ * @brief Implementation of the ImageView class
+ ******************************************************************************************************/
+
+#include "ImageView.hpp"
+
+#include <stdexcept>
+
+ImageView::ImageView() : data{}, width{}, height{}, colorChannels{}, stride{} { }
+
+ImageView::ImageView(const unsigned char* data, int width, int height, int colorChannels, int stride)
+    : data{data}, width{width}, height{height}, colorChannels{colorChannels},
+      stride{stride != 0 ? stride : width * colorChannels} { }
+
+ImageView ImageView::subView(int x, int y, int width, int height) const {
+    if(x < 0 || y < 0 || width < 0 || height < 0 || x + width > this->width || y + height > this->height) {
+        throw std::out_of_range{"Sub-view is out of the bounds of the image."};
+    }
+
+    return ImageView{(*this)(x, y), width, height, colorChannels, stride};
+}
+
+const unsigned char* ImageView::operator ()(int i, int j) const {
+    return data + static_cast<long long>(j) * stride + static_cast<long long>(i) * colorChannels;
+}
+
+const unsigned char* ImageView::row(int j) const {
+    return data + static_cast<long long>(j) * stride;
+}
+
+int ImageView::getWidth() const {
+    return width;
+}
+
+int ImageView::getHeight() const {
+    return height;
+}
+
+int ImageView::getColorChannels() const {
+    return colorChannels;
+}
+
+int ImageView::getStride() const {
+    return stride;
+}
+
+const unsigned char* ImageView::getData() const {
+    return data;
+}
+
+bool ImageView::isContiguous() const {
+    return stride == width * colorChannels;
+}
\ No newline at end of file
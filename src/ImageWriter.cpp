@@ -0,0 +1,541 @@
+/******************************************************************************************************
+ * @file  ImageWriter.cpp
+ * @brief Implementation of the ImageWriter class
+ ******************************************************************************************************/
+
+#include "ImageWriter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <stb_image_write.h>
+#include <stdexcept>
+
+#include "PixelFormat.hpp"
+
+namespace {
+    using Bytes = std::vector<unsigned char>;
+
+    /**
+     * @brief Row j of the file, the image being stored bottom row first
+     */
+    const unsigned char* fileRow(const ImageData& image, int j) {
+        const std::size_t rowSize = static_cast<std::size_t>(image.getWidth()) * image.getColorChannels();
+        return image.getData() + (image.getHeight() - 1 - j) * rowSize;
+    }
+
+    void putBigEndian(Bytes& bytes, std::uint32_t value) {
+        bytes.push_back(static_cast<unsigned char>(value >> 24));
+        bytes.push_back(static_cast<unsigned char>(value >> 16));
+        bytes.push_back(static_cast<unsigned char>(value >> 8));
+        bytes.push_back(static_cast<unsigned char>(value));
+    }
+
+    /* Deflate */
+
+    class BitWriter {
+    public:
+        explicit BitWriter(Bytes& output) : output{output}, buffer{}, count{} { }
+
+        void put(std::uint32_t bits, int n) {
+            buffer |= bits << count;
+            count += n;
+
+            while(count >= 8) {
+                output.push_back(static_cast<unsigned char>(buffer));
+                buffer >>= 8;
+                count -= 8;
+            }
+        }
+
+        /**
+         * @brief Huffman codes are stored most significant bit first
+         */
+        void putReversed(std::uint32_t code, int n) {
+            std::uint32_t reversed = 0;
+            for(int i = 0 ; i < n ; ++i) {
+                reversed = (reversed << 1) | ((code >> i) & 1u);
+            }
+            put(reversed, n);
+        }
+
+        void align() {
+            if(count > 0) { put(0, 8 - count); }
+        }
+
+    private:
+        Bytes& output;
+        std::uint32_t buffer;
+        int count;
+    };
+
+    constexpr std::array<int, 29> lengthBase = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+                                                67, 83, 99, 115, 131, 163, 195, 227, 258};
+    constexpr std::array<int, 29> lengthExtra = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4,
+                                                 5, 5, 5, 5, 0};
+    constexpr std::array<int, 30> distanceBase = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513,
+                                                  769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    constexpr std::array<int, 30> distanceExtra = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10,
+                                                   11, 11, 12, 12, 13, 13};
+
+    void putSymbol(BitWriter& writer, int symbol) {
+        // Fixed Huffman codes of RFC 1951, section 3.2.6
+        if(symbol <= 143) {
+            writer.putReversed(0x30 + symbol, 8);
+        } else if(symbol <= 255) {
+            writer.putReversed(0x190 + symbol - 144, 9);
+        } else if(symbol <= 279) {
+            writer.putReversed(symbol - 256, 7);
+        } else {
+            writer.putReversed(0xC0 + symbol - 280, 8);
+        }
+    }
+
+    void putMatch(BitWriter& writer, int length, int distance) {
+        int code = 0;
+        while(code < 28 && lengthBase[code + 1] <= length) { ++code; }
+        putSymbol(writer, 257 + code);
+        writer.put(length - lengthBase[code], lengthExtra[code]);
+
+        code = 0;
+        while(code < 29 && distanceBase[code + 1] <= distance) { ++code; }
+        writer.putReversed(code, 5);
+        writer.put(distance - distanceBase[code], distanceExtra[code]);
+    }
+
+    /**
+     * @brief Deflates data in a single block with fixed Huffman codes.
+     * Blocks that are not the last one end with an empty stored block (a sync flush) so that they end on a byte
+     * boundary and can be concatenated with the next one.
+     */
+    void deflate(const unsigned char* data, int size, bool last, Bytes& output) {
+        constexpr int windowSize = 1 << 15;
+        constexpr int hashSize = 1 << 15;
+        constexpr int maxChain = 16;
+        constexpr int maxLength = 258;
+
+        std::vector<int> head(hashSize, -1);
+        std::vector<int> previous(windowSize, -1);
+
+        auto hash = [data](int i) {
+            const std::uint32_t value = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16);
+            return static_cast<int>((value * 2654435761u) >> 17);
+        };
+
+        auto insert = [&](int i) {
+            if(i + 3 > size) { return; }
+
+            const int h = hash(i);
+            previous[i & (windowSize - 1)] = head[h];
+            head[h] = i;
+        };
+
+        BitWriter writer{output};
+        writer.put(last ? 1 : 0, 1);
+        writer.put(1, 2);
+
+        int i = 0;
+        while(i < size) {
+            int bestLength = 0;
+            int bestDistance = 0;
+
+            if(i + 3 <= size) {
+                int candidate = head[hash(i)];
+                const int limit = std::min(maxLength, size - i);
+
+                for(int chain = 0 ; chain < maxChain && candidate >= 0 && i - candidate <= windowSize - 1 ; ++chain) {
+                    int length = 0;
+                    while(length < limit && data[candidate + length] == data[i + length]) { ++length; }
+
+                    if(length > bestLength) {
+                        bestLength = length;
+                        bestDistance = i - candidate;
+                        if(length == limit) { break; }
+                    }
+
+                    const int next = previous[candidate & (windowSize - 1)];
+                    if(next >= candidate) { break; } // Slot was reused by a newer position
+                    candidate = next;
+                }
+            }
+
+            if(bestLength >= 3) {
+                putMatch(writer, bestLength, bestDistance);
+
+                for(int k = 0 ; k < bestLength ; ++k) { insert(i + k); }
+                i += bestLength;
+            } else {
+                putSymbol(writer, data[i]);
+                insert(i);
+                ++i;
+            }
+        }
+
+        putSymbol(writer, 256);
+
+        if(!last) {
+            writer.put(0, 3);
+            writer.align();
+            output.insert(output.end(), {0x00, 0x00, 0xFF, 0xFF});
+        } else {
+            writer.align();
+        }
+    }
+
+    std::uint32_t adler32(const Bytes& data) {
+        std::uint32_t a = 1, b = 0;
+        std::size_t i = 0;
+
+        while(i < data.size()) {
+            // Largest block whose sums cannot overflow before the modulo
+            const std::size_t end = std::min(i + 5552, data.size());
+            for(; i < end ; ++i) {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+
+        return (b << 16) | a;
+    }
+
+    /* PNG */
+
+    const std::array<std::uint32_t, 256>& crcTable() {
+        static const std::array<std::uint32_t, 256> table = [] {
+            std::array<std::uint32_t, 256> values{};
+            for(std::uint32_t n = 0 ; n < 256 ; ++n) {
+                std::uint32_t c = n;
+                for(int k = 0 ; k < 8 ; ++k) {
+                    c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                values[n] = c;
+            }
+            return values;
+        }();
+
+        return table;
+    }
+
+    void putChunk(Bytes& png, const char type[4], const unsigned char* data, std::size_t size) {
+        putBigEndian(png, static_cast<std::uint32_t>(size));
+
+        const std::size_t start = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data, data + size);
+
+        std::uint32_t crc = 0xFFFFFFFFu;
+        for(std::size_t i = start ; i < png.size() ; ++i) {
+            crc = crcTable()[(crc ^ png[i]) & 0xFFu] ^ (crc >> 8);
+        }
+        putBigEndian(png, crc ^ 0xFFFFFFFFu);
+    }
+
+    unsigned char paeth(int a, int b, int c) {
+        const int p = a + b - c;
+        const int pa = std::abs(p - a);
+        const int pb = std::abs(p - b);
+        const int pc = std::abs(p - c);
+
+        if(pa <= pb && pa <= pc) { return static_cast<unsigned char>(a); }
+        if(pb <= pc) { return static_cast<unsigned char>(b); }
+        return static_cast<unsigned char>(c);
+    }
+
+    /**
+     * @brief Filters a row with each of the 5 PNG filters and keeps the one with the smallest sum of residuals
+     */
+    void filterRow(const unsigned char* row, const unsigned char* above, int size, int bpp, unsigned char* output) {
+        static thread_local Bytes candidate;
+        candidate.resize(size);
+
+        long best = -1;
+        for(int filter = 0 ; filter < 5 ; ++filter) {
+            long sum = 0;
+
+            for(int i = 0 ; i < size ; ++i) {
+                const int left = (i >= bpp) ? row[i - bpp] : 0;
+                const int up = above ? above[i] : 0;
+                const int upLeft = (above && i >= bpp) ? above[i - bpp] : 0;
+
+                unsigned char value = row[i];
+                switch(filter) {
+                    case 1: value -= left; break;
+                    case 2: value -= up; break;
+                    case 3: value -= (left + up) / 2; break;
+                    case 4: value -= paeth(left, up, upLeft); break;
+                    default: break;
+                }
+
+                candidate[i] = value;
+                sum += std::abs(static_cast<signed char>(value));
+            }
+
+            if(best < 0 || sum < best) {
+                best = sum;
+                output[0] = static_cast<unsigned char>(filter);
+                std::copy(candidate.begin(), candidate.end(), output + 1);
+            }
+        }
+    }
+
+    Bytes encodePNG(const ImageData& image) {
+        const int width = image.getWidth();
+        const int height = image.getHeight();
+        const int channels = image.getColorChannels();
+        const int rowSize = width * channels;
+
+        // Chunks of rows are filtered and deflated independently
+        const int rowsPerChunk = std::max(1, std::min(height, (1 << 20) / std::max(rowSize, 1)));
+        const int chunkCount = (height + rowsPerChunk - 1) / rowsPerChunk;
+
+        std::vector<Bytes> filtered(chunkCount);
+        std::vector<Bytes> compressed(chunkCount);
+
+        ThreadPool::global().parallelFor(0, chunkCount, [&](unsigned first, unsigned last) {
+            for(unsigned chunk = first ; chunk < last ; ++chunk) {
+                const int begin = static_cast<int>(chunk) * rowsPerChunk;
+                const int end = std::min(begin + rowsPerChunk, height);
+
+                Bytes& rows = filtered[chunk];
+                rows.resize(static_cast<std::size_t>(end - begin) * (rowSize + 1));
+
+                for(int j = begin ; j < end ; ++j) {
+                    filterRow(fileRow(image, j), j > 0 ? fileRow(image, j - 1) : nullptr, rowSize, channels,
+                              rows.data() + static_cast<std::size_t>(j - begin) * (rowSize + 1));
+                }
+
+                deflate(rows.data(), static_cast<int>(rows.size()), chunk + 1 == static_cast<unsigned>(chunkCount), compressed[chunk]);
+            }
+        });
+
+        Bytes stream = {0x78, 0x01};
+        Bytes raw;
+        for(int chunk = 0 ; chunk < chunkCount ; ++chunk) {
+            stream.insert(stream.end(), compressed[chunk].begin(), compressed[chunk].end());
+            raw.insert(raw.end(), filtered[chunk].begin(), filtered[chunk].end());
+        }
+        putBigEndian(stream, adler32(raw));
+
+        static constexpr unsigned char colorTypes[5] = {0, 0, 4, 2, 6};
+
+        Bytes header;
+        putBigEndian(header, width);
+        putBigEndian(header, height);
+        header.insert(header.end(), {8, colorTypes[channels], 0, 0, 0});
+
+        Bytes png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        putChunk(png, "IHDR", header.data(), header.size());
+        putChunk(png, "IDAT", stream.data(), stream.size());
+        putChunk(png, "IEND", nullptr, 0);
+
+        return png;
+    }
+
+    /* QOI, see https://qoiformat.org/qoi-specification.pdf */
+
+    Bytes encodeQOI(const ImageData& source) {
+        const ImageData image = (source.getColorChannels() >= 3) ? source : convertChannels(source, source.getColorChannels() + 2);
+        const int width = image.getWidth();
+        const int height = image.getHeight();
+        const int channels = image.getColorChannels();
+
+        Bytes qoi = {'q', 'o', 'i', 'f'};
+        qoi.reserve(14 + static_cast<std::size_t>(width) * height * (channels + 1) + 8);
+        putBigEndian(qoi, width);
+        putBigEndian(qoi, height);
+        qoi.push_back(static_cast<unsigned char>(channels));
+        qoi.push_back(0);
+
+        std::array<std::array<unsigned char, 4>, 64> index{};
+        std::array<unsigned char, 4> previous = {0, 0, 0, 255};
+        int run = 0;
+
+        for(int j = 0 ; j < height ; ++j) {
+            const unsigned char* row = fileRow(image, j);
+
+            for(int i = 0 ; i < width ; ++i) {
+                const unsigned char* p = row + i * channels;
+                const std::array<unsigned char, 4> pixel = {p[0], p[1], p[2], channels == 4 ? p[3] : previous[3]};
+                const bool lastPixel = (j == height - 1 && i == width - 1);
+
+                if(pixel == previous) {
+                    ++run;
+                    if(run == 62 || lastPixel) {
+                        qoi.push_back(static_cast<unsigned char>(0xC0 | (run - 1)));
+                        run = 0;
+                    }
+                    continue;
+                }
+
+                if(run > 0) {
+                    qoi.push_back(static_cast<unsigned char>(0xC0 | (run - 1)));
+                    run = 0;
+                }
+
+                const int position = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+
+                if(index[position] == pixel) {
+                    qoi.push_back(static_cast<unsigned char>(position));
+                } else {
+                    index[position] = pixel;
+
+                    if(pixel[3] == previous[3]) {
+                        const int dr = static_cast<signed char>(pixel[0] - previous[0]);
+                        const int dg = static_cast<signed char>(pixel[1] - previous[1]);
+                        const int db = static_cast<signed char>(pixel[2] - previous[2]);
+                        const int drg = dr - dg;
+                        const int dbg = db - dg;
+
+                        if(dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                            qoi.push_back(static_cast<unsigned char>(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2)));
+                        } else if(dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                            qoi.push_back(static_cast<unsigned char>(0x80 | (dg + 32)));
+                            qoi.push_back(static_cast<unsigned char>(((drg + 8) << 4) | (dbg + 8)));
+                        } else {
+                            qoi.insert(qoi.end(), {0xFE, pixel[0], pixel[1], pixel[2]});
+                        }
+                    } else {
+                        qoi.insert(qoi.end(), {0xFF, pixel[0], pixel[1], pixel[2], pixel[3]});
+                    }
+                }
+
+                previous = pixel;
+            }
+        }
+
+        qoi.insert(qoi.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+        return qoi;
+    }
+
+    /* PAM */
+
+    Bytes encodePAM(const ImageData& image) {
+        static constexpr const char* tupleTypes[5] = {"", "GRAYSCALE", "GRAYSCALE_ALPHA", "RGB", "RGB_ALPHA"};
+
+        const int channels = image.getColorChannels();
+        const std::string header = "P7\nWIDTH " + std::to_string(image.getWidth()) + "\nHEIGHT " + std::to_string(image.getHeight())
+                                 + "\nDEPTH " + std::to_string(channels) + "\nMAXVAL 255\nTUPLTYPE " + tupleTypes[channels]
+                                 + "\nENDHDR\n";
+
+        const std::size_t rowSize = static_cast<std::size_t>(image.getWidth()) * channels;
+
+        Bytes pam(header.begin(), header.end());
+        pam.reserve(header.size() + rowSize * image.getHeight());
+
+        for(int j = 0 ; j < image.getHeight() ; ++j) {
+            const unsigned char* row = fileRow(image, j);
+            pam.insert(pam.end(), row, row + rowSize);
+        }
+
+        return pam;
+    }
+
+    /* stb */
+
+    void appendBytes(void* context, void* data, int size) {
+        Bytes* bytes = static_cast<Bytes*>(context);
+        const unsigned char* begin = static_cast<const unsigned char*>(data);
+        bytes->insert(bytes->end(), begin, begin + size);
+    }
+}
+
+ImageWriter::ImageWriter(unsigned threadCount) : pool{threadCount}, pending{0}, jpgQuality{90} { }
+
+ImageWriter::~ImageWriter() {
+    wait();
+}
+
+std::future<void> ImageWriter::write(const ImageData& image, const std::string& path) {
+    return write(image, path, formatFromPath(path));
+}
+
+std::future<void> ImageWriter::write(const ImageData& image, const std::string& path, ImageFormat format) {
+    ++pending;
+
+    return pool.submit([this, image, path, format] {
+        // Whatever happens, the image is not pending anymore
+        struct Done {
+            ImageWriter* writer;
+
+            ~Done() {
+                std::lock_guard lock{writer->mutex};
+                --writer->pending;
+                writer->condition.notify_all();
+            }
+        } done{this};
+
+        const Bytes bytes = encode(image, format, jpgQuality);
+
+        std::ofstream file{path, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+        if(!file) {
+            throw std::runtime_error{"Failed to write image: \"" + path + "\"."};
+        }
+    });
+}
+
+void ImageWriter::wait() {
+    std::unique_lock lock{mutex};
+    condition.wait(lock, [this] { return pending == 0; });
+}
+
+unsigned ImageWriter::getPendingCount() const {
+    return pending;
+}
+
+void ImageWriter::setJpgQuality(int quality) {
+    jpgQuality = std::clamp(quality, 1, 100);
+}
+
+ImageFormat ImageWriter::formatFromPath(const std::string& path) {
+    if(path.ends_with(".png")) { return ImageFormat::png; }
+    if(path.ends_with(".jpg") || path.ends_with(".jpeg")) { return ImageFormat::jpg; }
+    if(path.ends_with(".bmp")) { return ImageFormat::bmp; }
+    if(path.ends_with(".tga")) { return ImageFormat::tga; }
+    if(path.ends_with(".qoi")) { return ImageFormat::qoi; }
+    if(path.ends_with(".pam")) { return ImageFormat::pam; }
+
+    throw std::runtime_error{"File extension not supported: \"" + path + "\"."};
+}
+
+std::vector<unsigned char> ImageWriter::encode(const ImageData& image, ImageFormat format, int jpgQuality) {
+    switch(format) {
+        case ImageFormat::png:
+            return encodePNG(image);
+        case ImageFormat::qoi:
+            return encodeQOI(image);
+        case ImageFormat::pam:
+            return encodePAM(image);
+        default:
+            break;
+    }
+
+    // stb reads the rows in memory order, give it a copy that is already top row first
+    const int rowSize = image.getWidth() * image.getColorChannels();
+    Bytes flipped(static_cast<std::size_t>(rowSize) * image.getHeight());
+    for(int j = 0 ; j < image.getHeight() ; ++j) {
+        std::copy(fileRow(image, j), fileRow(image, j) + rowSize, flipped.begin() + static_cast<std::ptrdiff_t>(j) * rowSize);
+    }
+
+    Bytes bytes;
+    int success;
+
+    if(format == ImageFormat::jpg) {
+        success = stbi_write_jpg_to_func(appendBytes, &bytes, image.getWidth(), image.getHeight(), image.getColorChannels(), flipped.data(), jpgQuality);
+    } else if(format == ImageFormat::bmp) {
+        success = stbi_write_bmp_to_func(appendBytes, &bytes, image.getWidth(), image.getHeight(), image.getColorChannels(), flipped.data());
+    } else {
+        success = stbi_write_tga_to_func(appendBytes, &bytes, image.getWidth(), image.getHeight(), image.getColorChannels(), flipped.data());
+    }
+
+    if(!success) {
+        throw std::runtime_error{"Failed to encode image."};
+    }
+
+    return bytes;
+}
\ No newline at end of file
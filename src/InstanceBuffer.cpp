@@ -0,0 +1,50 @@
+/******************************************************************************************************
+ * @file  InstanceBuffer.cpp
+ * @brief Implementation of the InstanceBuffer class
+ ******************************************************************************************************/
+
+#include "InstanceBuffer.hpp"
+
+#include <glad/glad.h>
+
+#include "MemoryTracker.hpp"
+#include "RenderStats.hpp"
+
+InstanceBuffer::InstanceBuffer() : id{}, count{}, capacity{} {
+    glGenBuffers(1, &id);
+}
+
+InstanceBuffer::~InstanceBuffer() {
+    MemoryTracker::untrack(MemoryTag::meshes, capacity, MemoryDomain::gpu);
+    glDeleteBuffers(1, &id);
+}
+
+void InstanceBuffer::update(const std::vector<Instance>& instances) {
+    const unsigned long long size = instances.size() * sizeof(Instance);
+    count = static_cast<unsigned>(instances.size());
+
+    glBindBuffer(GL_ARRAY_BUFFER, id);
+
+    if(size > capacity) {
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(size), instances.data(), GL_DYNAMIC_DRAW);
+
+        MemoryTracker::untrack(MemoryTag::meshes, capacity, MemoryDomain::gpu);
+        MemoryTracker::track(MemoryTag::meshes, size, MemoryDomain::gpu);
+        capacity = size;
+    } else if(size > 0) {
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(size), instances.data());
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    RenderStats::frame().bufferBytes += size;
+}
+
+unsigned InstanceBuffer::getId() const {
+    return id;
+}
+
+unsigned InstanceBuffer::getCount() const {
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+/******************************************************************************************************
+ * @file  MemoryTracker.cpp
+ * @brief Implementation of the MemoryTracker class
+ ******************************************************************************************************/
+
+#include "MemoryTracker.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+namespace {
+    constexpr unsigned tagCount = static_cast<unsigned>(MemoryTag::count);
+
+    struct Counter {
+        std::atomic<unsigned long long> current;
+        std::atomic<unsigned long long> peak;
+        std::atomic<unsigned long long> budget;
+    };
+
+    Counter counters[2][tagCount]{};
+
+    std::mutex callbacksMutex;
+    MemoryTracker::EvictionCallback callbacks[2][tagCount];
+
+    // Keeps the blocks returned by allocate aligned like the ones of malloc
+    struct alignas(std::max_align_t) Header {
+        std::size_t size;
+        MemoryTag tag;
+    };
+
+    Counter& counter(MemoryTag tag, MemoryDomain domain) {
+        return counters[static_cast<unsigned>(domain)][static_cast<unsigned>(tag)];
+    }
+}
+
+void MemoryTracker::track(MemoryTag tag, unsigned long long bytes, MemoryDomain domain) {
+    Counter& tagCounter = counter(tag, domain);
+
+    const unsigned long long current = tagCounter.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+    unsigned long long peak = tagCounter.peak.load(std::memory_order_relaxed);
+    while(current > peak && !tagCounter.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed)) { }
+}
+
+void MemoryTracker::untrack(MemoryTag tag, unsigned long long bytes, MemoryDomain domain) {
+    counter(tag, domain).current.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void* MemoryTracker::allocate(MemoryTag tag, std::size_t bytes) {
+    Header* header = static_cast<Header*>(std::malloc(sizeof(Header) + bytes));
+    if(!header) { return nullptr; }
+
+    header->size = bytes;
+    header->tag = tag;
+    track(tag, bytes);
+
+    return header + 1;
+}
+
+void* MemoryTracker::reallocate(MemoryTag tag, void* pointer, std::size_t bytes) {
+    if(!pointer) { return allocate(tag, bytes); }
+
+    Header* header = static_cast<Header*>(pointer) - 1;
+    const std::size_t oldSize = header->size;
+    const MemoryTag oldTag = header->tag;
+
+    Header* reallocated = static_cast<Header*>(std::realloc(header, sizeof(Header) + bytes));
+    if(!reallocated) { return nullptr; }
+
+    untrack(oldTag, oldSize);
+    reallocated->size = bytes;
+    reallocated->tag = tag;
+    track(tag, bytes);
+
+    return reallocated + 1;
+}
+
+void MemoryTracker::release(void* pointer) {
+    if(!pointer) { return; }
+
+    Header* header = static_cast<Header*>(pointer) - 1;
+    untrack(header->tag, header->size);
+
+    std::free(header);
+}
+
+MemoryTracker::Usage MemoryTracker::getUsage(MemoryTag tag, MemoryDomain domain) {
+    const Counter& tagCounter = counter(tag, domain);
+
+    return Usage{
+        tagCounter.current.load(std::memory_order_relaxed),
+        tagCounter.peak.load(std::memory_order_relaxed),
+        tagCounter.budget.load(std::memory_order_relaxed)
+    };
+}
+
+unsigned long long MemoryTracker::getTotal(MemoryDomain domain) {
+    unsigned long long total = 0;
+    for(unsigned i = 0 ; i < tagCount ; ++i) {
+        total += getUsage(static_cast<MemoryTag>(i), domain).current;
+    }
+
+    return total;
+}
+
+void MemoryTracker::setBudget(MemoryTag tag, unsigned long long bytes, MemoryDomain domain) {
+    counter(tag, domain).budget.store(bytes, std::memory_order_relaxed);
+}
+
+void MemoryTracker::setEvictionCallback(MemoryTag tag, EvictionCallback callback, MemoryDomain domain) {
+    std::lock_guard lock{callbacksMutex};
+    callbacks[static_cast<unsigned>(domain)][static_cast<unsigned>(tag)] = std::move(callback);
+}
+
+void MemoryTracker::enforceBudgets() {
+    for(unsigned domain = 0 ; domain < 2 ; ++domain) {
+        for(unsigned tag = 0 ; tag < tagCount ; ++tag) {
+            const Usage usage = getUsage(static_cast<MemoryTag>(tag), static_cast<MemoryDomain>(domain));
+            if(usage.budget == 0 || usage.current <= usage.budget) { continue; }
+
+            EvictionCallback callback;
+            {
+                std::lock_guard lock{callbacksMutex};
+                callback = callbacks[domain][tag];
+            }
+
+            if(callback) { callback(usage.current - usage.budget); }
+        }
+    }
+}
+
+const char* MemoryTracker::getName(MemoryTag tag) {
+    switch(tag) {
+        case MemoryTag::meshes:
+            return "meshes";
+        case MemoryTag::images:
+            return "images";
+        case MemoryTag::textures:
+            return "textures";
+        case MemoryTag::shaders:
+            return "shaders";
+        case MemoryTag::ui:
+            return "ui";
+        case MemoryTag::capture:
+            return "capture";
+        default:
+            return "unknown";
+    }
+}
\ No newline at end of file
@@ -7,19 +7,26 @@
 
 #include <stdexcept>
 
-Mesh::Mesh(unsigned primitive) : positions{}, colors{}, primitive{primitive}, buffersUpdate{true} {
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &positionsVBO);
-    glGenBuffers(1, &normalsVBO);
-    glGenBuffers(1, &colorsVBO);
-    glGenBuffers(1, &texcoordsVBO);
-    glGenBuffers(1, &EBO);
-}
+#include "Profiler.hpp"
+#include "RenderStats.hpp"
+
+Mesh::Mesh(unsigned primitive)
+    : positions{}, colors{}, primitive{primitive}, buffersUpdate{true}, boxUpdate{}, sphereUpdate{true},
+      bvhUpdate{true}, boundingBox{AABB::empty()}, boundingSphere{}, bvh{}, gpuSize{},
+      VAO{}, EBO{}, positionsVBO{}, normalsVBO{}, colorsVBO{}, texcoordsVBO{} { }
 
 Mesh::Mesh(const Mesh& mesh) {
     if(this == &mesh) { return; }
 
     buffersUpdate = true;
+    gpuSize = 0;
+
+    boxUpdate = mesh.boxUpdate;
+    sphereUpdate = mesh.sphereUpdate;
+    bvhUpdate = mesh.bvhUpdate;
+    boundingBox = mesh.boundingBox;
+    boundingSphere = mesh.boundingSphere;
+    bvh = mesh.bvh;
 
     primitive = mesh.primitive;
 
@@ -29,12 +36,12 @@ Mesh::Mesh(const Mesh& mesh) {
     texcoords = mesh.texcoords;
     indices = mesh.indices;
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &positionsVBO);
-    glGenBuffers(1, &normalsVBO);
-    glGenBuffers(1, &colorsVBO);
-    glGenBuffers(1, &texcoordsVBO);
-    glGenBuffers(1, &EBO);
+    VAO = 0;
+    EBO = 0;
+    positionsVBO = 0;
+    normalsVBO = 0;
+    colorsVBO = 0;
+    texcoordsVBO = 0;
 }
 
 Mesh& Mesh::operator =(const Mesh& mesh) {
@@ -50,18 +57,24 @@ Mesh& Mesh::operator =(const Mesh& mesh) {
     texcoords = mesh.texcoords;
     indices = mesh.indices;
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &positionsVBO);
-    glGenBuffers(1, &normalsVBO);
-    glGenBuffers(1, &colorsVBO);
-    glGenBuffers(1, &texcoordsVBO);
-    glGenBuffers(1, &EBO);
+    boxUpdate = mesh.boxUpdate;
+    sphereUpdate = mesh.sphereUpdate;
+    bvhUpdate = mesh.bvhUpdate;
+    boundingBox = mesh.boundingBox;
+    boundingSphere = mesh.boundingSphere;
+    bvh = mesh.bvh;
 
+    // The buffers already exist, they are filled again on the next draw
     return *this;
 }
 
 
 Mesh::~Mesh() {
+    // Meshes that were never drawn never created any OpenGL object
+    if(!VAO) { return; }
+
+    MemoryTracker::untrack(MemoryTag::meshes, gpuSize, MemoryDomain::gpu);
+
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &positionsVBO);
     glDeleteBuffers(1, &normalsVBO);
@@ -73,6 +86,10 @@ Mesh::~Mesh() {
 void Mesh::position(float x, float y, float z) {
     positions.emplace_back(x, y, z);
 
+    boundingBox.extend(positions.back());
+    sphereUpdate = true;
+    bvhUpdate = true;
+
     if(!normals.empty() && normals.size() < positions.size()) {
         normals.push_back(normals[normals.size() - 1]);
     }
@@ -132,6 +149,7 @@ void Mesh::texcoord(const TexCoord& texcoord) {
 
 void Mesh::index(unsigned index) {
     indices.push_back(index);
+    bvhUpdate = true;
 }
 
 void Mesh::triangle(unsigned top, unsigned left, unsigned right) {
@@ -146,6 +164,8 @@ void Mesh::face(unsigned topLeft, unsigned bottomLeft, unsigned bottomRight, uns
 }
 
 void Mesh::updatePosition(unsigned index, float x, float y, float z) {
+    moveBounds(positions[index], Point{x, y, z});
+
     positions[index].x = x;
     positions[index].y = y;
     positions[index].z = z;
@@ -154,6 +174,8 @@ void Mesh::updatePosition(unsigned index, float x, float y, float z) {
 }
 
 void Mesh::updatePosition(unsigned index, const Point& position) {
+    moveBounds(positions[index], position);
+
     positions[index] = position;
 
     buffersUpdate = true;
@@ -202,21 +224,98 @@ void Mesh::updateTexcoord(unsigned index, const TexCoord& texcoord) {
 }
 
 void Mesh::draw() {
+    prepare();
+
+    const unsigned long long count = indices.empty() ? positions.size() : indices.size();
+    if(indices.empty()) {
+        glDrawArrays(primitive, 0, static_cast<int>(count));
+    } else {
+        glDrawElements(primitive, static_cast<int>(count), GL_UNSIGNED_INT, nullptr);
+    }
+
+    RenderStats& stats = RenderStats::frame();
+    ++stats.drawCalls;
+    stats.triangles += RenderStats::triangleCount(primitive, count);
+}
+
+void Mesh::drawInstanced(const InstanceBuffer& instances) {
+    if(instances.getCount() == 0) { return; }
+
+    prepare();
+
+    // Buffers can be deleted and their name reused, so the attributes are pointed at the buffer on every draw
+    glBindBuffer(GL_ARRAY_BUFFER, instances.getId());
+
+    for(unsigned column = 0 ; column < 4 ; ++column) {
+        glVertexAttribPointer(4 + column, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              reinterpret_cast<void*>(column * 4 * sizeof(float)));
+        glEnableVertexAttribArray(4 + column);
+        glVertexAttribDivisor(4 + column, 1);
+    }
+
+    glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), reinterpret_cast<void*>(sizeof(Matrix4)));
+    glEnableVertexAttribArray(8);
+    glVertexAttribDivisor(8, 1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    const unsigned long long count = indices.empty() ? positions.size() : indices.size();
+    const auto instanceCount = static_cast<int>(instances.getCount());
+    if(indices.empty()) {
+        glDrawArraysInstanced(primitive, 0, static_cast<int>(count), instanceCount);
+    } else {
+        glDrawElementsInstanced(primitive, static_cast<int>(count), GL_UNSIGNED_INT, nullptr, instanceCount);
+    }
+
+    RenderStats& stats = RenderStats::frame();
+    ++stats.drawCalls;
+    stats.triangles += RenderStats::triangleCount(primitive, count) * instances.getCount();
+}
+
+void Mesh::prepare() {
+    if(!VAO) {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &positionsVBO);
+        glGenBuffers(1, &normalsVBO);
+        glGenBuffers(1, &colorsVBO);
+        glGenBuffers(1, &texcoordsVBO);
+        glGenBuffers(1, &EBO);
+    }
+
     if(buffersUpdate) {
         bindBuffers();
         buffersUpdate = false;
     }
 
     glBindVertexArray(VAO);
+    ++RenderStats::frame().stateChanges;
+}
 
-    if(indices.empty()) {
-        glDrawArrays(primitive, 0, static_cast<int>(positions.size()));
-    } else {
-        glDrawElements(primitive, static_cast<int>(indices.size()), GL_UNSIGNED_INT, nullptr);
+void Mesh::computeNormals() {
+    normals.assign(positions.size(), Vector{});
+
+    Vector temp;
+
+    // Indices of a face: 0-1-2  0-2-3
+    for(int i = 0 ; i < indices.size() ; i += 6) {
+        temp = cross(positions[indices[i + 2]] - positions[indices[i + 1]], positions[indices[i]] - positions[indices[i + 1]]);
+
+        normals[indices[i]] += temp;
+        normals[indices[i + 1]] += temp;
+        normals[indices[i + 2]] += temp;
+        normals[indices[i + 5]] += temp;
     }
+
+    for(auto& normal: normals) {
+        normal = normalize(normal);
+    }
+
+    buffersUpdate = true;
 }
 
 void Mesh::bindBuffers() {
+    PROFILE_FUNCTION();
+
     if(positions.empty()) {
         throw std::runtime_error{"Nothing to bind in Mesh"};
     }
@@ -230,23 +329,7 @@ void Mesh::bindBuffers() {
     glEnableVertexAttribArray(0);
 
     if(normals.empty() && !indices.empty() && primitive == GL_TRIANGLES) {
-        normals.resize(positions.size());
-
-        Vector temp;
-
-        // Indices of a face: 0-1-2  0-2-3
-        for(int i = 0 ; i < indices.size() ; i += 6) {
-            temp = cross(positions[indices[i + 2]] - positions[indices[i + 1]], positions[indices[i]] - positions[indices[i + 1]]);
-
-            normals[indices[i]] += temp;
-            normals[indices[i + 1]] += temp;
-            normals[indices[i + 2]] += temp;
-            normals[indices[i + 5]] += temp;
-        }
-
-        for(auto& normal: normals) {
-            normal = normalize(normal);
-        }
+        computeNormals();
     }
 
     if(!normals.empty()) {
@@ -278,28 +361,85 @@ void Mesh::bindBuffers() {
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
+
+    const unsigned long long size = positionsSize() + normalsSize() + colorsSize() + texcoordsSize() + indicesSize();
+
+    MemoryTracker::untrack(MemoryTag::meshes, gpuSize, MemoryDomain::gpu);
+    MemoryTracker::track(MemoryTag::meshes, size, MemoryDomain::gpu);
+    gpuSize = size;
+
+    RenderStats::frame().bufferBytes += size;
+}
+
+unsigned Mesh::getPrimitive() const {
+    return primitive;
+}
+
+const AABB& Mesh::getAABB() {
+    if(boxUpdate) {
+        boundingBox = computeAABB(positions.data(), positions.size());
+        boxUpdate = false;
+    }
+
+    return boundingBox;
 }
 
-const std::vector<Point>* Mesh::getPositions() {
+const BoundingSphere& Mesh::getBoundingSphere() {
+    if(sphereUpdate) {
+        boundingSphere = computeBoundingSphere(positions.data(), positions.size(), getAABB());
+        sphereUpdate = false;
+    }
+
+    return boundingSphere;
+}
+
+const MeshBVH& Mesh::getBVH() {
+    if(bvhUpdate) {
+        const std::size_t vertexCount = primitive != GL_TRIANGLES ? 0 : indices.empty() ? positions.size() : indices.size();
+        bvh.build(positions.data(), indices.empty() ? nullptr : indices.data(), vertexCount / 3);
+        bvhUpdate = false;
+    }
+
+    return bvh;
+}
+
+const MeshArray<Point>* Mesh::getPositions() {
     return &positions;
 }
 
-const std::vector<Vector>* Mesh::getNormals() {
+const MeshArray<Vector>* Mesh::getNormals() {
     return &normals;
 }
 
-const std::vector<Color>* Mesh::getColors() {
+const MeshArray<Color>* Mesh::getColors() {
     return &colors;
 }
 
-const std::vector<TexCoord>* Mesh::getTexcoords() {
+const MeshArray<TexCoord>* Mesh::getTexcoords() {
     return &texcoords;
 }
 
-const std::vector<unsigned>* Mesh::getIndices() {
+const MeshArray<unsigned>* Mesh::getIndices() {
     return &indices;
 }
 
+void Mesh::moveBounds(const Point& from, const Point& to) {
+    sphereUpdate = true;
+    bvhUpdate = true;
+    if(boxUpdate) { return; }
+
+    // Moving a point off the boundary of the box may shrink it, which only a pass over every point can tell
+    const bool onBoundary = from.x == boundingBox.min.x || from.x == boundingBox.max.x
+                         || from.y == boundingBox.min.y || from.y == boundingBox.max.y
+                         || from.z == boundingBox.min.z || from.z == boundingBox.max.z;
+
+    if(onBoundary) {
+        boxUpdate = true;
+    } else {
+        boundingBox.extend(to);
+    }
+}
+
 unsigned long long Mesh::positionsSize() const {
     return positions.size() * sizeof(Point);
 }
@@ -0,0 +1,308 @@
+/******************************************************************************************************
+ * @file  MeshBVH.cpp
+ * @brief Implementation of the MeshBVH class
+ ******************************************************************************************************/
+
+#include "MeshBVH.hpp"
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "Profiler.hpp"
+
+MeshBVH::MeshBVH() = default;
+
+void MeshBVH::build(const Point* positions, const unsigned* indices, std::size_t triangleCount) {
+    PROFILE_FUNCTION();
+
+    std::vector<Triangle> meshTriangles(triangleCount);
+    std::vector<AABB> boxes(triangleCount);
+
+    for(std::size_t i = 0 ; i < triangleCount ; ++i) {
+        const Point& a = positions[indices ? indices[3 * i] : 3 * i];
+        const Point& b = positions[indices ? indices[3 * i + 1] : 3 * i + 1];
+        const Point& c = positions[indices ? indices[3 * i + 2] : 3 * i + 2];
+
+        meshTriangles[i] = Triangle{a, b - a, c - a};
+
+        boxes[i] = AABB::empty();
+        boxes[i].extend(a);
+        boxes[i].extend(b);
+        boxes[i].extend(c);
+    }
+
+    BVH bvh = buildBVH(boxes);
+    nodes = std::move(bvh.nodes);
+    ids = std::move(bvh.order);
+
+    triangles.resize(triangleCount);
+    for(std::size_t i = 0 ; i < triangleCount ; ++i) {
+        triangles[i] = meshTriangles[ids[i]];
+    }
+
+#ifdef __SSE2__
+    collapse();
+#endif
+}
+
+std::optional<MeshBVH::Hit> MeshBVH::raycast(const Ray& ray, float maxDistance) const {
+    std::optional<Hit> hit;
+    if(nodes.empty()) { return hit; }
+
+    float closest = maxDistance;
+    const Vector inverseDirection = 1.0f / ray.direction;
+
+    struct Entry {
+        unsigned node;
+        float distance;
+    };
+
+    // Kept between casts, allocating it costs as much as walking the hierarchy of a small mesh
+    static thread_local std::vector<Entry> stack;
+    stack.clear();
+
+#ifdef __SSE2__
+    const __m128 originX = _mm_set1_ps(ray.origin.x);
+    const __m128 originY = _mm_set1_ps(ray.origin.y);
+    const __m128 originZ = _mm_set1_ps(ray.origin.z);
+    const __m128 inverseX = _mm_set1_ps(inverseDirection.x);
+    const __m128 inverseY = _mm_set1_ps(inverseDirection.y);
+    const __m128 inverseZ = _mm_set1_ps(inverseDirection.z);
+
+    stack.push_back(Entry{0, 0.0f});
+    while(!stack.empty()) {
+        const Entry entry = stack.back();
+        stack.pop_back();
+
+        // A closer hit may have been found since the node was pushed
+        if(entry.distance >= closest) { continue; }
+
+        const WideNode& node = wideNodes[entry.node];
+
+        // Slab tests of the 4 children at once
+        const __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minX), originX), inverseX);
+        const __m128 x2 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxX), originX), inverseX);
+        const __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minY), originY), inverseY);
+        const __m128 y2 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxY), originY), inverseY);
+        const __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minZ), originZ), inverseZ);
+        const __m128 z2 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxZ), originZ), inverseZ);
+
+        const __m128 tMin = _mm_max_ps(_mm_max_ps(_mm_min_ps(x1, x2), _mm_min_ps(y1, y2)),
+                                       _mm_max_ps(_mm_min_ps(z1, z2), _mm_setzero_ps()));
+        const __m128 tMax = _mm_min_ps(_mm_min_ps(_mm_max_ps(x1, x2), _mm_max_ps(y1, y2)),
+                                       _mm_min_ps(_mm_max_ps(z1, z2), _mm_set1_ps(closest)));
+
+        const int mask = _mm_movemask_ps(_mm_cmple_ps(tMin, tMax));
+        if(mask == 0) { continue; }
+
+        alignas(16) float distances[4];
+        _mm_store_ps(distances, tMin);
+
+        // Leaves are tested right away, inner children are visited nearest first
+        Entry children[4];
+        unsigned childCount = 0;
+        for(int i = 0 ; i < 4 ; ++i) {
+            if(!(mask & (1 << i)) || node.first[i] == unused) { continue; }
+
+            if(node.count[i] > 0) {
+                intersectLeaf(ray, node.first[i], node.count[i], hit, closest);
+            } else {
+                children[childCount++] = Entry{node.first[i], distances[i]};
+            }
+        }
+
+        // Farthest first so that the nearest is popped next, insertion sort is the cheapest for at most 4 children
+        for(unsigned i = 1 ; i < childCount ; ++i) {
+            const Entry child = children[i];
+            unsigned j = i;
+            for( ; j > 0 && children[j - 1].distance < child.distance ; --j) { children[j] = children[j - 1]; }
+            children[j] = child;
+        }
+
+        for(unsigned i = 0 ; i < childCount ; ++i) {
+            if(children[i].distance < closest) { stack.push_back(children[i]); }
+        }
+    }
+#else
+    const float rootDistance = intersect(ray, inverseDirection, nodes[0].box);
+    if(rootDistance < closest) { stack.push_back(Entry{0, rootDistance}); }
+
+    while(!stack.empty()) {
+        const Entry entry = stack.back();
+        stack.pop_back();
+
+        if(entry.distance >= closest) { continue; }
+
+        const BVHNode& node = nodes[entry.node];
+        if(node.count > 0) {
+            intersectLeaf(ray, node.first, node.count, hit, closest);
+            continue;
+        }
+
+        Entry nearest{node.first, intersect(ray, inverseDirection, nodes[node.first].box)};
+        Entry farthest{node.first + 1, intersect(ray, inverseDirection, nodes[node.first + 1].box)};
+        if(farthest.distance < nearest.distance) { std::swap(nearest, farthest); }
+
+        if(farthest.distance < closest) { stack.push_back(farthest); }
+        if(nearest.distance < closest) { stack.push_back(nearest); }
+    }
+#endif
+
+    return hit;
+}
+
+void MeshBVH::raycast(const RayPacket& rays, std::array<std::optional<Hit>, RayPacket::size>& hits,
+                      std::array<float, RayPacket::size>& closest) const {
+    if(nodes.empty()) { return; }
+
+    // Rays of a packet go the same way, the first one decides which child is visited first
+    const Vector direction = rays[0].direction;
+
+    static thread_local std::vector<unsigned> stack;
+    stack.assign(1, 0);
+
+    while(!stack.empty()) {
+        const BVHNode& node = nodes[stack.back()];
+        stack.pop_back();
+
+        if(intersect(rays, node.box, closest.data()) == 0) { continue; }
+
+        if(node.count > 0) {
+            intersectLeaf(rays, node.first, node.count, hits, closest);
+            continue;
+        }
+
+        const Vector separation = nodes[node.first + 1].box.center() - nodes[node.first].box.center();
+        if(dot(separation, direction) >= 0.0f) {
+            stack.push_back(node.first + 1);
+            stack.push_back(node.first);
+        } else {
+            stack.push_back(node.first);
+            stack.push_back(node.first + 1);
+        }
+    }
+}
+
+unsigned MeshBVH::getTriangleCount() const {
+    return static_cast<unsigned>(triangles.size());
+}
+
+unsigned MeshBVH::getNodeCount() const {
+    return static_cast<unsigned>(nodes.size());
+}
+
+const std::vector<BVHNode>& MeshBVH::getNodes() const {
+    return nodes;
+}
+
+void MeshBVH::intersectLeaf(const Ray& ray, unsigned first, unsigned count, std::optional<Hit>& hit, float& closest) const {
+    for(unsigned i = first ; i < first + count ; ++i) {
+        const Triangle& triangle = triangles[i];
+
+        float u, v;
+        const float distance = intersect(ray, triangle.vertex, triangle.edge1, triangle.edge2, u, v);
+        if(distance < closest) {
+            closest = distance;
+            hit = Hit{ids[i], u, v, distance};
+        }
+    }
+}
+
+void MeshBVH::intersectLeaf(const RayPacket& rays, unsigned first, unsigned count,
+                            std::array<std::optional<Hit>, RayPacket::size>& hits,
+                            std::array<float, RayPacket::size>& closest) const {
+    for(unsigned i = first ; i < first + count ; ++i) {
+        const Triangle& triangle = triangles[i];
+
+        float distances[RayPacket::size], u[RayPacket::size], v[RayPacket::size];
+        const int mask = intersect(rays, triangle.vertex, triangle.edge1, triangle.edge2, closest.data(), distances, u, v);
+        if(mask == 0) { continue; }
+
+        for(unsigned ray = 0 ; ray < RayPacket::size ; ++ray) {
+            if(!(mask & (1 << ray))) { continue; }
+
+            closest[ray] = distances[ray];
+            hits[ray] = Hit{ids[i], u[ray], v[ray], distances[ray]};
+        }
+    }
+}
+
+#ifdef __SSE2__
+void MeshBVH::collapse() {
+    wideNodes.clear();
+    if(nodes.empty()) { return; }
+
+    struct Entry {
+        unsigned node;  // Binary node whose descendants make the children of the wide node
+        unsigned wide;
+    };
+
+    wideNodes.emplace_back();
+    std::vector<Entry> stack{{0, 0}};
+
+    while(!stack.empty()) {
+        const Entry entry = stack.back();
+        stack.pop_back();
+
+        unsigned children[4];
+        unsigned childCount = 0;
+        if(nodes[entry.node].count > 0) {
+            children[childCount++] = entry.node;
+        } else {
+            children[childCount++] = nodes[entry.node].first;
+            children[childCount++] = nodes[entry.node].first + 1;
+        }
+
+        // Opening the largest child first keeps the boxes tested together of similar sizes
+        while(childCount < 4) {
+            int largest = -1;
+            for(unsigned i = 0 ; i < childCount ; ++i) {
+                const BVHNode& child = nodes[children[i]];
+                if(child.count == 0 && (largest < 0 || child.box.surfaceArea() > nodes[children[largest]].box.surfaceArea())) {
+                    largest = static_cast<int>(i);
+                }
+            }
+
+            if(largest < 0) { break; }
+
+            const unsigned opened = children[largest];
+            children[largest] = nodes[opened].first;
+            children[childCount++] = nodes[opened].first + 1;
+        }
+
+        for(unsigned i = 0 ; i < 4 ; ++i) {
+            // Inner children get a wide node of their own, which may move the storage
+            unsigned first = unused;
+            unsigned count = 0;
+            AABB box = AABB::empty();
+
+            if(i < childCount) {
+                const BVHNode& child = nodes[children[i]];
+                box = child.box;
+
+                if(child.count > 0) {
+                    first = child.first;
+                    count = child.count;
+                } else {
+                    first = static_cast<unsigned>(wideNodes.size());
+                    wideNodes.emplace_back();
+                    stack.push_back(Entry{children[i], first});
+                }
+            }
+
+            WideNode& node = wideNodes[entry.wide];
+            node.minX[i] = box.min.x;
+            node.minY[i] = box.min.y;
+            node.minZ[i] = box.min.z;
+            node.maxX[i] = box.max.x;
+            node.maxY[i] = box.max.y;
+            node.maxZ[i] = box.max.z;
+            node.first[i] = first;
+            node.count[i] = count;
+        }
+    }
+}
+#endif
\ No newline at end of file
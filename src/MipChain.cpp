@@ -0,0 +1,280 @@
+/******************************************************************************************************
+ * @file  MipChain.cpp
+ * @brief Implementation of the mipmap chain builder
+ ******************************************************************************************************/
+
+#include "MipChain.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "PixelFormat.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+    /**
+     * @brief Image with 4 float channels per texel, the working format of the filters
+     */
+    struct LinearImage {
+        int width;
+        int height;
+        std::vector<float> texels;
+    };
+
+    /**
+     * @brief Contribution of a range of source texels to a destination texel
+     */
+    struct Contribution {
+        int first;
+        std::vector<float> weights;
+    };
+
+    unsigned char toByte(float value) {
+        return static_cast<unsigned char>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
+
+    LinearImage toLinear(const ImageData& image, bool sRGB) {
+        const int channels = image.getColorChannels();
+        const unsigned char* data = image.getData();
+
+        LinearImage result{image.getWidth(), image.getHeight(), {}};
+        result.texels.resize(4ull * result.width * result.height);
+
+        ThreadPool::global().parallelFor(0, result.height, [&](unsigned first, unsigned last) {
+            for(unsigned j = first ; j < last ; ++j) {
+                for(int i = 0 ; i < result.width ; ++i) {
+                    const std::size_t index = static_cast<std::size_t>(j) * result.width + i;
+                    const unsigned char* texel = data + index * channels;
+                    float* output = result.texels.data() + 4 * index;
+
+                    // Grayscale images are spread over the three color channels
+                    for(int c = 0 ; c < 3 ; ++c) {
+                        const unsigned char value = texel[channels >= 3 ? c : 0];
+                        output[c] = sRGB ? sRGBToLinear(value) : static_cast<float>(value) / 255.0f;
+                    }
+
+                    output[3] = (channels == 4) ? texel[3] / 255.0f : (channels == 2) ? texel[1] / 255.0f : 1.0f;
+                }
+            }
+        });
+
+        return result;
+    }
+
+    ImageData toImage(const LinearImage& image, int channels, bool sRGB, float alphaScale) {
+        ImageData result{image.width, image.height, channels};
+        unsigned char* data = result.getData();
+
+        ThreadPool::global().parallelFor(0, image.height, [&](unsigned first, unsigned last) {
+            for(unsigned j = first ; j < last ; ++j) {
+                for(int i = 0 ; i < image.width ; ++i) {
+                    const std::size_t index = static_cast<std::size_t>(j) * image.width + i;
+                    const float* texel = image.texels.data() + 4 * index;
+                    unsigned char* output = data + index * channels;
+
+                    const int colors = (channels >= 3) ? 3 : 1;
+                    for(int c = 0 ; c < colors ; ++c) {
+                        output[c] = sRGB ? linearToSRGB(texel[c]) : toByte(texel[c]);
+                    }
+
+                    if(channels == 2 || channels == 4) {
+                        output[channels - 1] = toByte(texel[3] * alphaScale);
+                    }
+                }
+            }
+        });
+
+        return result;
+    }
+
+    float kaiser(float x, float alpha) {
+        // Zeroth order modified Bessel function of the first kind
+        auto bessel = [](float value) {
+            float sum = 1.0f;
+            float term = 1.0f;
+            for(int k = 1 ; k < 16 ; ++k) {
+                term *= (value / (2.0f * static_cast<float>(k))) * (value / (2.0f * static_cast<float>(k)));
+                sum += term;
+            }
+            return sum;
+        };
+
+        if(std::abs(x) > 1.0f) { return 0.0f; }
+        return bessel(alpha * std::sqrt(1.0f - x * x)) / bessel(alpha);
+    }
+
+    float sinc(float x) {
+        if(std::abs(x) < 1e-5f) { return 1.0f; }
+        return std::sin(3.141593f * x) / (3.141593f * x);
+    }
+
+    /**
+     * @brief Computes which source texels contribute to each destination texel along one axis
+     */
+    std::vector<Contribution> contributions(int sourceSize, int destinationSize, MipFilter filter) {
+        const float scale = static_cast<float>(sourceSize) / static_cast<float>(destinationSize);
+        std::vector<Contribution> result(destinationSize);
+
+        for(int o = 0 ; o < destinationSize ; ++o) {
+            Contribution& contribution = result[o];
+            const float start = static_cast<float>(o) * scale;
+            const float end = start + scale;
+
+            if(filter == MipFilter::box) {
+                // Exact coverage of the footprint, which gives fractional weights on odd sizes
+                const int first = static_cast<int>(std::floor(start));
+                const int last = std::min(static_cast<int>(std::ceil(end)), sourceSize);
+                contribution.first = first;
+
+                for(int s = first ; s < last ; ++s) {
+                    const float overlap = std::min(end, static_cast<float>(s + 1)) - std::max(start, static_cast<float>(s));
+                    contribution.weights.push_back(std::max(overlap, 0.0f));
+                }
+            } else {
+                constexpr float radius = 3.0f; // In destination texels
+                constexpr float alpha = 4.0f;
+
+                const float center = (start + end) * 0.5f;
+                const int first = static_cast<int>(std::floor(center - radius * scale));
+                const int last = static_cast<int>(std::ceil(center + radius * scale));
+                contribution.first = first;
+
+                for(int s = first ; s < last ; ++s) {
+                    const float x = (static_cast<float>(s) + 0.5f - center) / scale;
+                    contribution.weights.push_back(sinc(x) * kaiser(x / radius, alpha));
+                }
+            }
+
+            float sum = 0.0f;
+            for(float weight: contribution.weights) { sum += weight; }
+            for(float& weight: contribution.weights) { weight /= sum; }
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Accumulates weight * texel into a 4 channels sum
+     */
+    inline void accumulate(float* sum, const float* texel, float weight) {
+#ifdef __SSE2__
+        _mm_storeu_ps(sum, _mm_add_ps(_mm_loadu_ps(sum), _mm_mul_ps(_mm_loadu_ps(texel), _mm_set1_ps(weight))));
+#else
+        for(int c = 0 ; c < 4 ; ++c) { sum[c] += texel[c] * weight; }
+#endif
+    }
+
+    LinearImage downsample(const LinearImage& source, MipFilter filter) {
+        const int width = std::max(source.width / 2, 1);
+        const int height = std::max(source.height / 2, 1);
+
+        const std::vector<Contribution> horizontal = contributions(source.width, width, filter);
+        const std::vector<Contribution> vertical = contributions(source.height, height, filter);
+
+        // Horizontal pass, keeping every source row
+        LinearImage temporary{width, source.height, std::vector<float>(4ull * width * source.height)};
+
+        ThreadPool::global().parallelFor(0, source.height, [&](unsigned first, unsigned last) {
+            for(unsigned j = first ; j < last ; ++j) {
+                const float* row = source.texels.data() + 4ull * j * source.width;
+
+                for(int i = 0 ; i < width ; ++i) {
+                    float* output = temporary.texels.data() + 4ull * (j * width + i);
+                    const Contribution& contribution = horizontal[i];
+
+                    for(std::size_t k = 0 ; k < contribution.weights.size() ; ++k) {
+                        const int s = std::clamp(contribution.first + static_cast<int>(k), 0, source.width - 1);
+                        accumulate(output, row + 4 * s, contribution.weights[k]);
+                    }
+                }
+            }
+        }, 4);
+
+        // Vertical pass
+        LinearImage result{width, height, std::vector<float>(4ull * width * height)};
+
+        ThreadPool::global().parallelFor(0, height, [&](unsigned first, unsigned last) {
+            for(unsigned j = first ; j < last ; ++j) {
+                float* output = result.texels.data() + 4ull * j * width;
+                const Contribution& contribution = vertical[j];
+
+                for(std::size_t k = 0 ; k < contribution.weights.size() ; ++k) {
+                    const int s = std::clamp(contribution.first + static_cast<int>(k), 0, source.height - 1);
+                    const float* row = temporary.texels.data() + 4ull * s * width;
+
+                    for(int i = 0 ; i < width ; ++i) {
+                        accumulate(output + 4 * i, row + 4 * i, contribution.weights[k]);
+                    }
+                }
+
+                // Sharp filters overshoot, clamp back to a valid range
+                if(filter != MipFilter::box) {
+                    for(int i = 0 ; i < 4 * width ; ++i) {
+                        output[i] = std::clamp(output[i], 0.0f, 1.0f);
+                    }
+                }
+            }
+        }, 4);
+
+        return result;
+    }
+
+    float alphaCoverage(const LinearImage& image, float reference, float scale) {
+        std::size_t covered = 0;
+        for(std::size_t i = 3 ; i < image.texels.size() ; i += 4) {
+            if(image.texels[i] * scale > reference) { ++covered; }
+        }
+
+        return static_cast<float>(covered) / static_cast<float>(image.texels.size() / 4);
+    }
+
+    /**
+     * @brief Binary search of the alpha scale that gives the wanted coverage
+     */
+    float alphaScale(const LinearImage& image, float reference, float coverage) {
+        float low = 0.0f;
+        float high = 4.0f;
+        float scale = 1.0f;
+
+        for(int i = 0 ; i < 10 ; ++i) {
+            scale = (low + high) * 0.5f;
+            const float current = alphaCoverage(image, reference, scale);
+
+            if(current < coverage) {
+                low = scale;
+            } else if(current > coverage) {
+                high = scale;
+            } else {
+                break;
+            }
+        }
+
+        return scale;
+    }
+}
+
+std::vector<ImageData> buildMipChain(const ImageData& image, const MipSettings& settings) {
+    const int channels = image.getColorChannels();
+    const bool hasAlpha = (channels == 2 || channels == 4);
+    const bool preserveCoverage = settings.preserveAlphaCoverage && hasAlpha;
+
+    std::vector<ImageData> levels;
+    levels.push_back(image);
+
+    LinearImage level = toLinear(image, settings.sRGB);
+    const float coverage = preserveCoverage ? alphaCoverage(level, settings.alphaReference, 1.0f) : 0.0f;
+
+    while(level.width > 1 || level.height > 1) {
+        level = downsample(level, settings.filter);
+
+        // The scale only applies to the stored level so that errors do not add up down the chain
+        const float scale = preserveCoverage ? alphaScale(level, settings.alphaReference, coverage) : 1.0f;
+        levels.push_back(toImage(level, channels, settings.sRGB, scale));
+    }
+
+    return levels;
+}
\ No newline at end of file
@@ -0,0 +1,287 @@
+/******************************************************************************************************
+ * @file  OcclusionCuller.cpp
+ * @brief Implementation of the OcclusionCuller class
+ ******************************************************************************************************/
+
+#include "OcclusionCuller.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "Profiler.hpp"
+
+OcclusionCuller::OcclusionCuller(int width, int height)
+    : width{(width + 3) / 4 * 4}, height{height}, triangles{} {
+
+    if(width <= 0 || height <= 0) {
+        throw std::runtime_error{"An occlusion buffer needs a positive size"};
+    }
+
+    levels.push_back(Level{this->width, height, std::vector<float>(this->width * height, 1.0f)});
+    while(levels.back().width > 1 || levels.back().height > 1) {
+        const int levelWidth = (levels.back().width + 1) / 2;
+        const int levelHeight = (levels.back().height + 1) / 2;
+        levels.push_back(Level{levelWidth, levelHeight, std::vector<float>(levelWidth * levelHeight, 1.0f)});
+    }
+}
+
+OcclusionCuller::~OcclusionCuller() {
+    // The task still refers to this culler
+    if(rendering.valid()) { rendering.wait(); }
+}
+
+void OcclusionCuller::begin(const Matrix4& viewProjection) {
+    wait();
+
+    this->viewProjection = viewProjection;
+    occluders.clear();
+    triangles = 0;
+}
+
+void OcclusionCuller::addOccluder(Mesh& mesh, const Matrix4& model) {
+    occluders.push_back(Occluder{&mesh, model});
+}
+
+void OcclusionCuller::render(ThreadPool& pool) {
+    wait();
+
+    rendering = pool.submit([this] {
+        rasterize();
+        buildPyramid();
+    });
+}
+
+void OcclusionCuller::wait() {
+    if(rendering.valid()) { rendering.get(); }
+}
+
+bool OcclusionCuller::isOccluded(const AABB& box) const {
+    if(triangles == 0 || box.isEmpty()) { return false; }
+
+    float minX = std::numeric_limits<float>::infinity();
+    float minY = std::numeric_limits<float>::infinity();
+    float maxX = -std::numeric_limits<float>::infinity();
+    float maxY = -std::numeric_limits<float>::infinity();
+    float minZ = std::numeric_limits<float>::infinity();
+
+    // Corners are the transformed minimum plus the transformed sides of the box
+    const Vector size = box.max - box.min;
+    float origin[4], sides[3][4];
+    for(int row = 0 ; row < 4 ; ++row) {
+        const float* const values = viewProjection.values[row];
+        origin[row] = values[0] * box.min.x + values[1] * box.min.y + values[2] * box.min.z + values[3];
+        sides[0][row] = values[0] * size.x;
+        sides[1][row] = values[1] * size.y;
+        sides[2][row] = values[2] * size.z;
+    }
+
+    for(int corner = 0 ; corner < 8 ; ++corner) {
+        float clip[4];
+        for(int row = 0 ; row < 4 ; ++row) {
+            clip[row] = origin[row] + (corner & 1 ? sides[0][row] : 0.0f) + (corner & 2 ? sides[1][row] : 0.0f)
+                                    + (corner & 4 ? sides[2][row] : 0.0f);
+        }
+
+        // Boxes crossing the near plane may cover the whole screen
+        if(clip[3] <= 0.0f || clip[2] < -clip[3]) { return false; }
+
+        const float inverseW = 1.0f / clip[3];
+        const float x = (clip[0] * inverseW * 0.5f + 0.5f) * static_cast<float>(width);
+        const float y = (clip[1] * inverseW * 0.5f + 0.5f) * static_cast<float>(height);
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+        minZ = std::min(minZ, clip[2] * inverseW * 0.5f + 0.5f);
+    }
+
+    // Pixels touched by the box, and their neighbours : an occluder covering the center of a pixel but not the whole
+    // of it leaves the center of a neighbour uncovered
+    const auto pixel = [](float coordinate, int size) {
+        return static_cast<int>(std::floor(std::clamp(coordinate, -2.0f, static_cast<float>(size) + 1.0f)));
+    };
+    const int x0 = std::max(pixel(minX, width) - 1, 0);
+    const int y0 = std::max(pixel(minY, height) - 1, 0);
+    const int x1 = std::min(pixel(maxX, width) + 1, width - 1);
+    const int y1 = std::min(pixel(maxY, height) + 1, height - 1);
+
+    // Off screen, which is left to frustum culling
+    if(x0 > x1 || y0 > y1) { return false; }
+
+    // Coarsest level where the pixels fit in 2x2 texels
+    int level = 0;
+    while((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1) { ++level; }
+
+    const Level& depths = levels[level];
+    float farthest = 0.0f;
+    for(int y = y0 >> level ; y <= y1 >> level ; ++y) {
+        for(int x = x0 >> level ; x <= x1 >> level ; ++x) {
+            farthest = std::max(farthest, depths.depths[y * depths.width + x]);
+        }
+    }
+
+    return minZ > farthest;
+}
+
+int OcclusionCuller::getWidth() const {
+    return width;
+}
+
+int OcclusionCuller::getHeight() const {
+    return height;
+}
+
+unsigned OcclusionCuller::getTriangleCount() const {
+    return triangles;
+}
+
+void OcclusionCuller::rasterize() {
+    PROFILE_FUNCTION();
+
+    std::fill(levels[0].depths.begin(), levels[0].depths.end(), 1.0f);
+    triangles = 0;
+
+    std::vector<vec3> screen;
+    for(const Occluder& occluder: occluders) {
+        Mesh& mesh = *occluder.mesh;
+        if(mesh.getPrimitive() != GL_TRIANGLES) { continue; }
+
+        const MeshArray<Point>& positions = *mesh.getPositions();
+        const MeshArray<unsigned>& indices = *mesh.getIndices();
+        const Matrix4 toClip = viewProjection * occluder.model;
+
+        // Vertices in front of the near plane get a negative depth, their triangles are skipped instead of clipped
+        screen.resize(positions.size());
+        for(std::size_t i = 0 ; i < positions.size() ; ++i) {
+            const vec4 clip = toClip * vec4{positions[i].x, positions[i].y, positions[i].z, 1.0f};
+            if(clip.w <= 0.0f || clip.z < -clip.w) {
+                screen[i] = vec3{0.0f, 0.0f, -1.0f};
+                continue;
+            }
+
+            screen[i] = vec3{(clip.x / clip.w * 0.5f + 0.5f) * static_cast<float>(width),
+                             (clip.y / clip.w * 0.5f + 0.5f) * static_cast<float>(height),
+                             clip.z / clip.w * 0.5f + 0.5f};
+        }
+
+        const auto vertex = [&](std::size_t i) -> const vec3& { return screen[indices.empty() ? i : indices[i]]; };
+        const std::size_t elements = indices.empty() ? positions.size() : indices.size();
+
+        for(std::size_t i = 0 ; i + 2 < elements ; i += 3) {
+            const vec3 triangle[3] = {vertex(i), vertex(i + 1), vertex(i + 2)};
+            if(triangle[0].z < 0.0f || triangle[1].z < 0.0f || triangle[2].z < 0.0f) { continue; }
+
+            rasterizeTriangle(triangle);
+        }
+    }
+}
+
+void OcclusionCuller::rasterizeTriangle(const vec3 (&vertices)[3]) {
+    const vec3& v0 = vertices[0];
+    const vec3& v1 = vertices[1];
+    const vec3& v2 = vertices[2];
+
+    // Only front faces hide anything, the camera may be inside of an occluder whose back faces are culled when drawn
+    const float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+    if(!(area > 0.0f) || !std::isfinite(area)) { return; }
+
+    // Pixels whose center is inside of the bounds
+    const int minX = std::max(static_cast<int>(std::ceil(std::min({v0.x, v1.x, v2.x}) - 0.5f)), 0);
+    const int minY = std::max(static_cast<int>(std::ceil(std::min({v0.y, v1.y, v2.y}) - 0.5f)), 0);
+    const int maxX = std::min(static_cast<int>(std::floor(std::max({v0.x, v1.x, v2.x}) - 0.5f)), width - 1);
+    const int maxY = std::min(static_cast<int>(std::floor(std::max({v0.y, v1.y, v2.y}) - 0.5f)), height - 1);
+    if(minX > maxX || minY > maxY) { return; }
+
+    ++triangles;
+
+    // Edge functions a * x + b * y + c of the edges facing each vertex, positive inside
+    float a[3], b[3], c[3];
+    for(int i = 0 ; i < 3 ; ++i) {
+        const vec3& from = vertices[(i + 1) % 3];
+        const vec3& to = vertices[(i + 2) % 3];
+
+        a[i] = from.y - to.y;
+        b[i] = to.x - from.x;
+        c[i] = -(a[i] * from.x + b[i] * from.y);
+    }
+
+    // Depth is linear in screen space, as the weights of the vertices
+    const float zx = (a[0] * v0.z + a[1] * v1.z + a[2] * v2.z) / area;
+    const float zy = (b[0] * v0.z + b[1] * v1.z + b[2] * v2.z) / area;
+    const float z0 = (c[0] * v0.z + c[1] * v1.z + c[2] * v2.z) / area;
+
+    std::vector<float>& depths = levels[0].depths;
+    const int firstX = minX & ~3;
+
+#ifdef __SSE2__
+    const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 a0 = _mm_set1_ps(a[0]), a1 = _mm_set1_ps(a[1]), a2 = _mm_set1_ps(a[2]);
+    const __m128 depthX = _mm_set1_ps(zx);
+
+    for(int y = minY ; y <= maxY ; ++y) {
+        const float centerY = static_cast<float>(y) + 0.5f;
+        const __m128 row0 = _mm_set1_ps(b[0] * centerY + c[0]);
+        const __m128 row1 = _mm_set1_ps(b[1] * centerY + c[1]);
+        const __m128 row2 = _mm_set1_ps(b[2] * centerY + c[2]);
+        const __m128 rowDepth = _mm_set1_ps(zy * centerY + z0);
+
+        float* row = &depths[y * width];
+        for(int x = firstX ; x <= maxX ; x += 4) {
+            const __m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+
+            __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, centerX), row0), zero);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, centerX), row1), zero));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, centerX), row2), zero));
+            if(_mm_movemask_ps(inside) == 0) { continue; }
+
+            const __m128 current = _mm_loadu_ps(row + x);
+            const __m128 nearest = _mm_min_ps(current, _mm_add_ps(_mm_mul_ps(depthX, centerX), rowDepth));
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+        }
+    }
+#else
+    for(int y = minY ; y <= maxY ; ++y) {
+        const float centerY = static_cast<float>(y) + 0.5f;
+
+        float* row = &depths[y * width];
+        for(int x = minX ; x <= maxX ; ++x) {
+            const float centerX = static_cast<float>(x) + 0.5f;
+            if(a[0] * centerX + b[0] * centerY + c[0] < 0.0f
+               || a[1] * centerX + b[1] * centerY + c[1] < 0.0f
+               || a[2] * centerX + b[2] * centerY + c[2] < 0.0f) {
+                continue;
+            }
+
+            row[x] = std::min(row[x], zx * centerX + zy * centerY + z0);
+        }
+    }
+#endif
+}
+
+void OcclusionCuller::buildPyramid() {
+    PROFILE_FUNCTION();
+
+    for(std::size_t level = 1 ; level < levels.size() ; ++level) {
+        const Level& below = levels[level - 1];
+        Level& current = levels[level];
+
+        // Levels of odd sizes repeat their last row or column
+        for(int y = 0 ; y < current.height ; ++y) {
+            const float* row0 = &below.depths[2 * y * below.width];
+            const float* row1 = &below.depths[std::min(2 * y + 1, below.height - 1) * below.width];
+
+            for(int x = 0 ; x < current.width ; ++x) {
+                const int x0 = 2 * x;
+                const int x1 = std::min(2 * x + 1, below.width - 1);
+                current.depths[y * current.width + x] = std::max({row0[x0], row0[x1], row1[x0], row1[x1]});
+            }
+        }
+    }
+}
\ No newline at end of file
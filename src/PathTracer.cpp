@@ -0,0 +1,433 @@
+/******************************************************************************************************
+ * @file  PathTracer.cpp
+ * @brief Implementation of the PathTracer class
+ ******************************************************************************************************/
+
+#include "PathTracer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Profiler.hpp"
+#include "maths/constants.hpp"
+#include "maths/vec4.hpp"
+
+namespace {
+    // Rays leaving a surface start slightly above it so that they do not hit it again
+    constexpr float offset = 1e-3f;
+
+    /**
+     * @brief PCG hash, scrambles the bits of its input
+     */
+    unsigned hash(unsigned value) {
+        const unsigned state = value * 747796405u + 2891336453u;
+        const unsigned word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+
+        return (word >> 22u) ^ word;
+    }
+
+    /**
+     * @brief Ray in the model space of an object, the distances along it are the same as long as its direction is
+     * not normalized again
+     */
+    Ray toModel(const Ray& ray, const Matrix4& toModel) {
+        const vec4 direction = toModel * vec4{ray.direction.x, ray.direction.y, ray.direction.z, 0.0f};
+        return Ray{toModel * ray.origin, Vector{direction.x, direction.y, direction.z}};
+    }
+}
+
+PathTracer::Random::Random(unsigned pixel, unsigned sample) : state{hash(pixel + hash(sample))} { }
+
+float PathTracer::Random::next() {
+    state = hash(state);
+
+    // The 24 high bits fill the mantissa of a float exactly
+    return static_cast<float>(state >> 8u) * (1.0f / 16777216.0f);
+}
+
+PathTracer::PathTracer(int width, int height, unsigned bounces, ThreadPool& pool)
+    : width{width}, height{height}, bounces{bounces}, pool{pool},
+      light{Point{}, Color{}, Color{}, Color{}}, material{}, background{},
+      sampleCount{}, rayCount{} {
+
+    clear();
+}
+
+void PathTracer::setScene(const std::vector<Instance>& instances) {
+    PROFILE_FUNCTION();
+
+    objects.clear();
+    objects.reserve(instances.size());
+    std::vector<AABB> boxes;
+    boxes.reserve(instances.size());
+
+    for(const Instance& instance: instances) {
+        Mesh& mesh = *instance.mesh;
+        if(mesh.getPrimitive() != GL_TRIANGLES) { continue; }
+
+        // Same normals as the ones computed on the first draw, and the hierarchies are built before the threads
+        // start reading them
+        const MeshArray<unsigned>* indices = mesh.getIndices();
+        if(mesh.getNormals()->empty() && !indices->empty()) { mesh.computeNormals(); }
+
+        const MeshBVH& meshBVH = mesh.getBVH();
+        if(meshBVH.getTriangleCount() == 0) { continue; }
+
+        const MeshArray<Point>* positions = mesh.getPositions();
+        const MeshArray<Vector>* normals = mesh.getNormals();
+        const MeshArray<TexCoord>* texcoords = mesh.getTexcoords();
+        const Matrix4 toModel = inverse(instance.model);
+
+        objects.push_back(Object{&meshBVH, positions->data(),
+                                 normals->size() == positions->size() ? normals->data() : nullptr,
+                                 instance.texture && texcoords->size() == positions->size() ? texcoords->data() : nullptr,
+                                 indices->empty() ? nullptr : indices->data(),
+                                 instance.texture, toModel, transpose(toModel), instance.emissive});
+        boxes.push_back(transform(mesh.getAABB(), instance.model));
+    }
+
+    // Testing an object means walking the hierarchy of its mesh, so leaves hold a single one
+    bvh = buildBVH(boxes, 1);
+
+    clear();
+}
+
+void PathTracer::setCamera(const Matrix4& view, const Matrix4& projection) {
+    inverseViewProjection = inverse(projection * view);
+    clear();
+}
+
+void PathTracer::setLighting(const Light& light, const Material& material, const Color& background) {
+    this->light = light;
+    this->material = material;
+    this->background = background;
+    clear();
+}
+
+void PathTracer::clear() {
+    accumulation.assign(static_cast<std::size_t>(width) * height, Color{0.0f});
+    sampleCount = 0;
+    rayCount = 0;
+}
+
+void PathTracer::render() {
+    PROFILE_FUNCTION();
+
+    const unsigned tilesX = (width + tileSize - 1) / tileSize;
+    const unsigned tilesY = (height + tileSize - 1) / tileSize;
+
+    // Threads take chunks of tiles as they finish theirs, so tiles of the sky do not leave them waiting
+    pool.parallelFor(0, tilesX * tilesY, [this](unsigned first, unsigned last) {
+        unsigned long long rays = 0;
+        for(unsigned tile = first ; tile < last ; ++tile) {
+            renderTile(tile, rays);
+        }
+
+        rayCount += rays;
+    });
+
+    ++sampleCount;
+}
+
+ImageData PathTracer::getImage() const {
+    ImageData image{width, height, 3};
+    unsigned char* data = image.getData();
+
+    const float scale = sampleCount > 0 ? 1.0f / static_cast<float>(sampleCount) : 0.0f;
+    for(std::size_t i = 0 ; i < accumulation.size() ; ++i) {
+        const Color color = accumulation[i] * scale;
+
+        data[3 * i] = static_cast<unsigned char>(std::clamp(color.r, 0.0f, 1.0f) * 255.0f + 0.5f);
+        data[3 * i + 1] = static_cast<unsigned char>(std::clamp(color.g, 0.0f, 1.0f) * 255.0f + 0.5f);
+        data[3 * i + 2] = static_cast<unsigned char>(std::clamp(color.b, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    return image;
+}
+
+int PathTracer::getWidth() const {
+    return width;
+}
+
+int PathTracer::getHeight() const {
+    return height;
+}
+
+unsigned PathTracer::getSampleCount() const {
+    return sampleCount;
+}
+
+unsigned long long PathTracer::getRayCount() const {
+    return rayCount;
+}
+
+void PathTracer::renderTile(unsigned tile, unsigned long long& rays) {
+    const unsigned tilesX = (width + tileSize - 1) / tileSize;
+    const int firstX = static_cast<int>(tile % tilesX) * tileSize;
+    const int firstY = static_cast<int>(tile / tilesX) * tileSize;
+    const int lastX = std::min(firstX + tileSize, width);
+    const int lastY = std::min(firstY + tileSize, height);
+
+    for(int y = firstY ; y < lastY ; y += 2) {
+        for(int x = firstX ; x < lastX ; x += 2) {
+            // The rays of a 2x2 block of pixels, those outside of the image are ignored
+            bool inside[RayPacket::size];
+            int pixels[RayPacket::size];
+            Ray primary[RayPacket::size];
+            Random randoms[RayPacket::size] = {{0, 0}, {0, 0}, {0, 0}, {0, 0}};
+            PacketHits hits;
+
+            for(unsigned lane = 0 ; lane < RayPacket::size ; ++lane) {
+                const int pixelX = std::min(x + static_cast<int>(lane & 1u), width - 1);
+                const int pixelY = std::min(y + static_cast<int>(lane >> 1u), height - 1);
+
+                inside[lane] = x + static_cast<int>(lane & 1u) < width && y + static_cast<int>(lane >> 1u) < height;
+                pixels[lane] = pixelY * width + pixelX;
+                randoms[lane] = Random{static_cast<unsigned>(pixels[lane]), sampleCount};
+
+                // Jittered inside of the pixel, which antialiases the edges over the samples
+                const float ndcX = 2.0f * (static_cast<float>(pixelX) + randoms[lane].next()) / static_cast<float>(width) - 1.0f;
+                const float ndcY = 2.0f * (static_cast<float>(pixelY) + randoms[lane].next()) / static_cast<float>(height) - 1.0f;
+                primary[lane] = unprojectRay(inverseViewProjection, ndcX, ndcY);
+
+                hits.closest[lane] = inside[lane] ? std::numeric_limits<float>::infinity() : -1.0f;
+                rays += inside[lane];
+            }
+
+            intersect(RayPacket{primary}, hits, false);
+
+            // Shadow rays towards the light, which is at distance 1 along their direction
+            Surface surfaces[RayPacket::size];
+            Ray shadowRays[RayPacket::size];
+            PacketHits shadows;
+            bool anyShadowRay = false;
+
+            for(unsigned lane = 0 ; lane < RayPacket::size ; ++lane) {
+                shadowRays[lane] = primary[lane];
+                shadows.closest[lane] = -1.0f;
+                if(!hits.triangles[lane]) { continue; }
+
+                surfaces[lane] = getSurface(primary[lane], hits.objects[lane], *hits.triangles[lane]);
+                if(surfaces[lane].emissive) { continue; }
+
+                const Point origin = surfaces[lane].position + offset * surfaces[lane].normal;
+                shadowRays[lane] = Ray{origin, light.position - origin};
+                shadows.closest[lane] = 1.0f;
+                anyShadowRay = true;
+                ++rays;
+            }
+
+            if(anyShadowRay) { intersect(RayPacket{shadowRays}, shadows, true); }
+
+            for(unsigned lane = 0 ; lane < RayPacket::size ; ++lane) {
+                if(!inside[lane]) { continue; }
+
+                Color color = background;
+                if(hits.triangles[lane]) {
+                    const Surface& surface = surfaces[lane];
+
+                    if(surface.emissive) {
+                        color = light.diffuse;
+                    } else {
+                        color = shade(primary[lane], surface, shadows.triangles[lane].has_value());
+
+                        if(bounces > 0) {
+                            const Ray bounce{surface.position + offset * surface.normal, sampleHemisphere(surface.normal, randoms[lane])};
+                            color += surface.albedo * material.diffuse * trace(bounce, 1, randoms[lane], rays);
+                        }
+                    }
+                }
+
+                accumulation[pixels[lane]] += color;
+            }
+        }
+    }
+}
+
+void PathTracer::intersect(const RayPacket& rays, PacketHits& hits, bool anyHit) const {
+    if(bvh.nodes.empty()) { return; }
+
+    // Rays of a packet go the same way, the first one decides which child is visited first
+    const Vector direction = rays[0].direction;
+
+    static thread_local std::vector<unsigned> stack;
+    stack.assign(1, 0);
+
+    while(!stack.empty()) {
+        const BVHNode& node = bvh.nodes[stack.back()];
+        stack.pop_back();
+
+        if(::intersect(rays, node.box, hits.closest.data()) == 0) { continue; }
+
+        if(node.count == 0) {
+            const Vector separation = bvh.nodes[node.first + 1].box.center() - bvh.nodes[node.first].box.center();
+            if(dot(separation, direction) >= 0.0f) {
+                stack.push_back(node.first + 1);
+                stack.push_back(node.first);
+            } else {
+                stack.push_back(node.first);
+                stack.push_back(node.first + 1);
+            }
+
+            continue;
+        }
+
+        for(unsigned i = node.first ; i < node.first + node.count ; ++i) {
+            const unsigned index = bvh.order[i];
+            const Object& object = objects[index];
+            if(anyHit && object.emissive) { continue; }
+
+            Ray modelRays[RayPacket::size];
+            for(unsigned lane = 0 ; lane < RayPacket::size ; ++lane) {
+                modelRays[lane] = toModel(rays[lane], object.toModel);
+            }
+
+            const std::array<float, RayPacket::size> previous = hits.closest;
+            object.bvh->raycast(RayPacket{modelRays}, hits.triangles, hits.closest);
+
+            for(unsigned lane = 0 ; lane < RayPacket::size ; ++lane) {
+                if(hits.closest[lane] == previous[lane]) { continue; }
+
+                hits.objects[lane] = index;
+
+                // Rays looking for any hit are done
+                if(anyHit) { hits.closest[lane] = -1.0f; }
+            }
+        }
+    }
+}
+
+std::optional<std::pair<unsigned, MeshBVH::Hit>> PathTracer::intersect(const Ray& ray, float maxDistance, bool anyHit) const {
+    std::optional<std::pair<unsigned, MeshBVH::Hit>> hit;
+    if(bvh.nodes.empty()) { return hit; }
+
+    float closest = maxDistance;
+    const Vector inverseDirection = 1.0f / ray.direction;
+
+    static thread_local std::vector<unsigned> stack;
+    stack.assign(1, 0);
+
+    while(!stack.empty()) {
+        const BVHNode& node = bvh.nodes[stack.back()];
+        stack.pop_back();
+
+        if(::intersect(ray, inverseDirection, node.box) >= closest) { continue; }
+
+        if(node.count == 0) {
+            const Vector separation = bvh.nodes[node.first + 1].box.center() - bvh.nodes[node.first].box.center();
+            if(dot(separation, ray.direction) >= 0.0f) {
+                stack.push_back(node.first + 1);
+                stack.push_back(node.first);
+            } else {
+                stack.push_back(node.first);
+                stack.push_back(node.first + 1);
+            }
+
+            continue;
+        }
+
+        for(unsigned i = node.first ; i < node.first + node.count ; ++i) {
+            const unsigned index = bvh.order[i];
+            const Object& object = objects[index];
+            if(anyHit && object.emissive) { continue; }
+
+            const std::optional<MeshBVH::Hit> triangle = object.bvh->raycast(toModel(ray, object.toModel), closest);
+            if(!triangle) { continue; }
+
+            closest = triangle->distance;
+            hit = std::make_pair(index, *triangle);
+
+            if(anyHit) { return hit; }
+        }
+    }
+
+    return hit;
+}
+
+PathTracer::Surface PathTracer::getSurface(const Ray& ray, unsigned object, const MeshBVH::Hit& hit) const {
+    const Object& hitObject = objects[object];
+
+    const unsigned first = 3 * hit.triangle;
+    const unsigned a = hitObject.indices ? hitObject.indices[first] : first;
+    const unsigned b = hitObject.indices ? hitObject.indices[first + 1] : first + 1;
+    const unsigned c = hitObject.indices ? hitObject.indices[first + 2] : first + 2;
+    const float w = 1.0f - hit.u - hit.v;
+
+    const Vector normal = hitObject.normals
+                        ? w * hitObject.normals[a] + hit.u * hitObject.normals[b] + hit.v * hitObject.normals[c]
+                        : cross(hitObject.positions[b] - hitObject.positions[a], hitObject.positions[c] - hitObject.positions[a]);
+    const vec4 worldNormal = hitObject.normalMatrix * vec4{normal.x, normal.y, normal.z, 0.0f};
+
+    Surface surface;
+    surface.position = ray.origin + hit.distance * ray.direction;
+    surface.normal = normalize(Vector{worldNormal.x, worldNormal.y, worldNormal.z});
+    if(dot(surface.normal, ray.direction) > 0.0f) { surface.normal = -1.0f * surface.normal; }
+
+    surface.albedo = Color{1.0f};
+    if(hitObject.texcoords) {
+        const TexCoord texcoord = w * hitObject.texcoords[a] + hit.u * hitObject.texcoords[b] + hit.v * hitObject.texcoords[c];
+        surface.albedo = hitObject.texture->sample(texcoord);
+    }
+
+    surface.emissive = hitObject.emissive;
+
+    return surface;
+}
+
+Color PathTracer::shade(const Ray& ray, const Surface& surface, bool shadowed) const {
+    Color color = light.ambient * material.ambient;
+
+    if(!shadowed) {
+        const Vector lightDirection = normalize(light.position - surface.position);
+        const Vector viewDirection = normalize(-1.0f * ray.direction);
+        const Vector reflected = 2.0f * dot(lightDirection, surface.normal) * surface.normal - lightDirection;
+
+        const float diffuse = std::max(dot(surface.normal, lightDirection), 0.0f);
+        const float specular = std::pow(std::max(dot(viewDirection, reflected), 0.0f), material.shininess);
+
+        color += diffuse * (light.diffuse * material.diffuse) + specular * (light.specular * material.specular);
+    }
+
+    return color * surface.albedo;
+}
+
+Color PathTracer::trace(const Ray& ray, unsigned bounce, Random& random, unsigned long long& rays) const {
+    ++rays;
+    const std::optional<std::pair<unsigned, MeshBVH::Hit>> hit = intersect(ray, std::numeric_limits<float>::infinity(), false);
+    if(!hit) { return background; }
+
+    const Surface surface = getSurface(ray, hit->first, hit->second);
+    if(surface.emissive) { return light.diffuse; }
+
+    const Point origin = surface.position + offset * surface.normal;
+
+    ++rays;
+    const bool shadowed = intersect(Ray{origin, light.position - origin}, 1.0f, true).has_value();
+    Color color = shade(ray, surface, shadowed);
+
+    // Sampling the directions by their cosine cancels it out of the diffuse reflection, leaving the albedo
+    if(bounce < bounces) {
+        const Ray next{origin, sampleHemisphere(surface.normal, random)};
+        color += surface.albedo * material.diffuse * trace(next, bounce + 1, random, rays);
+    }
+
+    return color;
+}
+
+Vector PathTracer::sampleHemisphere(const Vector& normal, Random& random) {
+    const float radius = std::sqrt(random.next());
+    const float angle = two_pi() * random.next();
+    const float x = radius * std::cos(angle);
+    const float y = radius * std::sin(angle);
+    const float z = std::sqrt(std::max(1.0f - radius * radius, 0.0f));
+
+    // Orthonormal basis around the normal without any branch, from Duff et al. 2017
+    const float sign = std::copysign(1.0f, normal.z);
+    const float a = -1.0f / (sign + normal.z);
+    const float b = normal.x * normal.y * a;
+    const Vector tangent{1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x};
+    const Vector bitangent{b, sign + normal.y * normal.y * a, -normal.y};
+
+    return x * tangent + y * bitangent + z * normal;
+}
\ No newline at end of file
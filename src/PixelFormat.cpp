@@ -0,0 +1,520 @@
+/******************************************************************************************************
+ * @file  PixelFormat.cpp
+ * @brief Implementation of the pixel format conversions
+ ******************************************************************************************************/
+
+#include "PixelFormat.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+#include "ThreadPool.hpp"
+
+namespace {
+    constexpr int linearTableSize = 1 << 14;
+
+    const std::array<float, 256>& sRGBToLinearTable() {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> values{};
+            for(int i = 0 ; i < 256 ; ++i) {
+                const float c = static_cast<float>(i) / 255.0f;
+                values[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return values;
+        }();
+
+        return table;
+    }
+
+    const std::array<unsigned char, linearTableSize>& linearToSRGBTable() {
+        static const std::array<unsigned char, linearTableSize> table = [] {
+            std::array<unsigned char, linearTableSize> values{};
+            for(int i = 0 ; i < linearTableSize ; ++i) {
+                const float l = static_cast<float>(i) / static_cast<float>(linearTableSize - 1);
+                const float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                values[i] = static_cast<unsigned char>(std::lround(std::clamp(c, 0.0f, 1.0f) * 255.0f));
+            }
+            return values;
+        }();
+
+        return table;
+    }
+
+    /**
+     * @brief Splits count items across the thread pool, or runs them directly when there are too few of them
+     */
+    template<typename Function>
+    void parallelSpans(std::size_t count, Function&& function) {
+        constexpr std::size_t threshold = 1 << 16;
+
+        if(count < threshold) {
+            function(std::size_t{0}, count);
+            return;
+        }
+
+        ThreadPool::global().parallelFor(0, static_cast<unsigned>(count), [&function](unsigned first, unsigned last) {
+            function(static_cast<std::size_t>(first), static_cast<std::size_t>(last));
+        }, threshold / 4);
+    }
+
+    /**
+     * @brief Exact division by 255 of a product of two bytes, rounded to nearest
+     */
+    inline unsigned char divide255(unsigned value) {
+        value += 128;
+        return static_cast<unsigned char>((value + (value >> 8)) >> 8);
+    }
+}
+
+float sRGBToLinear(unsigned char value) {
+    return sRGBToLinearTable()[value];
+}
+
+unsigned char linearToSRGB(float value) {
+    const int index = static_cast<int>(std::clamp(value, 0.0f, 1.0f) * (linearTableSize - 1) + 0.5f);
+    return linearToSRGBTable()[index];
+}
+
+unsigned short floatToHalf(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, 4);
+
+    const std::uint32_t sign = (bits >> 16) & 0x8000u;
+    const int exponent = static_cast<int>((bits >> 23) & 0xFFu) - 127 + 15;
+    std::uint32_t mantissa = bits & 0x7FFFFFu;
+
+    if(((bits >> 23) & 0xFFu) == 0xFFu) { // Infinity and NaN
+        return static_cast<unsigned short>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+    }
+
+    if(exponent >= 31) { // Overflow
+        return static_cast<unsigned short>(sign | 0x7C00u);
+    }
+
+    if(exponent <= 0) { // Subnormal or zero
+        if(exponent < -10) { return static_cast<unsigned short>(sign); }
+
+        mantissa |= 0x800000u;
+        const int shift = 14 - exponent;
+        std::uint32_t half = mantissa >> shift;
+
+        // Round to nearest even
+        const std::uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        const std::uint32_t halfway = 1u << (shift - 1);
+        if(remainder > halfway || (remainder == halfway && (half & 1u))) { ++half; }
+
+        return static_cast<unsigned short>(sign | half);
+    }
+
+    std::uint32_t half = sign | (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13);
+
+    const std::uint32_t remainder = mantissa & 0x1FFFu;
+    if(remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) { ++half; } // May carry into the exponent
+
+    return static_cast<unsigned short>(half);
+}
+
+float halfToFloat(unsigned short value) {
+    const std::uint32_t sign = (value & 0x8000u) << 16;
+    std::uint32_t exponent = (value >> 10) & 0x1Fu;
+    std::uint32_t mantissa = value & 0x3FFu;
+
+    std::uint32_t bits;
+    if(exponent == 0x1Fu) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else if(exponent != 0) {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    } else if(mantissa == 0) {
+        bits = sign;
+    } else {
+        // Normalize the subnormal
+        exponent = 127 - 15 + 1;
+        while(!(mantissa & 0x400u)) {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, 4);
+    return result;
+}
+
+void sRGBToLinear(const unsigned char* source, float* destination, std::size_t count) {
+    const std::array<float, 256>& table = sRGBToLinearTable();
+
+    for(std::size_t i = 0 ; i < count ; ++i) {
+        destination[i] = table[source[i]];
+    }
+}
+
+void linearToSRGB(const float* source, unsigned char* destination, std::size_t count) {
+    const std::array<unsigned char, linearTableSize>& table = linearToSRGBTable();
+    std::size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(static_cast<float>(linearTableSize - 1));
+
+    alignas(16) std::int32_t indices[4];
+    for(; i + 4 <= count ; i += 4) {
+        const __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i), zero), one);
+        _mm_store_si128(reinterpret_cast<__m128i*>(indices), _mm_cvtps_epi32(_mm_mul_ps(value, scale)));
+
+        destination[i] = table[indices[0]];
+        destination[i + 1] = table[indices[1]];
+        destination[i + 2] = table[indices[2]];
+        destination[i + 3] = table[indices[3]];
+    }
+#endif
+
+    for(; i < count ; ++i) {
+        destination[i] = linearToSRGB(source[i]);
+    }
+}
+
+void bytesToFloats(const unsigned char* source, float* destination, std::size_t count) {
+    std::size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+
+    for(; i + 16 <= count ; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+        const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+        _mm_storeu_ps(destination + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), scale));
+        _mm_storeu_ps(destination + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), scale));
+        _mm_storeu_ps(destination + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), scale));
+        _mm_storeu_ps(destination + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), scale));
+    }
+#endif
+
+    for(; i < count ; ++i) {
+        destination[i] = static_cast<float>(source[i]) / 255.0f;
+    }
+}
+
+void floatsToBytes(const float* source, unsigned char* destination, std::size_t count) {
+    std::size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128 scale = _mm_set1_ps(255.0f);
+
+    for(; i + 16 <= count ; i += 16) {
+        // Saturating packs take care of the clamping
+        const __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(source + i), scale));
+        const __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(source + i + 4), scale));
+        const __m128i c = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(source + i + 8), scale));
+        const __m128i d = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(source + i + 12), scale));
+
+        const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), bytes);
+    }
+#endif
+
+    for(; i < count ; ++i) {
+        destination[i] = static_cast<unsigned char>(std::lround(std::clamp(source[i], 0.0f, 1.0f) * 255.0f));
+    }
+}
+
+void floatsToHalves(const float* source, unsigned short* destination, std::size_t count) {
+    std::size_t i = 0;
+
+#ifdef __F16C__
+    for(; i + 8 <= count ; i += 8) {
+        const __m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), halves);
+    }
+#endif
+
+    for(; i < count ; ++i) {
+        destination[i] = floatToHalf(source[i]);
+    }
+}
+
+void halvesToFloats(const unsigned short* source, float* destination, std::size_t count) {
+    std::size_t i = 0;
+
+#ifdef __F16C__
+    for(; i + 8 <= count ; i += 8) {
+        const __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        _mm256_storeu_ps(destination + i, _mm256_cvtph_ps(halves));
+    }
+#endif
+
+    for(; i < count ; ++i) {
+        destination[i] = halfToFloat(source[i]);
+    }
+}
+
+void rgbToRGBA(const unsigned char* source, unsigned char* destination, std::size_t count, unsigned char alpha) {
+    std::size_t i = 0;
+
+#ifdef __SSSE3__
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alphas = _mm_set1_epi32(static_cast<int>(static_cast<unsigned>(alpha) << 24));
+
+    // Each load reads 16 bytes for 4 pixels (12 bytes), stay clear of the end of the source
+    for(; i + 6 <= count ; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 3 * i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 4 * i), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alphas));
+    }
+#endif
+
+    for(; i < count ; ++i) {
+        destination[4 * i] = source[3 * i];
+        destination[4 * i + 1] = source[3 * i + 1];
+        destination[4 * i + 2] = source[3 * i + 2];
+        destination[4 * i + 3] = alpha;
+    }
+}
+
+void rgbaToRGB(const unsigned char* source, unsigned char* destination, std::size_t count) {
+    std::size_t i = 0;
+
+#ifdef __SSSE3__
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    // Each store writes 16 bytes for 4 pixels (12 bytes), stay clear of the end of the destination
+    for(; i + 6 <= count ; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 4 * i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 3 * i), _mm_shuffle_epi8(pixels, shuffle));
+    }
+#endif
+
+    for(; i < count ; ++i) {
+        destination[3 * i] = source[4 * i];
+        destination[3 * i + 1] = source[4 * i + 1];
+        destination[3 * i + 2] = source[4 * i + 2];
+    }
+}
+
+void swizzle(const unsigned char* source, unsigned char* destination, std::size_t count, int channels,
+             const std::array<int, 4>& order) {
+    std::size_t i = 0;
+
+#ifdef __SSSE3__
+    if(channels == 4 && source != destination) {
+        alignas(16) char mask[16];
+        for(int p = 0 ; p < 4 ; ++p) {
+            for(int c = 0 ; c < 4 ; ++c) { mask[4 * p + c] = static_cast<char>(4 * p + order[c]); }
+        }
+        const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+
+        for(; i + 4 <= count ; i += 4) {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 4 * i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 4 * i), _mm_shuffle_epi8(pixels, shuffle));
+        }
+    }
+#endif
+
+    unsigned char pixel[4];
+    for(; i < count ; ++i) {
+        for(int c = 0 ; c < channels ; ++c) { pixel[c] = source[channels * i + order[c]]; }
+        std::memcpy(destination + channels * i, pixel, channels);
+    }
+}
+
+void premultiplyAlpha(const unsigned char* source, unsigned char* destination, std::size_t count) {
+    std::size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i colorMask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+    const __m128i alphaLane = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+    const __m128i half = _mm_set1_epi16(128);
+
+    auto multiply = [&](__m128i pixels) {
+        __m128i alphas = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        alphas = _mm_or_si128(_mm_and_si128(alphas, colorMask), alphaLane); // Alpha is multiplied by 255 / 255
+
+        __m128i product = _mm_add_epi16(_mm_mullo_epi16(pixels, alphas), half);
+        return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+    };
+
+    for(; i + 4 <= count ; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 4 * i));
+        const __m128i low = multiply(_mm_unpacklo_epi8(pixels, zero));
+        const __m128i high = multiply(_mm_unpackhi_epi8(pixels, zero));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 4 * i), _mm_packus_epi16(low, high));
+    }
+#endif
+
+    for(; i < count ; ++i) {
+        const unsigned alpha = source[4 * i + 3];
+        for(int c = 0 ; c < 3 ; ++c) { destination[4 * i + c] = divide255(source[4 * i + c] * alpha); }
+        destination[4 * i + 3] = static_cast<unsigned char>(alpha);
+    }
+}
+
+void unpremultiplyAlpha(const unsigned char* source, unsigned char* destination, std::size_t count) {
+    for(std::size_t i = 0 ; i < count ; ++i) {
+        const unsigned alpha = source[4 * i + 3];
+
+        for(int c = 0 ; c < 3 ; ++c) {
+            destination[4 * i + c] = alpha ? static_cast<unsigned char>(std::min((source[4 * i + c] * 255u + alpha / 2) / alpha, 255u)) : 0;
+        }
+        destination[4 * i + 3] = static_cast<unsigned char>(alpha);
+    }
+}
+
+ImageData convertChannels(const ImageData& image, int colorChannels) {
+    const int channels = image.getColorChannels();
+    if(channels == colorChannels) { return image; }
+
+    if(colorChannels < 1 || colorChannels > 4) {
+        throw std::invalid_argument{"An image has between 1 and 4 color channels."};
+    }
+
+    const std::size_t pixels = static_cast<std::size_t>(image.getWidth()) * image.getHeight();
+    const unsigned char* source = image.getData();
+
+    ImageData result{image.getWidth(), image.getHeight(), colorChannels};
+    unsigned char* destination = result.getData();
+
+    parallelSpans(pixels, [&](std::size_t first, std::size_t last) {
+        if(channels == 3 && colorChannels == 4) {
+            rgbToRGBA(source + 3 * first, destination + 4 * first, last - first);
+            return;
+        }
+
+        if(channels == 4 && colorChannels == 3) {
+            rgbaToRGB(source + 4 * first, destination + 3 * first, last - first);
+            return;
+        }
+
+        for(std::size_t i = first ; i < last ; ++i) {
+            const unsigned char* in = source + channels * i;
+            unsigned char* out = destination + colorChannels * i;
+
+            unsigned char rgba[4];
+            if(channels >= 3) {
+                std::memcpy(rgba, in, 3);
+            } else {
+                rgba[0] = rgba[1] = rgba[2] = in[0];
+            }
+            rgba[3] = (channels == 4) ? in[3] : (channels == 2) ? in[1] : 255;
+
+            if(colorChannels >= 3) {
+                std::memcpy(out, rgba, 3);
+            } else {
+                // Rec. 709 luma
+                out[0] = static_cast<unsigned char>((54 * rgba[0] + 183 * rgba[1] + 19 * rgba[2] + 128) >> 8);
+            }
+
+            if(colorChannels == 2 || colorChannels == 4) { out[colorChannels - 1] = rgba[3]; }
+        }
+    });
+
+    return result;
+}
+
+std::vector<float> toFloats(const ImageData& image, bool sRGB) {
+    const int channels = image.getColorChannels();
+    const std::size_t pixels = static_cast<std::size_t>(image.getWidth()) * image.getHeight();
+    const unsigned char* source = image.getData();
+
+    std::vector<float> result(pixels * channels);
+
+    parallelSpans(pixels, [&](std::size_t first, std::size_t last) {
+        const std::size_t begin = first * channels;
+        const std::size_t count = (last - first) * channels;
+
+        bytesToFloats(source + begin, result.data() + begin, count);
+
+        // Alpha stays linear, only the color channels are decoded
+        if(sRGB) {
+            const int colors = (channels == 2 || channels == 4) ? channels - 1 : channels;
+            for(std::size_t i = first ; i < last ; ++i) {
+                sRGBToLinear(source + i * channels, result.data() + i * channels, colors);
+            }
+        }
+    });
+
+    return result;
+}
+
+ImageData fromFloats(const float* texels, int width, int height, int colorChannels, bool sRGB) {
+    const std::size_t pixels = static_cast<std::size_t>(width) * height;
+
+    ImageData result{width, height, colorChannels};
+    unsigned char* destination = result.getData();
+
+    parallelSpans(pixels, [&](std::size_t first, std::size_t last) {
+        const std::size_t begin = first * colorChannels;
+        floatsToBytes(texels + begin, destination + begin, (last - first) * colorChannels);
+
+        if(sRGB) {
+            const int colors = (colorChannels == 2 || colorChannels == 4) ? colorChannels - 1 : colorChannels;
+            for(std::size_t i = first ; i < last ; ++i) {
+                linearToSRGB(texels + i * colorChannels, destination + i * colorChannels, colors);
+            }
+        }
+    });
+
+    return result;
+}
+
+std::vector<unsigned short> toHalves(const std::vector<float>& values) {
+    std::vector<unsigned short> result(values.size());
+
+    parallelSpans(values.size(), [&](std::size_t first, std::size_t last) {
+        floatsToHalves(values.data() + first, result.data() + first, last - first);
+    });
+
+    return result;
+}
+
+ImageData swizzle(const ImageData& image, const std::array<int, 4>& order) {
+    const int channels = image.getColorChannels();
+    const std::size_t pixels = static_cast<std::size_t>(image.getWidth()) * image.getHeight();
+    const unsigned char* source = image.getData();
+
+    ImageData result{image.getWidth(), image.getHeight(), channels};
+    unsigned char* destination = result.getData();
+
+    parallelSpans(pixels, [&](std::size_t first, std::size_t last) {
+        swizzle(source + first * channels, destination + first * channels, last - first, channels, order);
+    });
+
+    return result;
+}
+
+ImageData premultiplyAlpha(const ImageData& image) {
+    if(image.getColorChannels() != 4) {
+        throw std::invalid_argument{"Only RGBA images can be premultiplied."};
+    }
+
+    const std::size_t pixels = static_cast<std::size_t>(image.getWidth()) * image.getHeight();
+    const unsigned char* source = image.getData();
+
+    ImageData result{image.getWidth(), image.getHeight(), 4};
+    unsigned char* destination = result.getData();
+
+    parallelSpans(pixels, [&](std::size_t first, std::size_t last) {
+        premultiplyAlpha(source + 4 * first, destination + 4 * first, last - first);
+    });
+
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+/******************************************************************************************************
+ * @file  Profiler.cpp
+ * @brief Implementation of the Profiler class
+ ******************************************************************************************************/
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+    struct ThreadBuffer {
+        unsigned threadId;
+        std::string threadName;
+        std::mutex nameMutex;
+
+        // Only the owning thread writes, head is the number of events ever written
+        std::unique_ptr<Profiler::Event[]> events;
+        std::atomic<unsigned long long> head;
+    };
+
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    std::atomic<bool> enabled{true};
+
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> registry;
+    unsigned nextThreadId = 0;
+
+    std::atomic<const ThreadBuffer*> frameThread{nullptr};
+    std::atomic<long long> currentFrameStart{0};
+    std::atomic<long long> lastFrameStart{0};
+    std::atomic<long long> lastFrameEnd{0};
+
+    thread_local unsigned scopeDepth = 0;
+
+    // Buffers are shared with the registry so that the events of a thread outlive it
+    ThreadBuffer& localBuffer() {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+            auto created = std::make_shared<ThreadBuffer>();
+            created->events = std::make_unique<Profiler::Event[]>(Profiler::capacity);
+            created->head = 0;
+
+            std::lock_guard lock{registryMutex};
+            created->threadId = nextThreadId++;
+            created->threadName = "Thread " + std::to_string(created->threadId);
+            registry.push_back(created);
+
+            return created;
+        }();
+
+        return *buffer;
+    }
+
+    /**
+     * @brief Copies the events of a buffer, the ones overwritten by its thread during the copy are dropped, as well as
+     * the one it may be writing when the copy ends
+     */
+    std::vector<Profiler::Event> snapshot(const ThreadBuffer& buffer) {
+        const unsigned long long head = buffer.head.load(std::memory_order_acquire);
+        const unsigned long long first = head > Profiler::capacity ? head - Profiler::capacity : 0;
+
+        std::vector<Profiler::Event> events;
+        events.reserve(head - first);
+        for(unsigned long long i = first ; i < head ; ++i) {
+            events.push_back(buffer.events[i % Profiler::capacity]);
+        }
+
+        // The head is published after its slot is written, so the slot of the event at newHead - capacity may be torn
+        const unsigned long long newHead = buffer.head.load(std::memory_order_acquire);
+        if(newHead + 1 > first + Profiler::capacity) {
+            const std::size_t overwritten = std::min<std::size_t>(newHead + 1 - first - Profiler::capacity, events.size());
+            events.erase(events.begin(), events.begin() + static_cast<long>(overwritten));
+        }
+
+        return events;
+    }
+
+    std::string escape(const std::string& string) {
+        std::string escaped;
+        for(char c: string) {
+            if(c == '"' || c == '\\') { escaped += '\\'; }
+            escaped += c;
+        }
+
+        return escaped;
+    }
+}
+
+void Profiler::setEnabled(bool isEnabled) {
+    enabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+bool Profiler::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+long long Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::record(const char* name, long long start, long long end, unsigned depth) {
+    ThreadBuffer& buffer = localBuffer();
+
+    const unsigned long long head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[head % capacity] = Event{name, start, end, depth};
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = localBuffer();
+
+    std::lock_guard lock{buffer.nameMutex};
+    buffer.threadName = name;
+}
+
+void Profiler::beginFrame() {
+    const long long time = now();
+
+    frameThread.store(&localBuffer(), std::memory_order_relaxed);
+    lastFrameStart.store(currentFrameStart.exchange(time, std::memory_order_relaxed), std::memory_order_relaxed);
+    lastFrameEnd.store(time, std::memory_order_relaxed);
+}
+
+std::vector<Profiler::Event> Profiler::getLastFrame(long long& start, long long& end) {
+    start = lastFrameStart.load(std::memory_order_relaxed);
+    end = lastFrameEnd.load(std::memory_order_relaxed);
+
+    const ThreadBuffer* buffer = frameThread.load(std::memory_order_relaxed);
+    if(!buffer || start == end) { return {}; }
+
+    std::vector<Event> events = snapshot(*buffer);
+    std::erase_if(events, [start, end](const Event& event) { return event.start < start || event.end > end; });
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.start < b.start; });
+
+    return events;
+}
+
+std::vector<Profiler::ThreadEvents> Profiler::collect() {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard lock{registryMutex};
+        buffers = registry;
+    }
+
+    std::vector<ThreadEvents> threads;
+    threads.reserve(buffers.size());
+    for(const std::shared_ptr<ThreadBuffer>& buffer: buffers) {
+        std::lock_guard lock{buffer->nameMutex};
+        threads.push_back(ThreadEvents{buffer->threadId, buffer->threadName, snapshot(*buffer)});
+    }
+
+    return threads;
+}
+
+void Profiler::writeChromeTrace(const std::string& path) {
+    std::ofstream file{path};
+    if(!file.is_open()) {
+        throw std::runtime_error{"Failed to open \"" + path + "\"."};
+    }
+
+    const std::vector<ThreadEvents> threads = collect();
+
+    // Complete events ("X") with timestamps and durations in microseconds
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+    bool first = true;
+    for(const ThreadEvents& thread: threads) {
+        file << (first ? "" : ",\n") << R"({"name": "thread_name", "ph": "M", "pid": 1, "tid": )" << thread.threadId
+             << R"(, "args": {"name": ")" << escape(thread.threadName) << "\"}}";
+        first = false;
+
+        for(const Event& event: thread.events) {
+            file << ",\n{\"name\": \"" << escape(event.name) << R"(", "ph": "X", "pid": 1, "tid": )" << thread.threadId
+                 << ", \"ts\": " << static_cast<double>(event.start) / 1000.0
+                 << ", \"dur\": " << static_cast<double>(event.end - event.start) / 1000.0 << '}';
+        }
+    }
+
+    file << "\n]}\n";
+    std::cout << "LOG : Wrote trace to \"" << path << "\".\n";
+}
+
+ProfileScope::ProfileScope(const char* name) : name{}, start{}, depth{} {
+    if(!Profiler::isEnabled()) { return; }
+
+    this->name = name;
+    this->depth = scopeDepth++;
+    start = Profiler::now();
+}
+
+ProfileScope::~ProfileScope() {
+    if(!name) { return; }
+
+    Profiler::record(name, start, Profiler::now(), depth);
+    --scopeDepth;
+}
\ No newline at end of file
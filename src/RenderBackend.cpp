@@ -0,0 +1,30 @@
+/******************************************************************************************************
+ * @file  RenderBackend.cpp
+ * @brief Implementation of the OpenGLBackend class
+ ******************************************************************************************************/
+
+#include "RenderBackend.hpp"
+
+OpenGLBackend::OpenGLBackend(const Bindings& bindings) : bindings{bindings} { }
+
+void OpenGLBackend::useShader(const Shader& shader) {
+    shader.use();
+    if(bindings.shader) { bindings.shader(shader); }
+}
+
+void OpenGLBackend::bindMaterial(const Shader& shader, const Material& material) {
+    if(bindings.material) { bindings.material(shader, material); }
+}
+
+void OpenGLBackend::draw(const Shader& shader, Mesh& mesh, const Matrix4& model) {
+    if(bindings.model) { bindings.model(shader, model); }
+    mesh.draw();
+}
+
+void OpenGLBackend::drawInstanced(const Shader&, Mesh& mesh, const InstanceBuffer& instances) {
+    mesh.drawInstanced(instances);
+}
+
+void OpenGLBackend::drawIndirect(const Shader&, const IndirectDraws& draws) {
+    draws.draw();
+}
\ No newline at end of file
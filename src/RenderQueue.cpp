@@ -0,0 +1,165 @@
+/******************************************************************************************************
+ * @file  RenderQueue.cpp
+ * @brief Implementation of the RenderQueue class
+ ******************************************************************************************************/
+
+#include "RenderQueue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "Profiler.hpp"
+
+namespace {
+    // Widths of the fields of a key, from the most significant bits
+    constexpr unsigned PASS_BITS = 8;
+    constexpr unsigned SHADER_BITS = 12;
+    constexpr unsigned TEXTURE_BITS = 20;
+    constexpr unsigned DEPTH_BITS = 24;
+
+    static_assert(PASS_BITS + SHADER_BITS + TEXTURE_BITS + DEPTH_BITS == 64);
+
+    constexpr unsigned DEPTH_SHIFT = 0;
+    constexpr unsigned TEXTURE_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+    constexpr unsigned SHADER_SHIFT = TEXTURE_SHIFT + TEXTURE_BITS;
+    constexpr unsigned PASS_SHIFT = SHADER_SHIFT + SHADER_BITS;
+
+    constexpr std::uint64_t mask(unsigned bits) {
+        return (std::uint64_t{1} << bits) - 1;
+    }
+}
+
+RenderQueue::RenderQueue() : camera{}, maxDepth{1.0f} { }
+
+void RenderQueue::begin(const Point& camera, float maxDepth) {
+    commands.clear();
+    entries.clear();
+
+    this->camera = camera;
+    this->maxDepth = maxDepth;
+}
+
+void RenderQueue::submit(RenderPass pass, const Shader& shader, const Material& material, Mesh& mesh, const Matrix4& model) {
+    // Matrices are row major, the translation is the last column
+    const Point position{model.values[0][3], model.values[1][3], model.values[2][3]};
+    const float depth = length(position - camera) / maxDepth;
+
+    entries.push_back({makeKey(pass, shader.id, material.texture ? material.texture->getId() : 0, depth),
+                       static_cast<std::uint32_t>(commands.size())});
+    commands.push_back({&mesh, material, &shader, model, nullptr, nullptr});
+}
+
+void RenderQueue::submit(RenderPass pass, const Shader& shader, const Material& material, Mesh& mesh,
+                         const InstanceBuffer& instances) {
+    entries.push_back({makeKey(pass, shader.id, material.texture ? material.texture->getId() : 0, 0.0f),
+                       static_cast<std::uint32_t>(commands.size())});
+    commands.push_back({&mesh, material, &shader, Matrix4{}, &instances, nullptr});
+}
+
+void RenderQueue::submit(RenderPass pass, const Shader& shader, const Material& material, const IndirectDraws& draws) {
+    entries.push_back({makeKey(pass, shader.id, material.texture ? material.texture->getId() : 0, 0.0f),
+                       static_cast<std::uint32_t>(commands.size())});
+    commands.push_back({nullptr, material, &shader, Matrix4{}, nullptr, &draws});
+}
+
+void RenderQueue::sort() {
+    PROFILE_FUNCTION();
+
+    constexpr unsigned digits = sizeof(std::uint64_t);
+    const std::size_t count = entries.size();
+    if(count < 2) { return; }
+
+    // The histograms of every digit are built in a single pass over the keys
+    std::array<std::array<std::uint32_t, 256>, digits> histograms{};
+    for(const SortEntry& entry: entries) {
+        for(unsigned digit = 0 ; digit < digits ; ++digit) {
+            ++histograms[digit][(entry.key >> (8 * digit)) & 0xFF];
+        }
+    }
+
+    scratch.resize(count);
+
+    for(unsigned digit = 0 ; digit < digits ; ++digit) {
+        std::array<std::uint32_t, 256>& histogram = histograms[digit];
+        const unsigned shift = 8 * digit;
+
+        // Every key has the same byte, the order would not change
+        if(histogram[(entries.front().key >> shift) & 0xFF] == count) { continue; }
+
+        std::uint32_t offset = 0;
+        for(std::uint32_t& bucket: histogram) {
+            const std::uint32_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+
+        for(const SortEntry& entry: entries) {
+            scratch[histogram[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+
+        entries.swap(scratch);
+    }
+}
+
+void RenderQueue::execute(RenderPass pass, RenderBackend& backend) const {
+    PROFILE_FUNCTION();
+
+    const std::uint64_t first = static_cast<std::uint64_t>(pass) << PASS_SHIFT;
+    const std::uint64_t last = first | mask(PASS_SHIFT);
+
+    auto begin = std::lower_bound(entries.begin(), entries.end(), first,
+                                  [](const SortEntry& entry, std::uint64_t key) { return entry.key < key; });
+    const auto end = std::upper_bound(begin, entries.end(), last,
+                                      [](std::uint64_t key, const SortEntry& entry) { return key < entry.key; });
+
+    const Shader* shader = nullptr;
+    const Texture* texture = nullptr;
+
+    for( ; begin != end ; ++begin) {
+        const DrawCommand& command = commands[begin->index];
+
+        if(command.shader != shader) {
+            shader = command.shader;
+            backend.useShader(*shader);
+
+            // A new shader does not know about the previous material
+            texture = command.material.texture;
+            backend.bindMaterial(*shader, command.material);
+        } else if(command.material.texture != texture) {
+            texture = command.material.texture;
+            backend.bindMaterial(*shader, command.material);
+        }
+
+        if(command.indirect) {
+            backend.drawIndirect(*shader, *command.indirect);
+        } else if(command.instances) {
+            backend.drawInstanced(*shader, *command.mesh, *command.instances);
+        } else {
+            backend.draw(*shader, *command.mesh, command.model);
+        }
+    }
+}
+
+void RenderQueue::execute(RenderPass pass, const Bindings& bindings) const {
+    OpenGLBackend backend{bindings};
+    execute(pass, backend);
+}
+
+const std::vector<RenderQueue::DrawCommand>& RenderQueue::getCommands() const {
+    return commands;
+}
+
+std::size_t RenderQueue::getSize() const {
+    return commands.size();
+}
+
+std::uint64_t RenderQueue::makeKey(RenderPass pass, unsigned shader, unsigned texture, float depth) {
+    const float clamped = std::clamp(depth, 0.0f, 1.0f);
+    const auto quantized = static_cast<std::uint64_t>(clamped * static_cast<float>(mask(DEPTH_BITS)));
+
+    return (static_cast<std::uint64_t>(pass) & mask(PASS_BITS)) << PASS_SHIFT
+           | (static_cast<std::uint64_t>(shader) & mask(SHADER_BITS)) << SHADER_SHIFT
+           | (static_cast<std::uint64_t>(texture) & mask(TEXTURE_BITS)) << TEXTURE_SHIFT
+           | quantized << DEPTH_SHIFT;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+/******************************************************************************************************
+ * @file  RenderStats.cpp
+ * @brief Implementation of the RenderStats struct
+ ******************************************************************************************************/
+
+#include "RenderStats.hpp"
+
+#include <glad/glad.h>
+
+namespace {
+    RenderStats current{};
+}
+
+RenderStats& RenderStats::frame() {
+    return current;
+}
+
+void RenderStats::reset() {
+    current = RenderStats{};
+}
+
+unsigned long long RenderStats::triangleCount(unsigned primitive, unsigned long long count) {
+    switch(primitive) {
+        case GL_TRIANGLES:
+            return count / 3;
+        case GL_TRIANGLE_STRIP:
+        case GL_TRIANGLE_FAN:
+            return count >= 3 ? count - 2 : 0;
+        default:
+            return 0;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,223 @@
+/******************************************************************************************************
+ * @file  Scene.cpp
+ * @brief Implementation of the Scene class
+ ******************************************************************************************************/
+
+#include "Scene.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "maths/constants.hpp"
+#include "maths/transformations.hpp"
+#include "Profiler.hpp"
+
+Scene::Scene(TextureCache& textures)
+    : ceres{textures.get(ceresPath)},
+//      earth{textures.get("data/textures/earth.jpg")},
+//      texCube{textures.get("data/textures/cube.png")},
+      axis{initAxis(5.0f)},
+      grid{initGrid()},
+      cube{initCube()},
+      disk{initDisk()},
+      cylinder{initCylinder()},
+      sphere{initSphere()},
+      cone{initCone()},
+      torus{initTorus()},
+      klein{initKleinBottle(256, 256)},
+      tube{initTube(Point(-5.0f, 0.0f, 5.0f),
+                    Point(-5.0f, 0.0f, -5.0f),
+                    Point(5.0f, 0.0f, -5.0f),
+                    Point(5.0f, 0.0f, 5.0f))},
+      pool{std::make_unique<GeometryPool>()},
+      movedObjects{}, instancesDirty{}, indirectDirty{}, occluded{}, radius{} {
+
+    if(IndirectDraws::isSupported()) {
+        indirect = std::make_unique<IndirectDraws>(*pool);
+    }
+}
+
+void Scene::populate(unsigned count, Mesh* mesh) {
+    constexpr float spacing = 3.0f;
+
+    objects.clear();
+    objects.reserve(count);
+    culler.clear();
+    culler.reserve(count);
+
+    std::vector<Mesh*> meshes{&cube, &sphere, &torus, &cone, &cylinder};
+    if(mesh) { meshes = {mesh}; }
+
+    // The cells closest to the origin are left empty for the textured sphere, there are at most 16 of them
+    const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count) + 16.0f)));
+    const float offset = static_cast<float>(side - 1) / 2.0f;
+
+    for(int i = 0 ; i < side * side && objects.size() < count ; ++i) {
+        const float x = (static_cast<float>(i % side) - offset) * spacing;
+        const float z = (static_cast<float>(i / side) - offset) * spacing;
+        if(std::abs(x) < 2.0f * spacing && std::abs(z) < 2.0f * spacing) { continue; }
+
+        const float angle = static_cast<float>((i * 37) % 360);
+        Mesh* objectMesh = meshes[i % meshes.size()];
+        const Matrix4 model = translate(x, 0.0f, z) * rotateY(angle);
+
+        objects.push_back(Object{objectMesh, model, transform(objectMesh->getAABB(), model),
+                                 transform(objectMesh->getBoundingSphere(), model)});
+        culler.add(objects.back().sphere, objects.back().box);
+    }
+
+    batches.clear();
+    for(Mesh* batchMesh: meshes) {
+        if(std::none_of(objects.begin(), objects.end(), [batchMesh](const Object& object) { return object.mesh == batchMesh; })) {
+            continue;
+        }
+
+        batches.push_back(Batch{batchMesh, std::make_unique<InstanceBuffer>()});
+    }
+
+    buildBVH();
+
+    visibility.assign(objects.size(), 1);
+    instancesDirty = true;
+    indirectDirty = true;
+
+    radius = offset * spacing;
+}
+
+float Scene::getRadius() const {
+    return radius;
+}
+
+void Scene::setModel(unsigned index, const Matrix4& model) {
+    Object& object = objects[index];
+    object.model = model;
+    object.box = transform(object.mesh->getAABB(), model);
+    object.sphere = transform(object.mesh->getBoundingSphere(), model);
+
+    culler.update(index, object.sphere, object.box);
+
+    // Refitting only loosens the boxes of the hierarchy, which gets slower to query the more objects moved
+    if(++movedObjects > objects.size() / 4) {
+        buildBVH();
+    } else {
+        bvh.update(index, object.box);
+    }
+
+    instancesDirty = true;
+    indirectDirty = true;
+}
+
+unsigned Scene::cull(const Frustum& frustum, bool hierarchical, OcclusionCuller* occlusion) {
+    unsigned visible = hierarchical ? bvh.cull(frustum, nextVisibility) : culler.cull(frustum, nextVisibility);
+
+    occluded = 0;
+    if(occlusion) {
+        PROFILE_SCOPE("Occlusion culling");
+
+        occlusion->wait();
+        for(std::size_t i = 0 ; i < objects.size() ; ++i) {
+            if(nextVisibility[i] && occlusion->isOccluded(objects[i].box)) {
+                nextVisibility[i] = 0;
+                ++occluded;
+            }
+        }
+        visible -= occluded;
+    }
+
+    if(nextVisibility != visibility) {
+        visibility.swap(nextVisibility);
+        instancesDirty = true;
+        indirectDirty = true;
+    }
+
+    return visible;
+}
+
+unsigned Scene::getOccludedCount() const {
+    return occluded;
+}
+
+void Scene::findOccluders(const Frustum& frustum, const Point& position, unsigned count, float maxDistance,
+                          std::vector<unsigned>& occluders) const {
+    const auto first = static_cast<std::ptrdiff_t>(occluders.size());
+    bvh.query(BoundingSphere{position, maxDistance}, occluders);
+    occluders.erase(std::remove_if(occluders.begin() + first, occluders.end(), [&](unsigned object) {
+        return !intersects(frustum, objects[object].box);
+    }), occluders.end());
+
+    const auto distance = [&](unsigned object) { return distanceSquared(objects[object].box, position); };
+    const auto middle = occluders.begin() + first + std::min<std::ptrdiff_t>(count, std::ssize(occluders) - first);
+    std::partial_sort(occluders.begin() + first, middle, occluders.end(),
+                      [&](unsigned object1, unsigned object2) { return distance(object1) < distance(object2); });
+    occluders.erase(middle, occluders.end());
+}
+
+void Scene::resetVisibility() {
+    occluded = 0;
+    if(std::find(visibility.begin(), visibility.end(), 0) == visibility.end()) { return; }
+
+    visibility.assign(objects.size(), 1);
+    instancesDirty = true;
+    indirectDirty = true;
+}
+
+void Scene::uploadInstances() {
+    if(!instancesDirty) { return; }
+    PROFILE_FUNCTION();
+
+    std::vector<std::vector<Instance>> instances(batches.size());
+    for(std::size_t i = 0 ; i < objects.size() ; ++i) {
+        if(!visibility[i]) { continue; }
+
+        const Object& object = objects[i];
+        for(std::size_t batch = 0 ; batch < batches.size() ; ++batch) {
+            if(batches[batch].mesh == object.mesh) {
+                instances[batch].push_back(Instance{object.model, White()});
+                break;
+            }
+        }
+    }
+
+    for(std::size_t batch = 0 ; batch < batches.size() ; ++batch) {
+        batches[batch].instances->update(instances[batch]);
+    }
+
+    instancesDirty = false;
+}
+
+void Scene::uploadIndirectDraws() {
+    if(!indirect || !indirectDirty) { return; }
+    PROFILE_FUNCTION();
+
+    indirect->clear();
+    for(std::size_t i = 0 ; i < objects.size() ; ++i) {
+        if(visibility[i]) { indirect->add(getRange(*objects[i].mesh), objects[i].model); }
+    }
+    indirect->upload();
+
+    indirectDirty = false;
+}
+
+const std::vector<std::uint8_t>& Scene::getVisibility() const {
+    return visibility;
+}
+
+const SceneBVH& Scene::getBVH() const {
+    return bvh;
+}
+
+GeometryPool::Range Scene::getRange(Mesh& mesh) {
+    const auto it = ranges.find(&mesh);
+    if(it != ranges.end()) { return it->second; }
+
+    return ranges[&mesh] = pool->add(mesh);
+}
+
+void Scene::buildBVH() {
+    std::vector<AABB> boxes;
+    boxes.reserve(objects.size());
+    for(const Object& object: objects) { boxes.push_back(object.box); }
+
+    bvh.build(boxes);
+    movedObjects = 0;
+}
\ No newline at end of file
@@ -0,0 +1,284 @@
+/******************************************************************************************************
+ * @file  SceneBVH.cpp
+ * @brief Implementation of the SceneBVH class
+ ******************************************************************************************************/
+
+#include "SceneBVH.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Profiler.hpp"
+
+namespace {
+    enum class Side { outside, intersecting, inside };
+
+    /**
+     * @brief Which side of the plane the box is on, inside meaning fully in front of it
+     */
+    Side classify(const Plane& plane, const Point& center, const Vector& extent) {
+        const float distance = dot(plane.normal, center) + plane.distance;
+        const float radius = std::abs(plane.normal.x) * extent.x + std::abs(plane.normal.y) * extent.y
+                           + std::abs(plane.normal.z) * extent.z;
+
+        if(distance < -radius) { return Side::outside; }
+        return distance >= radius ? Side::inside : Side::intersecting;
+    }
+}
+
+SceneBVH::SceneBVH() = default;
+
+void SceneBVH::build(const std::vector<AABB>& bounds) {
+    boxes = bounds;
+
+    BVH bvh = buildBVH(boxes);
+    nodes = std::move(bvh.nodes);
+    parents = std::move(bvh.parents);
+    objects = std::move(bvh.order);
+
+    leaves.resize(boxes.size());
+    for(unsigned node = 0 ; node < nodes.size() ; ++node) {
+        for(unsigned i = 0 ; i < nodes[node].count ; ++i) {
+            leaves[objects[nodes[node].first + i]] = node;
+        }
+    }
+}
+
+void SceneBVH::update(unsigned object, const AABB& box) {
+    boxes[object] = box;
+
+    unsigned node = leaves[object];
+    while(true) {
+        refitNode(node);
+        if(node == 0) { break; }
+
+        node = parents[node];
+    }
+}
+
+void SceneBVH::refit() {
+    PROFILE_FUNCTION();
+
+    // Children are always created after their parent
+    for(unsigned node = static_cast<unsigned>(nodes.size()) ; node-- > 0 ;) {
+        refitNode(node);
+    }
+}
+
+unsigned SceneBVH::cull(const Frustum& frustum, std::vector<std::uint8_t>& visibility) const {
+    PROFILE_FUNCTION();
+
+    visibility.assign(boxes.size(), 0);
+    if(nodes.empty()) { return 0; }
+
+    struct Entry {
+        unsigned node;
+        unsigned planes; // Bit i is set while the box may be behind plane i
+    };
+
+    unsigned visible = 0;
+    std::vector<Entry> stack{{0, 0x3F}};
+
+    while(!stack.empty()) {
+        const auto [index, planes] = stack.back();
+        stack.pop_back();
+
+        const Node& node = nodes[index];
+        const Point center = node.box.center();
+        const Vector extent = node.box.extent();
+
+        unsigned remaining = planes;
+        bool outside = false;
+        for(int i = 0 ; i < 6 && !outside ; ++i) {
+            if(!(planes & (1u << i))) { continue; }
+
+            const Side side = classify(frustum.planes[i], center, extent);
+            outside = side == Side::outside;
+            if(side == Side::inside) { remaining &= ~(1u << i); }
+        }
+
+        if(outside) { continue; }
+
+        if(remaining == 0) {
+            visible += acceptAll(index, visibility);
+        } else if(node.count == 0) {
+            stack.push_back(Entry{node.first, remaining});
+            stack.push_back(Entry{node.first + 1, remaining});
+        } else {
+            for(unsigned i = 0 ; i < node.count ; ++i) {
+                const unsigned object = objects[node.first + i];
+                const Point objectCenter = boxes[object].center();
+                const Vector objectExtent = boxes[object].extent();
+
+                bool objectVisible = true;
+                for(int j = 0 ; j < 6 && objectVisible ; ++j) {
+                    if(remaining & (1u << j)) {
+                        objectVisible = classify(frustum.planes[j], objectCenter, objectExtent) != Side::outside;
+                    }
+                }
+
+                visibility[object] = objectVisible;
+                visible += objectVisible;
+            }
+        }
+    }
+
+    return visible;
+}
+
+std::optional<SceneBVH::Hit> SceneBVH::raycast(const Ray& ray, float maxDistance) const {
+    return raycast(ray, {}, maxDistance);
+}
+
+std::optional<SceneBVH::Hit> SceneBVH::raycast(const Ray& ray, const std::function<float(unsigned)>& hitObject,
+                                               float maxDistance) const {
+    if(nodes.empty()) { return std::nullopt; }
+
+    const Vector inverseDirection = 1.0f / ray.direction;
+
+    std::optional<Hit> hit;
+    float closest = maxDistance;
+
+    struct Entry {
+        unsigned node;
+        float distance;
+    };
+
+    std::vector<Entry> stack;
+    const float rootDistance = intersect(ray, inverseDirection, nodes[0].box);
+    if(rootDistance < closest) { stack.push_back(Entry{0, rootDistance}); }
+
+    while(!stack.empty()) {
+        const auto [index, distance] = stack.back();
+        stack.pop_back();
+
+        // A closer hit may have been found since the node was pushed
+        if(distance >= closest) { continue; }
+
+        const Node& node = nodes[index];
+        if(node.count > 0) {
+            for(unsigned i = 0 ; i < node.count ; ++i) {
+                const unsigned object = objects[node.first + i];
+
+                float objectDistance = intersect(ray, inverseDirection, boxes[object]);
+                if(objectDistance < closest && hitObject) { objectDistance = hitObject(object); }
+
+                if(objectDistance < closest) {
+                    closest = objectDistance;
+                    hit = Hit{object, objectDistance};
+                }
+            }
+
+            continue;
+        }
+
+        Entry nearest{node.first, intersect(ray, inverseDirection, nodes[node.first].box)};
+        Entry farthest{node.first + 1, intersect(ray, inverseDirection, nodes[node.first + 1].box)};
+        if(farthest.distance < nearest.distance) { std::swap(nearest, farthest); }
+
+        // The nearest child is popped first
+        if(farthest.distance < closest) { stack.push_back(farthest); }
+        if(nearest.distance < closest) { stack.push_back(nearest); }
+    }
+
+    return hit;
+}
+
+void SceneBVH::query(const AABB& box, std::vector<unsigned>& objects) const {
+    if(nodes.empty()) { return; }
+
+    std::vector<unsigned> stack{0};
+    while(!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+
+        if(!intersects(node.box, box)) { continue; }
+
+        if(node.count == 0) {
+            stack.push_back(node.first);
+            stack.push_back(node.first + 1);
+            continue;
+        }
+
+        for(unsigned i = 0 ; i < node.count ; ++i) {
+            const unsigned object = this->objects[node.first + i];
+            if(intersects(boxes[object], box)) { objects.push_back(object); }
+        }
+    }
+}
+
+void SceneBVH::query(const BoundingSphere& sphere, std::vector<unsigned>& objects) const {
+    if(nodes.empty()) { return; }
+
+    std::vector<unsigned> stack{0};
+    while(!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+
+        if(!intersects(node.box, sphere)) { continue; }
+
+        if(node.count == 0) {
+            stack.push_back(node.first);
+            stack.push_back(node.first + 1);
+            continue;
+        }
+
+        for(unsigned i = 0 ; i < node.count ; ++i) {
+            const unsigned object = this->objects[node.first + i];
+            if(intersects(boxes[object], sphere)) { objects.push_back(object); }
+        }
+    }
+}
+
+float SceneBVH::getCost() const {
+    return surfaceAreaCost(nodes);
+}
+
+const AABB& SceneBVH::getBox(unsigned object) const {
+    return boxes[object];
+}
+
+unsigned SceneBVH::getSize() const {
+    return static_cast<unsigned>(boxes.size());
+}
+
+unsigned SceneBVH::getNodeCount() const {
+    return static_cast<unsigned>(nodes.size());
+}
+
+const std::vector<SceneBVH::Node>& SceneBVH::getNodes() const {
+    return nodes;
+}
+
+void SceneBVH::refitNode(unsigned node) {
+    Node& current = nodes[node];
+
+    if(current.count == 0) {
+        current.box = nodes[current.first].box;
+        current.box.extend(nodes[current.first + 1].box);
+        return;
+    }
+
+    current.box = AABB::empty();
+    for(unsigned i = 0 ; i < current.count ; ++i) {
+        current.box.extend(boxes[objects[current.first + i]]);
+    }
+}
+
+unsigned SceneBVH::acceptAll(unsigned node, std::vector<std::uint8_t>& visibility) const {
+    // Splits partition the objects of a node in place, so the objects below it are contiguous
+    // and range from those of its leftmost leaf to those of its rightmost one
+    unsigned leftmost = node;
+    while(nodes[leftmost].count == 0) { leftmost = nodes[leftmost].first; }
+
+    unsigned rightmost = node;
+    while(nodes[rightmost].count == 0) { rightmost = nodes[rightmost].first + 1; }
+
+    const unsigned begin = nodes[leftmost].first;
+    const unsigned end = nodes[rightmost].first + nodes[rightmost].count;
+    for(unsigned i = begin ; i < end ; ++i) {
+        visibility[objects[i]] = 1;
+    }
+
+    return end - begin;
+}
\ No newline at end of file
@@ -0,0 +1,217 @@
+/******************************************************************************************************
+ * @file  SceneGraph.cpp
+ * @brief Implementation of the SceneGraph class
+ ******************************************************************************************************/
+
+#include "SceneGraph.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Profiler.hpp"
+
+namespace {
+    // Checking the flags of a node costs far less than waking a thread, only large levels are split
+    constexpr unsigned grain = 1 << 14;
+}
+
+SceneGraph::SceneGraph(ThreadPool& pool) : pool{pool}, levels{0}, sorted{true}, dirtyCount{}, changedCount{} { }
+
+void SceneGraph::clear() {
+    parents.clear();
+    depths.clear();
+    locals.clear();
+    worlds.clear();
+    dirty.clear();
+    changed.clear();
+    nodes.clear();
+    slots.clear();
+
+    levels = {0};
+    sorted = true;
+    dirtyCount = 0;
+    changedCount = 0;
+}
+
+void SceneGraph::reserve(unsigned count) {
+    parents.reserve(count);
+    depths.reserve(count);
+    locals.reserve(count);
+    worlds.reserve(count);
+    dirty.reserve(count);
+    changed.reserve(count);
+    nodes.reserve(count);
+    slots.reserve(count);
+}
+
+SceneGraph::Node SceneGraph::add(const Matrix4& local, Node parent) {
+    if(parent != none && parent >= slots.size()) {
+        throw std::runtime_error{"The parent of a node must be in the same scene graph"};
+    }
+
+    const auto node = static_cast<Node>(slots.size());
+    const auto slot = static_cast<unsigned>(nodes.size());
+    const unsigned parentSlot = parent == none ? none : slots[parent];
+    const unsigned depth = parent == none ? 0 : depths[parentSlot] + 1;
+
+    // Appending to the deepest level keeps the slots sorted, as long as the parent is not before the previous one
+    if(sorted && depth == getLevelCount()) {
+        levels.push_back(slot + 1);
+    } else if(sorted && depth + 1 == getLevelCount() && (parentSlot == none || parentSlot >= parents.back())) {
+        ++levels.back();
+    } else {
+        sorted = false;
+    }
+
+    parents.push_back(parentSlot);
+    depths.push_back(depth);
+    locals.push_back(local);
+    worlds.push_back(local);
+    dirty.push_back(1);
+    changed.push_back(0);
+    nodes.push_back(node);
+    slots.push_back(slot);
+    ++dirtyCount;
+
+    return node;
+}
+
+void SceneGraph::setLocal(Node node, const Matrix4& local) {
+    const unsigned slot = slots[node];
+    locals[slot] = local;
+
+    if(!dirty[slot]) {
+        dirty[slot] = 1;
+        ++dirtyCount;
+    }
+}
+
+const Matrix4& SceneGraph::getLocal(Node node) const {
+    return locals[slots[node]];
+}
+
+const Matrix4& SceneGraph::getWorld(Node node) const {
+    return worlds[slots[node]];
+}
+
+SceneGraph::Node SceneGraph::getParent(Node node) const {
+    const unsigned parent = parents[slots[node]];
+    return parent == none ? none : nodes[parent];
+}
+
+bool SceneGraph::hasChanged(Node node) const {
+    return changed[slots[node]] != 0;
+}
+
+unsigned SceneGraph::update() {
+    PROFILE_FUNCTION();
+
+    if(!sorted) { sort(); }
+
+    if(dirtyCount == 0) {
+        if(changedCount != 0) { std::fill(changed.begin(), changed.end(), 0); }
+        changedCount = 0;
+        return 0;
+    }
+
+    // The flags of the level above are final when a level starts, a node changes when it or its parent does
+    std::atomic<unsigned> updated = 0;
+    for(unsigned level = 0 ; level + 1 < levels.size() ; ++level) {
+        pool.parallelFor(levels[level], levels[level + 1], [&](unsigned first, unsigned last) {
+            unsigned count = 0;
+            for(unsigned slot = first ; slot < last ; ++slot) {
+                const unsigned parent = parents[slot];
+                const bool change = dirty[slot] || (parent != none && changed[parent]);
+
+                changed[slot] = change;
+                if(!change) { continue; }
+
+                dirty[slot] = 0;
+                worlds[slot] = parent == none ? locals[slot] : worlds[parent] * locals[slot];
+                ++count;
+            }
+
+            updated += count;
+        }, grain);
+    }
+
+    dirtyCount = 0;
+    changedCount = updated;
+
+    return changedCount;
+}
+
+unsigned SceneGraph::getSize() const {
+    return static_cast<unsigned>(nodes.size());
+}
+
+unsigned SceneGraph::getLevelCount() const {
+    return static_cast<unsigned>(levels.size()) - 1;
+}
+
+void SceneGraph::sort() {
+    PROFILE_FUNCTION();
+
+    const auto count = static_cast<unsigned>(nodes.size());
+
+    // Children of each slot, contiguous and in the order they were added
+    std::vector<unsigned> firstChild(count + 1, 0);
+    for(unsigned parent: parents) {
+        if(parent != none) { ++firstChild[parent + 1]; }
+    }
+    for(unsigned slot = 0 ; slot < count ; ++slot) { firstChild[slot + 1] += firstChild[slot]; }
+
+    std::vector<unsigned> children(firstChild.back());
+    std::vector<unsigned> cursors(firstChild.begin(), firstChild.end() - 1);
+    for(unsigned slot = 0 ; slot < count ; ++slot) {
+        if(parents[slot] != none) { children[cursors[parents[slot]]++] = slot; }
+    }
+
+    // Breadth first, so that the children of a level follow the order of their parents, which are then read in order
+    std::vector<unsigned> order;
+    order.reserve(count);
+    for(unsigned slot = 0 ; slot < count ; ++slot) {
+        if(parents[slot] == none) { order.push_back(slot); }
+    }
+
+    levels = {0};
+    for(unsigned first = 0 ; first < order.size() ; ) {
+        const auto last = static_cast<unsigned>(order.size());
+        levels.push_back(last);
+
+        for(unsigned i = first ; i < last ; ++i) {
+            order.insert(order.end(), children.begin() + firstChild[order[i]], children.begin() + firstChild[order[i] + 1]);
+        }
+        first = last;
+    }
+
+    std::vector<unsigned> moved(count);
+    for(unsigned slot = 0 ; slot < count ; ++slot) { moved[order[slot]] = slot; }
+
+    // Parents refer to slots, which move as well
+    const auto permute = [&moved](auto& values) {
+        std::remove_reference_t<decltype(values)> permuted(values.size());
+        for(unsigned slot = 0 ; slot < values.size() ; ++slot) { permuted[moved[slot]] = values[slot]; }
+        values.swap(permuted);
+    };
+
+    for(unsigned& parent: parents) {
+        if(parent != none) { parent = moved[parent]; }
+    }
+
+    permute(parents);
+    permute(depths);
+    permute(locals);
+    permute(worlds);
+    permute(dirty);
+    permute(changed);
+    permute(nodes);
+
+    for(unsigned slot = 0 ; slot < nodes.size() ; ++slot) {
+        slots[nodes[slot]] = slot;
+    }
+
+    sorted = true;
+}
\ No newline at end of file
@@ -10,7 +10,13 @@
 #include <iostream>
 #include <sstream>
 
+#include "MemoryTracker.hpp"
+#include "Profiler.hpp"
+#include "RenderStats.hpp"
+
 Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) : id(glCreateProgram()) {
+    PROFILE_SCOPE("Shader creation");
+
     /* Read Shaders */
     std::ifstream vertexFile{vertexPath};
     std::ifstream fragmentFile{fragmentPath};
@@ -100,52 +106,74 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) :
 
     glDeleteShader(vertexID);
     glDeleteShader(fragmentID);
+
+    // The size of the program binary is the closest thing to the video memory used by the program
+    MemoryTracker::track(MemoryTag::shaders, binarySize(), MemoryDomain::gpu);
 }
 
 Shader::~Shader() {
+    MemoryTracker::untrack(MemoryTag::shaders, binarySize(), MemoryDomain::gpu);
     glDeleteProgram(id);
 }
 
+unsigned long long Shader::binarySize() const {
+    int size = 0;
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &size);
+
+    return static_cast<unsigned long long>(size);
+}
+
 void Shader::use() const {
     glUseProgram(id);
+    ++RenderStats::frame().stateChanges;
 }
 
 void Shader::setUniform(const std::string& uniform, int value) const {
+    ++RenderStats::frame().uniformUploads;
     glUniform1i(glGetUniformLocation(id, uniform.c_str()), value);
 }
 
 void Shader::setUniform(const std::string& uniform, bool value) const {
+    ++RenderStats::frame().uniformUploads;
     glUniform1i(glGetUniformLocation(id, uniform.c_str()), static_cast<int>(value));
 }
 
 void Shader::setUniform(const std::string& uniform, float value) const {
+    ++RenderStats::frame().uniformUploads;
     glUniform1f(glGetUniformLocation(id, uniform.c_str()), value);
 }
 
 void Shader::setUniform(const std::string& uniform, float x, float y) const {
+    ++RenderStats::frame().uniformUploads;
     glUniform2f(glGetUniformLocation(id, uniform.c_str()), x, y);
 }
 
 void Shader::setUniform(const std::string& uniform, float x, float y, float z) const {
+    ++RenderStats::frame().uniformUploads;
     glUniform3f(glGetUniformLocation(id, uniform.c_str()), x, y, z);
 }
 
 void Shader::setUniform(const std::string& uniform, float x, float y, float z, float w) const {
+    ++RenderStats::frame().uniformUploads;
     glUniform4f(glGetUniformLocation(id, uniform.c_str()), x, y, z, w);
 }
 
 void Shader::setUniform(const std::string& uniform, const vec2& vec) const {
+    ++RenderStats::frame().uniformUploads;
     glUniform2fv(glGetUniformLocation(id, uniform.c_str()), 1, &vec.x);
 }
 
 void Shader::setUniform(const std::string& uniform, const vec3& vec) const {
+    ++RenderStats::frame().uniformUploads;
     glUniform3fv(glGetUniformLocation(id, uniform.c_str()), 1, &vec.x);
 }
 
 void Shader::setUniform(const std::string& uniform, const vec4& vec) const {
+    ++RenderStats::frame().uniformUploads;
     glUniform4fv(glGetUniformLocation(id, uniform.c_str()), 1, &vec.x);
 }
 
 void Shader::setUniform(const std::string& uniform, const Matrix4& matrix) const {
+    ++RenderStats::frame().uniformUploads;
     glUniformMatrix4fv(glGetUniformLocation(id, uniform.c_str()), 1, true, &matrix.values[0][0]);
 }
\ No newline at end of file
@@ -0,0 +1,694 @@
+/******************************************************************************************************
+ * @file  SoftwareRasterizer.cpp
+ * @brief Implementation of the SoftwareRasterizer class
+ ******************************************************************************************************/
+
+#include "SoftwareRasterizer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "Profiler.hpp"
+#include "maths/constants.hpp"
+
+namespace {
+    // Vertices are snapped to 1/16 of a pixel, which keeps the edge functions exact in double precision
+    constexpr float subpixels = 16.0f;
+
+    float snap(float coordinate) {
+        return std::round(coordinate * subpixels) / subpixels;
+    }
+
+    /**
+     * @brief Signed distances of a clip space position to the near and far planes, positive inside
+     */
+    float distance(const vec4& clip, unsigned plane) {
+        return plane == 0 ? clip.w + clip.z : clip.w - clip.z;
+    }
+
+    /**
+     * @brief Index of the first pixel whose center is at or after the coordinate, clamped to [0, size]
+     */
+    int firstPixel(float coordinate, int size) {
+        return static_cast<int>(std::clamp(std::ceil(coordinate - 0.5f), 0.0f, static_cast<float>(size)));
+    }
+
+    /**
+     * @brief Index of the last pixel whose center is at or before the coordinate, clamped to [-1, size - 1]
+     */
+    int lastPixel(float coordinate, int size) {
+        return static_cast<int>(std::clamp(std::floor(coordinate - 0.5f), -1.0f, static_cast<float>(size - 1)));
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer(int width, int height, ThreadPool& pool)
+    : width{width}, height{height}, stride{}, tilesX{}, tilesY{}, pool{pool},
+      cameraPosition{}, light{Point{}, Color{}, Color{}, Color{}}, material{}, culling{true},
+      program{Program::phong}, texture{}, occludedBlocks{} {
+
+    if(width <= 0 || height <= 0) {
+        throw std::runtime_error{"A software rasterizer needs a positive size"};
+    }
+
+    tilesX = (width + tileSize - 1) / tileSize;
+    tilesY = (height + tileSize - 1) / tileSize;
+    stride = tilesX * tileSize;
+
+    // Buffers cover whole tiles so that tiles never check the edges of the image
+    const std::size_t size = static_cast<std::size_t>(stride) * tilesY * tileSize;
+    colors.resize(size);
+    depths.resize(size);
+    blockDepths.resize(size / (blockSize * blockSize));
+    bins.resize(static_cast<std::size_t>(tilesX) * tilesY);
+
+    begin(Color{0.0f, 1.0f});
+}
+
+void SoftwareRasterizer::setProgram(const Shader& shader, Program program) {
+    programs[&shader] = program;
+}
+
+void SoftwareRasterizer::setTexture(const Texture& texture, const ImageData& image) {
+    textures[&texture] = &image;
+}
+
+void SoftwareRasterizer::setCamera(const Matrix4& view, const Matrix4& projection, const Point& position) {
+    viewProjection = projection * view;
+    cameraPosition = position;
+}
+
+void SoftwareRasterizer::setLighting(const Light& light, const PhongMaterial& material) {
+    this->light = light;
+    this->material = material;
+}
+
+void SoftwareRasterizer::setCulling(bool culling) {
+    this->culling = culling;
+}
+
+void SoftwareRasterizer::begin(const Color& background) {
+    PROFILE_FUNCTION();
+
+    std::fill(colors.begin(), colors.end(), background);
+    std::fill(depths.begin(), depths.end(), 1.0f);
+    std::fill(blockDepths.begin(), blockDepths.end(), 1.0f);
+
+    vertices.clear();
+    primitives.clear();
+    states.clear();
+    for(std::vector<unsigned>& bin: bins) {
+        bin.clear();
+    }
+
+    program = Program::phong;
+    texture = nullptr;
+    occludedBlocks = 0;
+}
+
+void SoftwareRasterizer::use(Program program) {
+    this->program = program;
+}
+
+void SoftwareRasterizer::bindTexture(const ImageData* texture) {
+    this->texture = texture;
+}
+
+void SoftwareRasterizer::draw(Mesh& mesh, const Matrix4& model) {
+    PROFILE_FUNCTION();
+
+    const unsigned primitive = mesh.getPrimitive();
+    if(primitive != GL_TRIANGLES && primitive != GL_LINES) { return; }
+
+    // Same normals as the ones computed on the first draw with OpenGL
+    const MeshArray<unsigned>& indices = *mesh.getIndices();
+    if(primitive == GL_TRIANGLES && mesh.getNormals()->empty() && !indices.empty()) { mesh.computeNormals(); }
+
+    const MeshArray<Point>& positions = *mesh.getPositions();
+    const MeshArray<Vector>& normals = *mesh.getNormals();
+    const MeshArray<Color>& meshColors = *mesh.getColors();
+    const MeshArray<TexCoord>& texcoords = *mesh.getTexcoords();
+
+    // The shader without light has no model matrix
+    const Matrix4 toWorld = program == Program::noLight ? Identity() : model;
+    const Matrix4 normalMatrix = transpose(inverse(toWorld));
+    const Matrix4 toClip = viewProjection * toWorld;
+
+    const auto first = static_cast<unsigned>(vertices.size());
+    const auto count = static_cast<unsigned>(positions.size());
+    vertices.resize(first + count);
+
+    // Missing attributes read the default values of OpenGL
+    pool.parallelFor(0, count, [&](unsigned begin, unsigned end) {
+        for(unsigned i = begin ; i < end ; ++i) {
+            const Point& position = positions[i];
+            Vertex& vertex = vertices[first + i];
+
+            vertex.clip = toClip * vec4{position.x, position.y, position.z, 1.0f};
+            vertex.position = toWorld * position;
+
+            if(i < normals.size()) {
+                const vec4 normal = normalMatrix * vec4{normals[i].x, normals[i].y, normals[i].z, 0.0f};
+                vertex.normal = Vector{normal.x, normal.y, normal.z};
+            } else {
+                vertex.normal = Vector{};
+            }
+
+            vertex.color = i < meshColors.size() ? meshColors[i] : Color{0.0f, 0.0f, 0.0f, 1.0f};
+            vertex.texcoord = i < texcoords.size() ? texcoords[i] : TexCoord{};
+        }
+    }, 4096);
+
+    states.push_back({program, program == Program::phong ? texture : nullptr});
+
+    const auto vertex = [&](unsigned i) { return first + (indices.empty() ? i : indices[i]); };
+    const auto elements = indices.empty() ? count : static_cast<unsigned>(indices.size());
+
+    if(primitive == GL_TRIANGLES) {
+        for(unsigned i = 0 ; i + 2 < elements ; i += 3) {
+            addTriangle(vertex(i), vertex(i + 1), vertex(i + 2));
+        }
+    } else {
+        for(unsigned i = 0 ; i + 1 < elements ; i += 2) {
+            addLine(vertex(i), vertex(i + 1));
+        }
+    }
+}
+
+void SoftwareRasterizer::finish() {
+    PROFILE_FUNCTION();
+
+    // Tiles hold very different numbers of primitives, threads take chunks of them as they finish theirs
+    pool.parallelFor(0, tilesX * tilesY, [this](unsigned first, unsigned last) {
+        for(unsigned tile = first ; tile < last ; ++tile) {
+            rasterizeTile(tile);
+        }
+    });
+}
+
+void SoftwareRasterizer::useShader(const Shader& shader) {
+    const auto it = programs.find(&shader);
+    if(it == programs.end()) {
+        throw std::runtime_error{"The software rasterizer has no program for this shader"};
+    }
+
+    use(it->second);
+}
+
+void SoftwareRasterizer::bindMaterial(const Shader&, const ::Material& material) {
+    if(!material.texture) {
+        bindTexture(nullptr);
+        return;
+    }
+
+    const auto it = textures.find(material.texture);
+    if(it == textures.end()) {
+        throw std::runtime_error{"The software rasterizer has no image for this texture"};
+    }
+
+    bindTexture(it->second);
+}
+
+void SoftwareRasterizer::draw(const Shader&, Mesh& mesh, const Matrix4& model) {
+    draw(mesh, model);
+}
+
+void SoftwareRasterizer::drawInstanced(const Shader&, Mesh&, const InstanceBuffer&) {
+    throw std::runtime_error{"The software rasterizer cannot draw instances, they only live on the GPU"};
+}
+
+void SoftwareRasterizer::drawIndirect(const Shader&, const IndirectDraws&) {
+    throw std::runtime_error{"The software rasterizer cannot draw indirect draws, they only live on the GPU"};
+}
+
+ImageData SoftwareRasterizer::getImage() const {
+    ImageData image{width, height, 3};
+    unsigned char* data = image.getData();
+
+    for(int j = 0 ; j < height ; ++j) {
+        for(int i = 0 ; i < width ; ++i) {
+            const Color& color = colors[static_cast<std::size_t>(j) * stride + i];
+            const std::size_t pixel = 3 * (static_cast<std::size_t>(j) * width + i);
+
+            data[pixel] = static_cast<unsigned char>(std::clamp(color.r, 0.0f, 1.0f) * 255.0f + 0.5f);
+            data[pixel + 1] = static_cast<unsigned char>(std::clamp(color.g, 0.0f, 1.0f) * 255.0f + 0.5f);
+            data[pixel + 2] = static_cast<unsigned char>(std::clamp(color.b, 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+    }
+
+    return image;
+}
+
+int SoftwareRasterizer::getWidth() const {
+    return width;
+}
+
+int SoftwareRasterizer::getHeight() const {
+    return height;
+}
+
+unsigned long long SoftwareRasterizer::getPrimitiveCount() const {
+    return primitives.size();
+}
+
+unsigned long long SoftwareRasterizer::getOccludedBlockCount() const {
+    return occludedBlocks;
+}
+
+void SoftwareRasterizer::addTriangle(unsigned first, unsigned second, unsigned third) {
+    unsigned polygon[8] = {first, second, third};
+    unsigned count = 3;
+
+    for(unsigned plane = 0 ; plane < 2 ; ++plane) {
+        const unsigned outside = (distance(vertices[first].clip, plane) < 0.0f)
+                               + (distance(vertices[second].clip, plane) < 0.0f)
+                               + (distance(vertices[third].clip, plane) < 0.0f);
+        if(outside == 3) { return; }
+    }
+
+    // Sutherland-Hodgman against both planes. New vertices always go from the inside vertex to the outside one, so
+    // that triangles sharing a clipped edge get the same vertex
+    for(unsigned plane = 0 ; plane < 2 ; ++plane) {
+        unsigned clipped[8];
+        unsigned clippedCount = 0;
+
+        for(unsigned i = 0 ; i < count ; ++i) {
+            const unsigned current = polygon[i];
+            const unsigned next = polygon[(i + 1) % count];
+            const float currentDistance = distance(vertices[current].clip, plane);
+            const float nextDistance = distance(vertices[next].clip, plane);
+
+            if(currentDistance >= 0.0f) { clipped[clippedCount++] = current; }
+            if((currentDistance >= 0.0f) == (nextDistance >= 0.0f)) { continue; }
+
+            const bool currentInside = currentDistance >= 0.0f;
+            const unsigned inside = currentInside ? current : next;
+            const unsigned outside = currentInside ? next : current;
+            const float insideDistance = currentInside ? currentDistance : nextDistance;
+            const float outsideDistance = currentInside ? nextDistance : currentDistance;
+
+            vertices.push_back(interpolate(vertices[inside], vertices[outside], insideDistance / (insideDistance - outsideDistance)));
+            clipped[clippedCount++] = static_cast<unsigned>(vertices.size() - 1);
+        }
+
+        std::copy(clipped, clipped + clippedCount, polygon);
+        count = clippedCount;
+        if(count < 3) { return; }
+    }
+
+    for(unsigned i = 1 ; i + 1 < count ; ++i) {
+        setupTriangle({polygon[0], polygon[i], polygon[i + 1]});
+    }
+}
+
+void SoftwareRasterizer::addLine(unsigned first, unsigned second) {
+    unsigned line[2] = {first, second};
+
+    for(unsigned plane = 0 ; plane < 2 ; ++plane) {
+        const float firstDistance = distance(vertices[line[0]].clip, plane);
+        const float secondDistance = distance(vertices[line[1]].clip, plane);
+
+        if(firstDistance < 0.0f && secondDistance < 0.0f) { return; }
+        if(firstDistance >= 0.0f && secondDistance >= 0.0f) { continue; }
+
+        const unsigned outside = firstDistance < 0.0f ? 0 : 1;
+        const float insideDistance = outside == 0 ? secondDistance : firstDistance;
+        const float outsideDistance = outside == 0 ? firstDistance : secondDistance;
+
+        vertices.push_back(interpolate(vertices[line[1 - outside]], vertices[line[outside]],
+                                       insideDistance / (insideDistance - outsideDistance)));
+        line[outside] = static_cast<unsigned>(vertices.size() - 1);
+    }
+
+    setupLine(line);
+}
+
+void SoftwareRasterizer::setupTriangle(const unsigned (&indices)[3]) {
+    Primitive triangle{};
+    triangle.line = false;
+
+    for(unsigned k = 0 ; k < 3 ; ++k) {
+        const vec4& clip = vertices[indices[k]].clip;
+        if(clip.w <= 0.0f) { return; }
+
+        const float inverseW = 1.0f / clip.w;
+
+        triangle.x[k] = snap((clip.x * inverseW * 0.5f + 0.5f) * static_cast<float>(width));
+        triangle.y[k] = snap((clip.y * inverseW * 0.5f + 0.5f) * static_cast<float>(height));
+        triangle.z[k] = clip.z * inverseW * 0.5f + 0.5f;
+        triangle.inverseW[k] = inverseW;
+        triangle.vertices[k] = indices[k];
+    }
+
+    // Twice the signed area, positive for counterclockwise triangles which face the camera like in OpenGL
+    double area = (static_cast<double>(triangle.x[1]) - triangle.x[0]) * (static_cast<double>(triangle.y[2]) - triangle.y[0])
+                - (static_cast<double>(triangle.x[2]) - triangle.x[0]) * (static_cast<double>(triangle.y[1]) - triangle.y[0]);
+    if(area == 0.0 || (culling && area < 0.0)) { return; }
+
+    if(area < 0.0) {
+        std::swap(triangle.x[1], triangle.x[2]);
+        std::swap(triangle.y[1], triangle.y[2]);
+        std::swap(triangle.z[1], triangle.z[2]);
+        std::swap(triangle.inverseW[1], triangle.inverseW[2]);
+        std::swap(triangle.vertices[1], triangle.vertices[2]);
+        area = -area;
+    }
+
+    triangle.minX = firstPixel(std::min({triangle.x[0], triangle.x[1], triangle.x[2]}), width);
+    triangle.maxX = lastPixel(std::max({triangle.x[0], triangle.x[1], triangle.x[2]}), width);
+    triangle.minY = firstPixel(std::min({triangle.y[0], triangle.y[1], triangle.y[2]}), height);
+    triangle.maxY = lastPixel(std::max({triangle.y[0], triangle.y[1], triangle.y[2]}), height);
+    if(triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) { return; }
+
+    triangle.inverseArea = static_cast<float>(1.0 / area);
+    triangle.zx = 0.0f;
+    triangle.zy = 0.0f;
+    triangle.z0 = 0.0f;
+
+    for(unsigned k = 0 ; k < 3 ; ++k) {
+        const unsigned i = (k + 1) % 3;
+        const unsigned j = (k + 2) % 3;
+
+        triangle.a[k] = static_cast<double>(triangle.y[i]) - triangle.y[j];
+        triangle.b[k] = static_cast<double>(triangle.x[j]) - triangle.x[i];
+        triangle.c[k] = static_cast<double>(triangle.x[i]) * triangle.y[j] - static_cast<double>(triangle.x[j]) * triangle.y[i];
+
+        // Going counterclockwise with rows bottom first, left edges go down and top edges go left
+        triangle.topLeft[k] = triangle.a[k] > 0.0 || (triangle.a[k] == 0.0 && triangle.b[k] < 0.0);
+
+        triangle.zx += triangle.z[k] * static_cast<float>(triangle.a[k] / area);
+        triangle.zy += triangle.z[k] * static_cast<float>(triangle.b[k] / area);
+        triangle.z0 += triangle.z[k] * static_cast<float>(triangle.c[k] / area);
+    }
+
+    triangle.minZ = std::min({triangle.z[0], triangle.z[1], triangle.z[2]});
+    triangle.state = static_cast<unsigned>(states.size() - 1);
+
+    primitives.push_back(triangle);
+    bin(static_cast<unsigned>(primitives.size() - 1));
+}
+
+void SoftwareRasterizer::setupLine(const unsigned (&indices)[2]) {
+    Primitive line{};
+    line.line = true;
+
+    for(unsigned k = 0 ; k < 2 ; ++k) {
+        const vec4& clip = vertices[indices[k]].clip;
+        if(clip.w <= 0.0f) { return; }
+
+        const float inverseW = 1.0f / clip.w;
+
+        line.x[k] = snap((clip.x * inverseW * 0.5f + 0.5f) * static_cast<float>(width));
+        line.y[k] = snap((clip.y * inverseW * 0.5f + 0.5f) * static_cast<float>(height));
+        line.z[k] = clip.z * inverseW * 0.5f + 0.5f;
+        line.inverseW[k] = inverseW;
+        line.vertices[k] = indices[k];
+    }
+
+    // The third vertex is never weighted
+    line.vertices[2] = indices[0];
+
+    // Lines cover the pixels their centers cross, which may be up to half a pixel beyond the end points
+    line.minX = firstPixel(std::min(line.x[0], line.x[1]) - 0.5f, width);
+    line.maxX = lastPixel(std::max(line.x[0], line.x[1]) + 0.5f, width);
+    line.minY = firstPixel(std::min(line.y[0], line.y[1]) - 0.5f, height);
+    line.maxY = lastPixel(std::max(line.y[0], line.y[1]) + 0.5f, height);
+    if(line.minX > line.maxX || line.minY > line.maxY) { return; }
+
+    line.minZ = std::min(line.z[0], line.z[1]);
+    line.state = static_cast<unsigned>(states.size() - 1);
+
+    primitives.push_back(line);
+    bin(static_cast<unsigned>(primitives.size() - 1));
+}
+
+void SoftwareRasterizer::bin(unsigned primitive) {
+    const Primitive& bounds = primitives[primitive];
+
+    for(int tileY = bounds.minY / tileSize ; tileY <= bounds.maxY / tileSize ; ++tileY) {
+        for(int tileX = bounds.minX / tileSize ; tileX <= bounds.maxX / tileSize ; ++tileX) {
+            bins[static_cast<std::size_t>(tileY) * tilesX + tileX].push_back(primitive);
+        }
+    }
+}
+
+SoftwareRasterizer::Vertex SoftwareRasterizer::interpolate(const Vertex& from, const Vertex& to, float t) {
+    Vertex vertex;
+    vertex.clip = from.clip + t * (to.clip - from.clip);
+    vertex.position = from.position + t * (to.position - from.position);
+    vertex.normal = from.normal + t * (to.normal - from.normal);
+    vertex.color = from.color + t * (to.color - from.color);
+    vertex.texcoord = from.texcoord + t * (to.texcoord - from.texcoord);
+
+    return vertex;
+}
+
+void SoftwareRasterizer::rasterizeTile(unsigned tile) {
+    const int tileX = static_cast<int>(tile % tilesX) * tileSize;
+    const int tileY = static_cast<int>(tile / tilesX) * tileSize;
+    const int blocksX = stride / blockSize;
+
+    for(unsigned index: bins[tile]) {
+        const Primitive& primitive = primitives[index];
+        std::uint64_t written = primitive.line ? rasterizeLine(primitive, tileX, tileY)
+                                               : rasterizeTriangle(primitive, tileX, tileY);
+
+        for( ; written ; written &= written - 1) {
+            const int block = std::countr_zero(written);
+            updateBlockDepth((tileY / blockSize + block / blocksPerTile) * blocksX + tileX / blockSize + block % blocksPerTile);
+        }
+    }
+}
+
+std::uint64_t SoftwareRasterizer::rasterizeTriangle(const Primitive& triangle, int tileX, int tileY) {
+    const int minX = std::max(triangle.minX, tileX);
+    const int maxX = std::min(triangle.maxX, tileX + tileSize - 1);
+    const int minY = std::max(triangle.minY, tileY);
+    const int maxY = std::min(triangle.maxY, tileY + tileSize - 1);
+    const int blocksX = stride / blockSize;
+
+    std::uint64_t written = 0;
+    unsigned long long occluded = 0;
+
+    for(int blockY = minY / blockSize * blockSize ; blockY <= maxY ; blockY += blockSize) {
+        for(int blockX = minX / blockSize * blockSize ; blockX <= maxX ; blockX += blockSize) {
+            // Every pixel of the block is already closer than the triangle
+            if(triangle.minZ >= blockDepths[static_cast<std::size_t>(blockY / blockSize) * blocksX + blockX / blockSize]) {
+                ++occluded;
+                continue;
+            }
+
+            // The block is outside of an edge when its pixel center farthest inside is outside
+            bool outside = false;
+            for(unsigned k = 0 ; k < 3 ; ++k) {
+                const double x = (triangle.a[k] > 0.0 ? blockX + blockSize - 1 : blockX) + 0.5;
+                const double y = (triangle.b[k] > 0.0 ? blockY + blockSize - 1 : blockY) + 0.5;
+                outside |= triangle.a[k] * x + triangle.b[k] * y + triangle.c[k] < 0.0;
+            }
+            if(outside) { continue; }
+
+            bool wrote = false;
+            for(int y = std::max(blockY, minY) ; y <= std::min(blockY + blockSize - 1, maxY) ; ++y) {
+                const double centerY = y + 0.5;
+                const double rows[3] = {triangle.b[0] * centerY + triangle.c[0],
+                                        triangle.b[1] * centerY + triangle.c[1],
+                                        triangle.b[2] * centerY + triangle.c[2]};
+                const float rowZ = triangle.zy * static_cast<float>(centerY) + triangle.z0;
+
+                for(int x = blockX ; x < blockX + blockSize ; x += 4) {
+                    float* depth = depths.data() + static_cast<std::size_t>(y) * stride + x;
+                    alignas(16) float edges[3][4];
+                    alignas(16) float z[4];
+                    int mask;
+
+#ifdef __SSE2__
+                    // Edge functions two pixels at a time in double precision, the depth four at a time
+                    const __m128d zero = _mm_setzero_pd();
+                    const __m128d left = _mm_add_pd(_mm_set1_pd(x + 0.5), _mm_setr_pd(0.0, 1.0));
+                    const __m128d right = _mm_add_pd(left, _mm_set1_pd(2.0));
+
+                    int inside = 0xF;
+                    for(unsigned k = 0 ; k < 3 ; ++k) {
+                        const __m128d a = _mm_set1_pd(triangle.a[k]);
+                        const __m128d row = _mm_set1_pd(rows[k]);
+                        const __m128d leftEdge = _mm_add_pd(_mm_mul_pd(a, left), row);
+                        const __m128d rightEdge = _mm_add_pd(_mm_mul_pd(a, right), row);
+
+                        __m128d leftInside = _mm_cmpgt_pd(leftEdge, zero);
+                        __m128d rightInside = _mm_cmpgt_pd(rightEdge, zero);
+                        if(triangle.topLeft[k]) {
+                            leftInside = _mm_or_pd(leftInside, _mm_cmpeq_pd(leftEdge, zero));
+                            rightInside = _mm_or_pd(rightInside, _mm_cmpeq_pd(rightEdge, zero));
+                        }
+
+                        inside &= _mm_movemask_pd(leftInside) | _mm_movemask_pd(rightInside) << 2;
+                        _mm_store_ps(edges[k], _mm_movelh_ps(_mm_cvtpd_ps(leftEdge), _mm_cvtpd_ps(rightEdge)));
+                    }
+                    if(!inside) { continue; }
+
+                    const __m128 centers = _mm_add_ps(_mm_set1_ps(static_cast<float>(x) + 0.5f), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+                    const __m128 depthZ = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.zx), centers), _mm_set1_ps(rowZ));
+                    _mm_store_ps(z, depthZ);
+                    mask = inside & _mm_movemask_ps(_mm_cmplt_ps(depthZ, _mm_loadu_ps(depth)));
+#else
+                    mask = 0;
+                    for(int lane = 0 ; lane < 4 ; ++lane) {
+                        const double center = x + 0.5 + lane;
+
+                        bool inside = true;
+                        for(unsigned k = 0 ; k < 3 ; ++k) {
+                            const double edge = triangle.a[k] * center + rows[k];
+                            inside &= edge > 0.0 || (triangle.topLeft[k] && edge == 0.0);
+                            edges[k][lane] = static_cast<float>(edge);
+                        }
+
+                        z[lane] = triangle.zx * ((static_cast<float>(x) + 0.5f) + static_cast<float>(lane)) + rowZ;
+                        if(inside && z[lane] < depth[lane]) { mask |= 1 << lane; }
+                    }
+#endif
+
+                    for( ; mask ; mask &= mask - 1) {
+                        const int lane = std::countr_zero(static_cast<unsigned>(mask));
+
+                        // Screen space weights, then divided by w to interpolate the attributes in perspective
+                        float weights[3];
+                        float sum = 0.0f;
+                        for(unsigned k = 0 ; k < 3 ; ++k) {
+                            weights[k] = edges[k][lane] * triangle.inverseArea * triangle.inverseW[k];
+                            sum += weights[k];
+                        }
+                        for(float& weight: weights) {
+                            weight /= sum;
+                        }
+
+                        colors[static_cast<std::size_t>(y) * stride + x + lane] = shade(triangle, weights);
+                        depth[lane] = z[lane];
+                        wrote = true;
+                    }
+                }
+            }
+
+            if(wrote) {
+                written |= std::uint64_t{1} << ((blockY - tileY) / blockSize * blocksPerTile + (blockX - tileX) / blockSize);
+            }
+        }
+    }
+
+    if(occluded) { occludedBlocks += occluded; }
+
+    return written;
+}
+
+std::uint64_t SoftwareRasterizer::rasterizeLine(const Primitive& line, int tileX, int tileY) {
+    const float dx = line.x[1] - line.x[0];
+    const float dy = line.y[1] - line.y[0];
+    if(dx == 0.0f && dy == 0.0f) { return 0; }
+
+    // One pixel per column or row along the major axis, for the centers from the start included to the end excluded
+    const bool horizontal = std::abs(dx) >= std::abs(dy);
+    const float start = horizontal ? std::min(line.x[0], line.x[1]) : std::min(line.y[0], line.y[1]);
+    const float end = horizontal ? std::max(line.x[0], line.x[1]) : std::max(line.y[0], line.y[1]);
+    const int tileStart = horizontal ? tileX : tileY;
+    const int size = horizontal ? width : height;
+
+    const int first = std::max(firstPixel(start, size), tileStart);
+    const int last = std::min(firstPixel(end, size) - 1, tileStart + tileSize - 1);
+
+    std::uint64_t written = 0;
+
+    for(int major = first ; major <= last ; ++major) {
+        const float center = static_cast<float>(major) + 0.5f;
+        const float t = horizontal ? (center - line.x[0]) / dx : (center - line.y[0]) / dy;
+        const float minor = horizontal ? line.y[0] + t * dy : line.x[0] + t * dx;
+
+        const int x = horizontal ? major : static_cast<int>(std::floor(minor));
+        const int y = horizontal ? static_cast<int>(std::floor(minor)) : major;
+        if(x < tileX || x >= tileX + tileSize || x >= width || y < tileY || y >= tileY + tileSize || y >= height) { continue; }
+
+        const std::size_t pixel = static_cast<std::size_t>(y) * stride + x;
+        const float z = line.z[0] + t * (line.z[1] - line.z[0]);
+        if(!(z < depths[pixel])) { continue; }
+
+        const float firstWeight = (1.0f - t) * line.inverseW[0];
+        const float secondWeight = t * line.inverseW[1];
+        const float sum = firstWeight + secondWeight;
+        const float weights[3] = {firstWeight / sum, secondWeight / sum, 0.0f};
+
+        colors[pixel] = shade(line, weights);
+        depths[pixel] = z;
+        written |= std::uint64_t{1} << ((y - tileY) / blockSize * blocksPerTile + (x - tileX) / blockSize);
+    }
+
+    return written;
+}
+
+Color SoftwareRasterizer::shade(const Primitive& primitive, const float (&weights)[3]) const {
+    const State& state = states[primitive.state];
+    const Vertex& first = vertices[primitive.vertices[0]];
+    const Vertex& second = vertices[primitive.vertices[1]];
+    const Vertex& third = vertices[primitive.vertices[2]];
+
+    switch(state.program) {
+        case Program::light:
+            return light.diffuse;
+
+        case Program::noLight:
+            return weights[0] * first.color + weights[1] * second.color + weights[2] * third.color;
+
+        case Program::phong:
+            break;
+    }
+
+    const Point position = weights[0] * first.position + weights[1] * second.position + weights[2] * third.position;
+    const Vector normal = weights[0] * first.normal + weights[1] * second.normal + weights[2] * third.normal;
+
+    Color color = light.ambient * material.ambient;
+
+    // Without normals, only the ambient light is left
+    if(dot(normal, normal) > 0.0f) {
+        const Vector unitNormal = normalize(normal);
+        const Vector lightDirection = normalize(light.position - position);
+        const Vector viewDirection = normalize(cameraPosition - position);
+        const Vector reflected = 2.0f * dot(lightDirection, unitNormal) * unitNormal - lightDirection;
+
+        const float diffuse = std::max(dot(unitNormal, lightDirection), 0.0f);
+        const float specular = std::pow(std::max(dot(viewDirection, reflected), 0.0f), material.shininess);
+
+        color += diffuse * (light.diffuse * material.diffuse) + specular * (light.specular * material.specular);
+    }
+
+    if(state.texture) {
+        color *= state.texture->sample(weights[0] * first.texcoord + weights[1] * second.texcoord + weights[2] * third.texcoord);
+    }
+
+    return color;
+}
+
+void SoftwareRasterizer::updateBlockDepth(int block) {
+    const int blocksX = stride / blockSize;
+    const float* row = depths.data() + static_cast<std::size_t>(block / blocksX) * blockSize * stride
+                     + static_cast<std::size_t>(block % blocksX) * blockSize;
+
+#ifdef __SSE2__
+    __m128 farthest = _mm_loadu_ps(row);
+    for(int y = 0 ; y < blockSize ; ++y, row += stride) {
+        farthest = _mm_max_ps(farthest, _mm_max_ps(_mm_loadu_ps(row), _mm_loadu_ps(row + 4)));
+    }
+
+    farthest = _mm_max_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(1, 0, 3, 2)));
+    farthest = _mm_max_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(2, 3, 0, 1)));
+    blockDepths[block] = _mm_cvtss_f32(farthest);
+#else
+    float farthest = row[0];
+    for(int y = 0 ; y < blockSize ; ++y, row += stride) {
+        farthest = std::max({farthest, row[0], row[1], row[2], row[3], row[4], row[5], row[6], row[7]});
+    }
+
+    blockDepths[block] = farthest;
+#endif
+}
\ No newline at end of file
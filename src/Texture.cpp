@@ -5,41 +5,131 @@
 
 #include "Texture.hpp"
 
-Texture::Texture() : id{} {
+#include <cstring>
+#include <iostream>
+
+#include "MemoryTracker.hpp"
+#include "MipChain.hpp"
+#include "RenderStats.hpp"
+
+// S3TC is an extension in OpenGL 4.6 so glad does not define its formats
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+Texture::Texture() : id{}, size{} {
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
-Texture::Texture(const ImageData& image) {
+Texture::Texture(const ImageData& image) : Texture{buildMipChain(image)} { }
+
+Texture::Texture(const std::vector<ImageData>& mipmaps) : id{}, size{} {
     glGenTextures(1, &id);
     glBindTexture(GL_TEXTURE_2D, id);
 
+    const int levelCount = static_cast<int>(mipmaps.size());
+
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
 
-    int format;
-    if(image.getColorChannels() == 4) {
-        format = GL_RGBA;
-    } else {
-        format = GL_RGB;
+    // Rows of RGB levels are not always 4 bytes aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for(int i = 0 ; i < levelCount ; ++i) {
+        upload(mipmaps[i], i);
     }
 
-    glTexImage2D(GL_TEXTURE_2D, 0, format, image.getWidth(), image.getHeight(),
-                 0, format, GL_UNSIGNED_BYTE, image.getData());
-    glGenerateMipmap(GL_TEXTURE_2D);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    MemoryTracker::track(MemoryTag::textures, size, MemoryDomain::gpu);
+}
+
+Texture::Texture(const CompressedImage& image) : id{}, size{} {
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D, id);
+
+    const int levelCount = static_cast<int>(image.getLevelCount());
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+    if(isCompressionSupported()) {
+        const unsigned format = (image.getFormat() == CompressionFormat::BC3) ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+                                                                              : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+
+        for(int i = 0 ; i < levelCount ; ++i) {
+            const CompressedImage::Level& level = image.getLevel(i);
+            glCompressedTexImage2D(GL_TEXTURE_2D, i, format, level.width, level.height, 0,
+                                   static_cast<int>(level.data.size()), level.data.data());
+        }
+        size = image.getSize();
+    } else {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for(int i = 0 ; i < levelCount ; ++i) {
+            upload(image.decode(i), i);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
 
     glBindTexture(GL_TEXTURE_2D, 0);
+
+    MemoryTracker::track(MemoryTag::textures, size, MemoryDomain::gpu);
 }
 
 Texture::~Texture() {
     glDeleteTextures(1, &id);
+    MemoryTracker::untrack(MemoryTag::textures, size, MemoryDomain::gpu);
 }
 
 void Texture::bind() const {
     glBindTexture(GL_TEXTURE_2D, id);
+    ++RenderStats::frame().stateChanges;
 }
 
 unsigned Texture::getId() const {
     return id;
 }
+
+unsigned long long Texture::getSize() const {
+    return size;
+}
+
+unsigned long long Texture::getResidentBytes() {
+    return MemoryTracker::getUsage(MemoryTag::textures, MemoryDomain::gpu).current;
+}
+
+bool Texture::isCompressionSupported() {
+    // Looked up once, the application only ever creates one context
+    static const bool supported = [] {
+        int count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for(int i = 0 ; i < count ; ++i) {
+            const auto* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if(name && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0) { return true; }
+        }
+
+        std::cout << "LOG : S3TC is not supported, compressed textures are decompressed before being uploaded.\n";
+        return false;
+    }();
+
+    return supported;
+}
+
+void Texture::upload(const ImageData& level, int index) {
+    const int format = level.getColorChannels() == 4 ? GL_RGBA : GL_RGB;
+    glTexImage2D(GL_TEXTURE_2D, index, format, level.getWidth(), level.getHeight(),
+                 0, format, GL_UNSIGNED_BYTE, level.getData());
+
+    size += static_cast<unsigned long long>(level.getWidth()) * level.getHeight() * level.getColorChannels();
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+/******************************************************************************************************
+ * @file  TextureCache.cpp
+ * @brief Implementation of the TextureCache class
+ ******************************************************************************************************/
+
+#include "TextureCache.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+TextureCache::TextureCache(unsigned long long budget) : budget{budget}, statistics{} { }
+
+std::shared_ptr<Texture> TextureCache::get(const std::string& path) {
+    if(byPath.contains(path)) {
+        LRUList::iterator entry = byPath.at(path);
+        touch(entry);
+        ++statistics.hits;
+
+        return entry->texture;
+    }
+
+    // A different path can still point to an image that is already resident
+    const std::uint64_t hash = hashFile(path);
+
+    if(byHash.contains(hash)) {
+        LRUList::iterator entry = byHash.at(hash);
+        entry->paths.push_back(path);
+        byPath.emplace(path, entry);
+        touch(entry);
+        ++statistics.hits;
+
+        return entry->texture;
+    }
+
+    ++statistics.misses;
+
+    // Block compressed images are uploaded as they are, anything else goes through stb
+    std::shared_ptr<Texture> texture;
+    if(path.ends_with(".gtex")) {
+        texture = std::make_shared<Texture>(CompressedImage(path));
+    } else {
+        texture = std::make_shared<Texture>(ImageData(path));
+    }
+
+    entries.push_front(Entry{std::move(texture), hash, {path}});
+    byPath.emplace(path, entries.begin());
+    byHash.emplace(hash, entries.begin());
+
+    statistics.bytesResident += entries.front().texture->getSize();
+    ++statistics.textureCount;
+
+    trim();
+
+    return entries.front().texture;
+}
+
+void TextureCache::setBudget(unsigned long long bytes) {
+    budget = bytes;
+    trim();
+}
+
+unsigned long long TextureCache::getBudget() const {
+    return budget;
+}
+
+void TextureCache::trim() {
+    // Walk from the least recently used entry, skipping textures that are still in use
+    auto it = entries.end();
+    while(statistics.bytesResident > budget && it != entries.begin()) {
+        --it;
+
+        if(it->texture.use_count() == 1) {
+            LRUList::iterator unused = it;
+            ++it;
+            evict(unused);
+        }
+    }
+}
+
+unsigned long long TextureCache::release(unsigned long long bytes) {
+    unsigned long long released = 0;
+
+    auto it = entries.end();
+    while(released < bytes && it != entries.begin()) {
+        --it;
+
+        if(it->texture.use_count() == 1) {
+            released += it->texture->getSize();
+
+            LRUList::iterator unused = it;
+            ++it;
+            evict(unused);
+        }
+    }
+
+    return released;
+}
+
+void TextureCache::clear() {
+    for(auto it = entries.begin() ; it != entries.end() ;) {
+        if(it->texture.use_count() == 1) {
+            evict(it++);
+        } else {
+            ++it;
+        }
+    }
+}
+
+const TextureCache::Statistics& TextureCache::getStatistics() const {
+    return statistics;
+}
+
+void TextureCache::touch(LRUList::iterator entry) {
+    entries.splice(entries.begin(), entries, entry);
+}
+
+void TextureCache::evict(LRUList::iterator entry) {
+    for(const std::string& path: entry->paths) {
+        byPath.erase(path);
+    }
+    byHash.erase(entry->hash);
+
+    statistics.bytesResident -= entry->texture->getSize();
+    --statistics.textureCount;
+    ++statistics.evictions;
+
+    entries.erase(entry);
+}
+
+std::uint64_t TextureCache::hashFile(const std::string& path) {
+    std::ifstream file{path, std::ios::binary};
+    if(!file.is_open()) {
+        throw std::runtime_error{"Image was not found at path: \"" + path + "\"."};
+    }
+
+    // FNV-1a
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+
+    char buffer[1 << 16];
+    while(file) {
+        file.read(buffer, sizeof(buffer));
+        const std::streamsize count = file.gcount();
+
+        for(std::streamsize i = 0 ; i < count ; ++i) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 0x100000001b3ull;
+        }
+    }
+
+    return hash;
+}
\ No newline at end of file
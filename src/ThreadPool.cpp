@@ -0,0 +1,119 @@
+/******************************************************************************************************
+ * @file  ThreadPool.cpp
+ * @brief Implementation of the ThreadPool class
+ ******************************************************************************************************/
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#include "Profiler.hpp"
+
+ThreadPool::ThreadPool(unsigned threadCount) : stopping{false} {
+    threadCount = std::max(threadCount, 1u);
+
+    workers.reserve(threadCount);
+    for(unsigned i = 0 ; i < threadCount ; ++i) {
+        workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{mutex};
+        stopping = true;
+    }
+    condition.notify_all();
+
+    for(std::thread& worker: workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(unsigned begin, unsigned end, const std::function<void(unsigned, unsigned)>& function, unsigned grain) {
+    if(begin >= end) { return; }
+
+    const unsigned count = end - begin;
+    grain = std::max(grain, 1u);
+
+    // A few chunks per thread so that uneven chunks still balance out
+    const unsigned chunkSize = std::max(grain, count / (4 * getThreadCount() + 1) + 1);
+    const unsigned chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    if(chunkCount == 1) {
+        function(begin, end);
+        return;
+    }
+
+    struct State {
+        std::atomic<unsigned> next;
+        std::atomic<unsigned> done;
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+
+    // Helpers that start after every chunk was taken must not touch the caller's stack, hence the shared state
+    auto state = std::make_shared<State>();
+    state->next = 0;
+    state->done = 0;
+
+    auto runChunks = [state, begin, end, chunkSize, chunkCount, &function] {
+        unsigned chunk;
+        while((chunk = state->next.fetch_add(1)) < chunkCount) {
+            const unsigned first = begin + chunk * chunkSize;
+            function(first, std::min(first + chunkSize, end));
+
+            if(state->done.fetch_add(1) + 1 == chunkCount) {
+                std::lock_guard lock{state->mutex};
+                state->condition.notify_all();
+            }
+        }
+    };
+
+    const unsigned helpers = std::min(chunkCount - 1, getThreadCount());
+    for(unsigned i = 0 ; i < helpers ; ++i) {
+        enqueue(runChunks);
+    }
+
+    runChunks();
+
+    std::unique_lock lock{state->mutex};
+    state->condition.wait(lock, [&state, chunkCount] { return state->done == chunkCount; });
+}
+
+unsigned ThreadPool::getThreadCount() const {
+    return static_cast<unsigned>(workers.size());
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard lock{mutex};
+        tasks.push_back(std::move(task));
+    }
+    condition.notify_one();
+}
+
+void ThreadPool::work() {
+    while(true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock lock{mutex};
+            condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+
+            if(stopping && tasks.empty()) { return; }
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        PROFILE_SCOPE("ThreadPool task");
+        task();
+    }
+}
\ No newline at end of file
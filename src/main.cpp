@@ -4,12 +4,187 @@
 
 // Standard C++ Library Headers
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
 // User-Defined Headers
 #include "Application.hpp"
+#include "CompressedImage.hpp"
+#include "GeometryPool.hpp"
+#include "Profiler.hpp"
 
 // Main Function
-int main() {
+int main(int argc, char* argv[]) {
+    // Offline texture compression: --compress <image> <output.gtex> [bc1|bc3]
+    if(argc >= 4 && std::string(argv[1]) == "--compress") {
+        const std::string requested = argc >= 5 ? argv[4] : "";
+        if(argc > 5) {
+            std::cerr << "Unknown option " << argv[5] << '\n';
+            return 2;
+        }
+        if(!requested.empty() && requested != "bc1" && requested != "bc3") {
+            std::cerr << "Unknown compression format " << requested << ", expected bc1 or bc3\n";
+            return 2;
+        }
+
+        try {
+            const ImageData image{argv[2]};
+
+            CompressionFormat format = (image.getColorChannels() == 4) ? CompressionFormat::BC3 : CompressionFormat::BC1;
+            if(!requested.empty()) {
+                format = (requested == "bc3") ? CompressionFormat::BC3 : CompressionFormat::BC1;
+            }
+
+            const CompressedImage compressed{image, format};
+            compressed.write(argv[3]);
+
+            std::cout << "PSNR : " << psnr(image, compressed.decode()) << " dB\n";
+            return 0;
+        } catch(const std::exception& exception) {
+            std::cerr << "ERROR : " << exception.what() << '\n';
+            return 1;
+        }
+    }
+
+    // Offscreen rendering for CI :
+    // --headless [--software] [--frames n] [--width w] [--height h] [--output image] [--golden image] [--min-psnr dB]
+    // Frame statistics as JSON, in a window unless --headless is given :
+    // --benchmark [--headless] [--frames n] [--warmup n] [--objects n] [--width w] [--height h] [--output json]
+    //             [--spheres] [--instanced | --indirect] [--no-culling | --flat-culling] [--no-occlusion]
+    //             [--eye-level]
+    // Reference image traced on the CPU, offscreen :
+    // --path-trace [--samples n] [--bounces n] [--objects n] [--frame n] [--width w] [--height h] [--output image]
+    //              [--golden image] [--min-psnr dB]
+    // All of them accept [--trace json] to export the profiled scopes as a Chrome trace
+    const std::string mode = argc >= 2 ? argv[1] : "";
+    if(mode == "--headless" || mode == "--benchmark" || mode == "--path-trace") {
+        const bool benchmark = mode == "--benchmark";
+        const bool pathTrace = mode == "--path-trace";
+        bool headless = !benchmark;
+
+        HeadlessSettings headlessSettings;
+        BenchmarkSettings benchmarkSettings;
+        PathTracerSettings pathTracerSettings;
+        int width = 1280;
+        int height = 720;
+        std::string trace;
+
+        // Counts and sizes that parse but that no run accepts are invalid values as well
+        const auto positive = [](const std::string& value) {
+            const int number = std::stoi(value);
+            if(number <= 0) { throw std::invalid_argument{value}; }
+            return static_cast<unsigned>(number);
+        };
+
+        for(int i = 2 ; i < argc ; i += 2) {
+            const std::string option = argv[i];
+            if(option == "--headless") {
+                headless = true;
+                --i;
+                continue;
+            }
+
+            if(option == "--software" && !benchmark && !pathTrace) {
+                headlessSettings.software = true;
+                --i;
+                continue;
+            }
+
+            if(benchmark && (option == "--spheres" || option == "--instanced" || option == "--indirect"
+                             || option == "--no-culling" || option == "--flat-culling" || option == "--no-occlusion"
+                             || option == "--eye-level")) {
+                if(option == "--spheres") {
+                    benchmarkSettings.spheres = true;
+                } else if(option == "--eye-level") {
+                    benchmarkSettings.eyeLevel = true;
+                } else if(option == "--no-occlusion") {
+                    benchmarkSettings.occlusion = false;
+                } else if(option == "--no-culling" || option == "--flat-culling") {
+                    benchmarkSettings.culling = option == "--no-culling" ? Culling::none : Culling::flat;
+                } else {
+                    benchmarkSettings.drawPath = option == "--instanced" ? DrawPath::instanced : DrawPath::indirect;
+                }
+                --i;
+                continue;
+            }
+
+            if(i + 1 >= argc) {
+                std::cerr << "Missing value for " << option << '\n';
+                return 2;
+            }
+
+            const std::string value = argv[i + 1];
+
+            // Numbers that do not parse are usage errors as well, rather than exceptions escaping main
+            try {
+                if(pathTrace && (option == "--samples" || option == "--bounces" || option == "--frame")) {
+                    if(option == "--samples") {
+                        pathTracerSettings.samples = positive(value);
+                    } else if(option == "--bounces") {
+                        pathTracerSettings.bounces = std::stoul(value);
+                    } else {
+                        pathTracerSettings.frame = std::stoul(value);
+                    }
+                } else if(option == "--frames" && !pathTrace) {
+                    headlessSettings.frames = benchmarkSettings.frames = positive(value);
+                } else if(option == "--width") {
+                    width = static_cast<int>(positive(value));
+                } else if(option == "--height") {
+                    height = static_cast<int>(positive(value));
+                } else if(option == "--output") {
+                    headlessSettings.output = benchmarkSettings.output = pathTracerSettings.output = value;
+                } else if(option == "--trace") {
+                    trace = value;
+                } else if(option == "--golden" && !benchmark) {
+                    headlessSettings.golden = pathTracerSettings.golden = value;
+                } else if(option == "--min-psnr" && !benchmark) {
+                    headlessSettings.minPsnr = pathTracerSettings.minPsnr = std::stof(value);
+                } else if(option == "--warmup" && benchmark) {
+                    benchmarkSettings.warmupFrames = std::stoul(value);
+                } else if(option == "--objects" && (benchmark || pathTrace)) {
+                    benchmarkSettings.objectCount = pathTracerSettings.objectCount = std::stoul(value);
+                } else {
+                    std::cerr << "Unknown option " << option << '\n';
+                    return 2;
+                }
+            } catch(const std::logic_error&) {
+                std::cerr << "Invalid value for " << option << " : " << value << '\n';
+                return 2;
+            }
+        }
+
+        try {
+            std::cout << "\n------------ App Creation ------------\n";
+            Application app{"Graphics Engine", width, height, headless};
+
+            // Only known once there is a context, but still a usage error
+            if(benchmark && benchmarkSettings.drawPath == DrawPath::indirect && !IndirectDraws::isSupported()) {
+                std::cerr << "Multi-draw indirect is not supported by this context, use --instanced instead\n";
+                return 2;
+            }
+
+            bool passed = true;
+            if(benchmark) {
+                std::cout << "\n------------- Benchmark --------------\n";
+                app.runBenchmark(benchmarkSettings);
+            } else if(pathTrace) {
+                std::cout << "\n------------- Path Trace -------------\n";
+                passed = app.runPathTracer(pathTracerSettings);
+            } else {
+                std::cout << "\n----------- Headless Render ----------\n";
+                passed = app.runHeadless(headlessSettings);
+            }
+
+            if(!trace.empty()) { Profiler::writeChromeTrace(trace); }
+
+            std::cout << "\n---------- App Destruction -----------\n";
+            return passed ? 0 : 1;
+        } catch(const std::exception& exception) {
+            std::cerr << "ERROR : " << exception.what() << '\n';
+            return 1;
+        }
+    }
+
     std::cout << "\n------------ App Creation ------------\n";
     Application app{"Graphics Engine", 1900, 950};
 
@@ -0,0 +1,217 @@
+/******************************************************************************************************
+ * @file  bounds.cpp
+ * @brief Implementation of the bounding volumes
+ ******************************************************************************************************/
+
+#include "maths/bounds.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static_assert(sizeof(Point) == 3 * sizeof(float), "Points are read as packed floats");
+
+namespace {
+#ifdef __SSE2__
+    /**
+     * @brief Loads 4 consecutive points, stored x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3, as one register per coordinate
+     */
+    inline void loadPoints(const Point* points, __m128& x, __m128& y, __m128& z) {
+        const float* floats = &points->x;
+
+        const __m128 a = _mm_loadu_ps(floats);
+        const __m128 b = _mm_loadu_ps(floats + 4);
+        const __m128 c = _mm_loadu_ps(floats + 8);
+
+        x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+        y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)),
+                           _MM_SHUFFLE(2, 0, 2, 0));
+        z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)),
+                           _MM_SHUFFLE(2, 0, 2, 0));
+    }
+
+    inline float horizontalMin(__m128 v) {
+        v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        return _mm_cvtss_f32(v);
+    }
+
+    inline float horizontalMax(__m128 v) {
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        return _mm_cvtss_f32(v);
+    }
+#endif
+}
+
+AABB AABB::empty() {
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+    return AABB{Point{infinity, infinity, infinity}, Point{-infinity, -infinity, -infinity}};
+}
+
+bool AABB::isEmpty() const {
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+Point AABB::center() const {
+    return (min + max) * 0.5f;
+}
+
+Vector AABB::extent() const {
+    return (max - min) * 0.5f;
+}
+
+float AABB::surfaceArea() const {
+    if(isEmpty()) { return 0.0f; }
+
+    const Vector size = max - min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+void AABB::extend(const Point& point) {
+    min = Point{std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z)};
+    max = Point{std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z)};
+}
+
+void AABB::extend(const AABB& box) {
+    min = Point{std::min(min.x, box.min.x), std::min(min.y, box.min.y), std::min(min.z, box.min.z)};
+    max = Point{std::max(max.x, box.max.x), std::max(max.y, box.max.y), std::max(max.z, box.max.z)};
+}
+
+AABB computeAABB(const Point* points, std::size_t count) {
+    AABB box = AABB::empty();
+    std::size_t i = 0;
+
+#ifdef __SSE2__
+    if(count >= 4) {
+        __m128 minX = _mm_set1_ps(box.min.x), minY = minX, minZ = minX;
+        __m128 maxX = _mm_set1_ps(box.max.x), maxY = maxX, maxZ = maxX;
+
+        for( ; i + 4 <= count ; i += 4) {
+            __m128 x, y, z;
+            loadPoints(points + i, x, y, z);
+
+            minX = _mm_min_ps(minX, x);
+            minY = _mm_min_ps(minY, y);
+            minZ = _mm_min_ps(minZ, z);
+            maxX = _mm_max_ps(maxX, x);
+            maxY = _mm_max_ps(maxY, y);
+            maxZ = _mm_max_ps(maxZ, z);
+        }
+
+        box.min = Point{horizontalMin(minX), horizontalMin(minY), horizontalMin(minZ)};
+        box.max = Point{horizontalMax(maxX), horizontalMax(maxY), horizontalMax(maxZ)};
+    }
+#endif
+
+    for( ; i < count ; ++i) {
+        box.extend(points[i]);
+    }
+
+    return box;
+}
+
+BoundingSphere computeBoundingSphere(const Point* points, std::size_t count) {
+    return computeBoundingSphere(points, count, computeAABB(points, count));
+}
+
+BoundingSphere computeBoundingSphere(const Point* points, std::size_t count, const AABB& box) {
+    if(count == 0) { return BoundingSphere{Point{}, 0.0f}; }
+
+    const Point center = box.center();
+    float maxDistance = 0.0f;
+    std::size_t i = 0;
+
+#ifdef __SSE2__
+    if(count >= 4) {
+        const __m128 centerX = _mm_set1_ps(center.x);
+        const __m128 centerY = _mm_set1_ps(center.y);
+        const __m128 centerZ = _mm_set1_ps(center.z);
+        __m128 distances = _mm_setzero_ps();
+
+        for( ; i + 4 <= count ; i += 4) {
+            __m128 x, y, z;
+            loadPoints(points + i, x, y, z);
+
+            x = _mm_sub_ps(x, centerX);
+            y = _mm_sub_ps(y, centerY);
+            z = _mm_sub_ps(z, centerZ);
+
+            const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+            distances = _mm_max_ps(distances, distance);
+        }
+
+        maxDistance = horizontalMax(distances);
+    }
+#endif
+
+    for( ; i < count ; ++i) {
+        const Vector offset = points[i] - center;
+        maxDistance = std::max(maxDistance, dot(offset, offset));
+    }
+
+    return BoundingSphere{center, std::sqrt(maxDistance)};
+}
+
+AABB transform(const AABB& box, const Matrix4& matrix) {
+    if(box.isEmpty()) { return box; }
+
+    const Point center = box.center();
+    const Vector extent = box.extent();
+
+    // Matrices are row major, row i gives the coordinate i of the transformed point
+    float newCenter[3];
+    float newExtent[3];
+    for(int i = 0 ; i < 3 ; ++i) {
+        const float* row = matrix.values[i];
+
+        newCenter[i] = row[0] * center.x + row[1] * center.y + row[2] * center.z + row[3];
+        newExtent[i] = std::abs(row[0]) * extent.x + std::abs(row[1]) * extent.y + std::abs(row[2]) * extent.z;
+    }
+
+    const Point transformedCenter{newCenter[0], newCenter[1], newCenter[2]};
+    const Vector transformedExtent{newExtent[0], newExtent[1], newExtent[2]};
+
+    return AABB{transformedCenter - transformedExtent, transformedCenter + transformedExtent};
+}
+
+BoundingSphere transform(const BoundingSphere& sphere, const Matrix4& matrix) {
+    const Point center = matrix * sphere.center;
+
+    // The length of each column is the scale along the corresponding axis
+    float scale = 0.0f;
+    for(int j = 0 ; j < 3 ; ++j) {
+        const Vector column{matrix.values[0][j], matrix.values[1][j], matrix.values[2][j]};
+        scale = std::max(scale, dot(column, column));
+    }
+
+    return BoundingSphere{center, sphere.radius * std::sqrt(scale)};
+}
+
+bool intersects(const AABB& box1, const AABB& box2) {
+    return box1.min.x <= box2.max.x && box2.min.x <= box1.max.x
+        && box1.min.y <= box2.max.y && box2.min.y <= box1.max.y
+        && box1.min.z <= box2.max.z && box2.min.z <= box1.max.z;
+}
+
+bool intersects(const AABB& box, const BoundingSphere& sphere) {
+    return distanceSquared(box, sphere.center) <= sphere.radius * sphere.radius;
+}
+
+bool contains(const AABB& box, const Point& point) {
+    return box.min.x <= point.x && point.x <= box.max.x
+        && box.min.y <= point.y && point.y <= box.max.y
+        && box.min.z <= point.z && point.z <= box.max.z;
+}
+
+float distanceSquared(const AABB& box, const Point& point) {
+    const Vector outside{std::max({box.min.x - point.x, 0.0f, point.x - box.max.x}),
+                         std::max({box.min.y - point.y, 0.0f, point.y - box.max.y}),
+                         std::max({box.min.z - point.z, 0.0f, point.z - box.max.z})};
+
+    return dot(outside, outside);
+}
\ No newline at end of file
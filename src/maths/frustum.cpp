@@ -0,0 +1,57 @@
+/******************************************************************************************************
+ * @file  frustum.cpp
+ * @brief Implementation of the view frustum
+ ******************************************************************************************************/
+
+#include "maths/frustum.hpp"
+
+#include <cmath>
+
+namespace {
+    Plane makePlane(const float* row3, const float* row, float sign) {
+        const Vector normal{row3[0] + sign * row[0], row3[1] + sign * row[1], row3[2] + sign * row[2]};
+        const float distance = row3[3] + sign * row[3];
+
+        const float norm = length(normal);
+        return Plane{normal / norm, distance / norm};
+    }
+}
+
+Frustum extractFrustum(const Matrix4& matrix) {
+    // A point is inside when -w <= x, y, z <= w in clip space, each row of the matrix giving one coordinate
+    const float* x = matrix.values[0];
+    const float* y = matrix.values[1];
+    const float* z = matrix.values[2];
+    const float* w = matrix.values[3];
+
+    return Frustum{{
+        makePlane(w, x, 1.0f),
+        makePlane(w, x, -1.0f),
+        makePlane(w, y, 1.0f),
+        makePlane(w, y, -1.0f),
+        makePlane(w, z, 1.0f),
+        makePlane(w, z, -1.0f)
+    }};
+}
+
+bool intersects(const Frustum& frustum, const BoundingSphere& sphere) {
+    for(const Plane& plane: frustum.planes) {
+        if(dot(plane.normal, sphere.center) + plane.distance < -sphere.radius) { return false; }
+    }
+
+    return true;
+}
+
+bool intersects(const Frustum& frustum, const AABB& box) {
+    const Point center = box.center();
+    const Vector extent = box.extent();
+
+    for(const Plane& plane: frustum.planes) {
+        const float radius = std::abs(plane.normal.x) * extent.x + std::abs(plane.normal.y) * extent.y
+                           + std::abs(plane.normal.z) * extent.z;
+
+        if(dot(plane.normal, center) + plane.distance < -radius) { return false; }
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+/******************************************************************************************************
+ * @file  ray.cpp
+ * @brief Implementation of the ray
+ ******************************************************************************************************/
+
+#include "maths/ray.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "maths/vec4.hpp"
+
+Ray screenRay(const Matrix4& viewProjection, float x, float y) {
+    return unprojectRay(inverse(viewProjection), x, y);
+}
+
+Ray unprojectRay(const Matrix4& inverseViewProjection, float x, float y) {
+    const vec4 nearPoint = inverseViewProjection * vec4{x, y, -1.0f, 1.0f};
+    const vec4 farPoint = inverseViewProjection * vec4{x, y, 1.0f, 1.0f};
+
+    const Point origin{nearPoint.x / nearPoint.w, nearPoint.y / nearPoint.w, nearPoint.z / nearPoint.w};
+    const Point end{farPoint.x / farPoint.w, farPoint.y / farPoint.w, farPoint.z / farPoint.w};
+
+    return Ray{origin, normalize(end - origin)};
+}
+
+float intersect(const Ray& ray, const Vector& inverseDirection, const AABB& box) {
+    const float tx1 = (box.min.x - ray.origin.x) * inverseDirection.x;
+    const float tx2 = (box.max.x - ray.origin.x) * inverseDirection.x;
+    const float ty1 = (box.min.y - ray.origin.y) * inverseDirection.y;
+    const float ty2 = (box.max.y - ray.origin.y) * inverseDirection.y;
+    const float tz1 = (box.min.z - ray.origin.z) * inverseDirection.z;
+    const float tz2 = (box.max.z - ray.origin.z) * inverseDirection.z;
+
+    const float tMin = std::max({std::min(tx1, tx2), std::min(ty1, ty2), std::min(tz1, tz2), 0.0f});
+    const float tMax = std::min({std::max(tx1, tx2), std::max(ty1, ty2), std::max(tz1, tz2)});
+
+    return tMin <= tMax ? tMin : std::numeric_limits<float>::infinity();
+}
+
+float intersect(const Ray& ray, const Point& vertex, const Vector& edge1, const Vector& edge2, float& u, float& v) {
+    constexpr float miss = std::numeric_limits<float>::infinity();
+
+    const Vector p = cross(ray.direction, edge2);
+    const float determinant = dot(edge1, p);
+
+    // The ray is parallel to the triangle
+    if(std::abs(determinant) < 1e-12f) { return miss; }
+
+    const float inverseDeterminant = 1.0f / determinant;
+    const Vector s = ray.origin - vertex;
+
+    u = dot(s, p) * inverseDeterminant;
+    if(u < 0.0f || u > 1.0f) { return miss; }
+
+    const Vector q = cross(s, edge1);
+    v = dot(ray.direction, q) * inverseDeterminant;
+    if(v < 0.0f || u + v > 1.0f) { return miss; }
+
+    const float distance = dot(edge2, q) * inverseDeterminant;
+    return distance >= 0.0f ? distance : miss;
+}
+
+RayPacket::RayPacket(const Ray (&rays)[size]) {
+    for(unsigned i = 0 ; i < size ; ++i) {
+        originX[i] = rays[i].origin.x;
+        originY[i] = rays[i].origin.y;
+        originZ[i] = rays[i].origin.z;
+        directionX[i] = rays[i].direction.x;
+        directionY[i] = rays[i].direction.y;
+        directionZ[i] = rays[i].direction.z;
+        inverseX[i] = 1.0f / rays[i].direction.x;
+        inverseY[i] = 1.0f / rays[i].direction.y;
+        inverseZ[i] = 1.0f / rays[i].direction.z;
+    }
+}
+
+Ray RayPacket::operator [](unsigned i) const {
+    return Ray{Point{originX[i], originY[i], originZ[i]}, Vector{directionX[i], directionY[i], directionZ[i]}};
+}
+
+int intersect(const RayPacket& rays, const AABB& box, const float* closest) {
+#ifdef __SSE2__
+    const __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min.x), _mm_load_ps(rays.originX)), _mm_load_ps(rays.inverseX));
+    const __m128 x2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max.x), _mm_load_ps(rays.originX)), _mm_load_ps(rays.inverseX));
+    const __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min.y), _mm_load_ps(rays.originY)), _mm_load_ps(rays.inverseY));
+    const __m128 y2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max.y), _mm_load_ps(rays.originY)), _mm_load_ps(rays.inverseY));
+    const __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.min.z), _mm_load_ps(rays.originZ)), _mm_load_ps(rays.inverseZ));
+    const __m128 z2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.max.z), _mm_load_ps(rays.originZ)), _mm_load_ps(rays.inverseZ));
+
+    const __m128 tMin = _mm_max_ps(_mm_max_ps(_mm_min_ps(x1, x2), _mm_min_ps(y1, y2)),
+                                   _mm_max_ps(_mm_min_ps(z1, z2), _mm_setzero_ps()));
+    const __m128 tMax = _mm_min_ps(_mm_min_ps(_mm_max_ps(x1, x2), _mm_max_ps(y1, y2)),
+                                   _mm_min_ps(_mm_max_ps(z1, z2), _mm_loadu_ps(closest)));
+
+    return _mm_movemask_ps(_mm_cmple_ps(tMin, tMax));
+#else
+    int mask = 0;
+    for(unsigned i = 0 ; i < RayPacket::size ; ++i) {
+        const Vector inverseDirection{rays.inverseX[i], rays.inverseY[i], rays.inverseZ[i]};
+        const float distance = intersect(rays[i], inverseDirection, box);
+        if(distance != std::numeric_limits<float>::infinity() && distance <= closest[i]) { mask |= 1 << i; }
+    }
+
+    return mask;
+#endif
+}
+
+int intersect(const RayPacket& rays, const Point& vertex, const Vector& edge1, const Vector& edge2,
+              const float* closest, float* distances, float* u, float* v) {
+#ifdef __SSE2__
+    const __m128 directionX = _mm_load_ps(rays.directionX);
+    const __m128 directionY = _mm_load_ps(rays.directionY);
+    const __m128 directionZ = _mm_load_ps(rays.directionZ);
+    const __m128 edge1X = _mm_set1_ps(edge1.x), edge1Y = _mm_set1_ps(edge1.y), edge1Z = _mm_set1_ps(edge1.z);
+    const __m128 edge2X = _mm_set1_ps(edge2.x), edge2Y = _mm_set1_ps(edge2.y), edge2Z = _mm_set1_ps(edge2.z);
+
+    // Same steps as the single ray test, with the rays in the lanes
+    const __m128 pX = _mm_sub_ps(_mm_mul_ps(directionY, edge2Z), _mm_mul_ps(directionZ, edge2Y));
+    const __m128 pY = _mm_sub_ps(_mm_mul_ps(directionZ, edge2X), _mm_mul_ps(directionX, edge2Z));
+    const __m128 pZ = _mm_sub_ps(_mm_mul_ps(directionX, edge2Y), _mm_mul_ps(directionY, edge2X));
+    const __m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge1X, pX), _mm_mul_ps(edge1Y, pY)), _mm_mul_ps(edge1Z, pZ));
+    const __m128 inverseDeterminant = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+
+    const __m128 sX = _mm_sub_ps(_mm_load_ps(rays.originX), _mm_set1_ps(vertex.x));
+    const __m128 sY = _mm_sub_ps(_mm_load_ps(rays.originY), _mm_set1_ps(vertex.y));
+    const __m128 sZ = _mm_sub_ps(_mm_load_ps(rays.originZ), _mm_set1_ps(vertex.z));
+    const __m128 hitU = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sX, pX), _mm_mul_ps(sY, pY)), _mm_mul_ps(sZ, pZ)),
+                                   inverseDeterminant);
+
+    const __m128 qX = _mm_sub_ps(_mm_mul_ps(sY, edge1Z), _mm_mul_ps(sZ, edge1Y));
+    const __m128 qY = _mm_sub_ps(_mm_mul_ps(sZ, edge1X), _mm_mul_ps(sX, edge1Z));
+    const __m128 qZ = _mm_sub_ps(_mm_mul_ps(sX, edge1Y), _mm_mul_ps(sY, edge1X));
+    const __m128 hitV = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, qX), _mm_mul_ps(directionY, qY)),
+                                              _mm_mul_ps(directionZ, qZ)), inverseDeterminant);
+    const __m128 distance = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(edge2X, qX), _mm_mul_ps(edge2Y, qY)),
+                                                  _mm_mul_ps(edge2Z, qZ)), inverseDeterminant);
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 absDeterminant = _mm_andnot_ps(_mm_set1_ps(-0.0f), determinant);
+    __m128 hit = _mm_cmpge_ps(absDeterminant, _mm_set1_ps(1e-12f));
+    hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(hitU, zero), _mm_cmpge_ps(hitV, zero)));
+    hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(hitU, hitV), _mm_set1_ps(1.0f)));
+    hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(distance, zero), _mm_cmplt_ps(distance, _mm_loadu_ps(closest))));
+
+    _mm_storeu_ps(distances, distance);
+    _mm_storeu_ps(u, hitU);
+    _mm_storeu_ps(v, hitV);
+
+    return _mm_movemask_ps(hit);
+#else
+    int mask = 0;
+    for(unsigned i = 0 ; i < RayPacket::size ; ++i) {
+        distances[i] = intersect(rays[i], vertex, edge1, edge2, u[i], v[i]);
+        if(distances[i] < closest[i]) { mask |= 1 << i; }
+    }
+
+    return mask;
+#endif
+}
\ No newline at end of file
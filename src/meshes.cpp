@@ -11,8 +11,11 @@
 #include "maths/functions.hpp"
 #include "maths/transformations.hpp"
 #include "maths/vec2.hpp"
+#include "Profiler.hpp"
 
 Mesh initAxis(float length) {
+    PROFILE_FUNCTION();
+
     Mesh mesh{GL_LINES};
 
     mesh.color(1.0f, 0.0f, 0.0f);
@@ -31,6 +34,8 @@ Mesh initAxis(float length) {
 }
 
 Mesh initGrid(int sizeX, int sizeZ) {
+    PROFILE_FUNCTION();
+
     Mesh mesh{GL_LINES};
 
     mesh.color(1.0f, 1.0f, 1.0f);
@@ -49,6 +54,8 @@ Mesh initGrid(int sizeX, int sizeZ) {
 }
 
 Mesh initCube() {
+    PROFILE_FUNCTION();
+
     Mesh mesh{GL_TRIANGLES};
 
     /* Vertices' index
@@ -128,6 +135,8 @@ Mesh initCube() {
 }
 
 Mesh initDisk(const unsigned div) {
+    PROFILE_FUNCTION();
+
     Mesh mesh{GL_TRIANGLES};
 
     // alpha ∈ [0 ; 2pi]
@@ -152,6 +161,8 @@ Mesh initDisk(const unsigned div) {
 }
 
 Mesh initCylinder(unsigned int div) {
+    PROFILE_FUNCTION();
+
     Mesh mesh{GL_TRIANGLES};
 
     // alpha ∈ [0 ; 2pi]
@@ -174,6 +185,8 @@ Mesh initCylinder(unsigned int div) {
 }
 
 Mesh initSphere(unsigned int divAlpha, unsigned int divBeta) {
+    PROFILE_FUNCTION();
+
     Mesh mesh{GL_TRIANGLES};
 
     // alpha ∈ [-pi/2 ; pi/2] and beta ∈ [0, 2pi]
@@ -211,6 +224,8 @@ Mesh initSphere(unsigned int divAlpha, unsigned int divBeta) {
 }
 
 Mesh initCone(unsigned int div) {
+    PROFILE_FUNCTION();
+
     Mesh mesh{GL_TRIANGLES};
 
     // alpha ∈ [0 ; 2pi]
@@ -235,6 +250,8 @@ Mesh initCone(unsigned int div) {
 }
 
 Mesh initTorus(float R, float r, unsigned int divAlpha, unsigned int divBeta) {
+    PROFILE_FUNCTION();
+
     Mesh mesh{GL_TRIANGLES};
 
     // alpha ∈ [0, 2pi] and beta ∈ [0, 2pi]
@@ -271,6 +288,8 @@ Mesh initTorus(float R, float r, unsigned int divAlpha, unsigned int divBeta) {
 }
 
 Mesh initKleinBottle(unsigned int divAlpha, unsigned int divBeta) {
+    PROFILE_FUNCTION();
+
     Mesh mesh{GL_TRIANGLES};
 
     // alpha ∈ [0 ; pi] and beta ∈ [0, 2pi]
@@ -325,6 +344,8 @@ Mesh initKleinBottle(unsigned int divAlpha, unsigned int divBeta) {
 }
 
 Mesh initTube(const Point& P0, const Point& P1, const Point& P2, const Point& P3, float radius, unsigned divCurve, unsigned divDisks) {
+    PROFILE_FUNCTION();
+
     Mesh mesh{GL_TRIANGLES};
 
     // t ∈ [0 ; 1]